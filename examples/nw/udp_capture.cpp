@@ -0,0 +1,107 @@
+#include <mart-netlib/capture.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace udp = mart::nw::ip::udp;
+using namespace std::chrono_literals;
+
+/*
+ * Records udp traffic into a capture file or replays a capture file
+ *
+ *   udp_capture record <local endpoint> <file> [seconds]
+ *   udp_capture replay <file> <destination endpoint> [--max-speed | --speed <factor>]
+ */
+
+namespace {
+
+std::vector<std::string_view> make_arglist( int argc, char** argv )
+{
+	std::vector<std::string_view> ret;
+	for( int i = 0; i < argc; ++i ) {
+		ret.emplace_back( argv[i] );
+	}
+	return ret;
+}
+
+int print_usage()
+{
+	std::cerr << "Usage:\n"
+				 "  udp_capture record <local endpoint> <file> [seconds]\n"
+				 "  udp_capture replay <file> <destination endpoint> [--max-speed | --speed <factor>]\n";
+	return EXIT_FAILURE;
+}
+
+int record( const std::vector<std::string_view>& args )
+{
+	if( args.size() < 4 ) { return print_usage(); }
+
+	const auto local_ep = udp::try_parse_v4_endpoint( args[2] );
+	if( !local_ep ) { return print_usage(); }
+	const auto duration = args.size() > 4 ? std::chrono::seconds( std::stoi( std::string( args[4] ) ) ) : 10s;
+
+	udp::Socket sock;
+	sock.bind( *local_ep );
+	sock.set_rx_timeout( 100ms );
+	if( !sock.try_set_rx_timestamping( true ) ) { std::cout << "Kernel timestamps not available\n"; }
+
+	udp::CaptureWriter writer( args[3] );
+
+	std::cout << "Recording on " << local_ep->toStringEx() << " to " << args[3] << " for " << duration.count()
+			  << "s" << std::endl;
+
+	const auto end = std::chrono::steady_clock::now() + duration;
+	while( std::chrono::steady_clock::now() < end && !writer.is_full() ) {
+		writer.capture( sock );
+	}
+
+	std::cout << "Recorded " << writer.size() << " datagrams (" << writer.bytes_used() << " bytes)" << std::endl;
+	return EXIT_SUCCESS;
+}
+
+int replay( const std::vector<std::string_view>& args )
+{
+	if( args.size() < 4 ) { return print_usage(); }
+
+	const auto destination = udp::try_parse_v4_endpoint( args[3] );
+	if( !destination ) { return print_usage(); }
+
+	udp::ReplayConfig config{};
+	if( args.size() > 4 && args[4] == "--max-speed" ) {
+		config.timing = udp::ReplayTiming::max_speed;
+	} else if( args.size() > 5 && args[4] == "--speed" ) {
+		config.speed = std::stod( std::string( args[5] ) );
+	}
+
+	const udp::CaptureReader capture( args[2] );
+	udp::Socket              sock;
+
+	std::cout << "Replaying " << capture.size() << " datagrams to " << destination->toStringEx() << std::endl;
+	const auto stats = udp::replay( capture, sock, *destination, config );
+
+	std::cout << "Sent " << stats.sent << " datagrams (" << stats.failed << " failed) in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>( stats.duration ).count() << "ms" << std::endl;
+	return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	const auto args = make_arglist( argc, argv );
+	if( args.size() < 2 ) { return print_usage(); }
+
+	try {
+		if( args[1] == "record" ) { return record( args ); }
+		if( args[1] == "replay" ) { return replay( args ); }
+	} catch( const std::exception& e ) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return print_usage();
+}
@@ -0,0 +1,147 @@
+#ifndef IM_STR_ARENA_HPP
+#define IM_STR_ARENA_HPP
+
+#include "im_str.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace mba {
+
+/**
+ * @brief Creates many strings in a few big buffers (chunks)
+ *
+ * All strings that are created from the same chunk share the ref count of that chunk.
+ * The chunk is freed at once, when the arena moved on to the next chunk (or was destroyed)
+ * and the last string referring to it is gone. Apart from getting a new chunk, creating a
+ * string neither allocates nor modifies a ref count (the arena reserves the ref counts for
+ * many strings at once).
+ *
+ * Memory of individual strings is only reclaimed together with the whole chunk, so the arena is meant
+ * for batches of strings with a similar lifetime (e.g. everything parsed from one message).
+ *
+ * Short strings are stored in the sso buffer and strings bigger than a quarter of the chunk size
+ * get their own buffer as usual.
+ *
+ * The arena itself must only be used by one thread at a time. The strings it creates
+ * can be used like any other im_zstr (local_im_zstr for local_im_str_arena).
+ */
+template<class RefCntPolicy>
+class basic_im_str_arena {
+	using zstr_t   = basic_im_zstr<RefCntPolicy>;
+	using Handle_t = _detail_im_str::basic_ref_cnt_buffer<RefCntPolicy>;
+
+public:
+	static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+	explicit basic_im_str_arena( std::size_t chunk_size = default_chunk_size, _detail_im_str::alloc_ptr_t alloc = nullptr )
+		: _chunk_size( chunk_size )
+		, _alloc( alloc )
+	{
+		assert( 0 < chunk_size && chunk_size <= INT_MAX );
+	}
+
+	basic_im_str_arena( const basic_im_str_arena& ) = delete;
+	basic_im_str_arena& operator=( const basic_im_str_arena& ) = delete;
+
+	~basic_im_str_arena() { _retire_chunk(); }
+
+	// Copies \p str into the arena
+	zstr_t make( std::string_view str )
+	{
+		return create( str.size(), [str]( char* data ) { std::copy_n( str.data(), str.size(), data ); } );
+	}
+
+	// Concatenates all \p args (that have to be convertible to std::string_view) into a string in the arena
+	template<class... ARGS>
+	zstr_t concat( const ARGS&... args )
+	{
+		static_assert( ( std::is_convertible_v<ARGS, std::string_view> && ... ),
+					   "concat can only be used with arguments that can be converted to std::string_view" );
+		return _concat_views( std::string_view( args )... );
+	}
+
+	/**
+	 * Creates a string with \p size chars, which are written by fill( char* data )
+	 */
+	template<class Fill>
+	zstr_t create( std::size_t size, Fill&& fill )
+	{
+		if( size == 0 ) { return zstr_t{}; }
+		if( zstr_t::_fits_sso( size ) || size > _chunk_size / 4 ) {
+			return _detail_im_str_concat::create_with<zstr_t>( size, _alloc, std::forward<Fill>( fill ) );
+		}
+
+		if( size + 1 > _chunk_size - _chunk_used ) { _new_chunk(); }
+
+		char* const data = _chunk_data + _chunk_used;
+		fill( data );
+		data[size] = '\0';
+		_chunk_used += size + 1;
+
+		if( _unused_refs == 0 ) {
+			_chunk.add_ref_cnt( ref_cnt_reserve );
+			_unused_refs = ref_cnt_reserve;
+		}
+		--_unused_refs;
+		return zstr_t( std::string_view( data, size ), _chunk, _detail_im_str::defer_ref_cnt_tag );
+	}
+
+	/**
+	 * Strings created after this call go into a new chunk. The current one gets freed as soon as
+	 * the strings that refer to it are gone
+	 */
+	void release_chunk() { _retire_chunk(); }
+
+	// Number of chunks that have been allocated so far
+	std::size_t chunk_count() const noexcept { return _chunk_cnt; }
+
+private:
+	// Number of ref counts reserved in advance (the unused ones are returned, when the chunk gets retired)
+	static constexpr int ref_cnt_reserve = 1024;
+
+	template<class... ARGS>
+	zstr_t _concat_views( const ARGS... args )
+	{
+		const std::size_t size = ( std::size_t( 0 ) + ... + args.size() );
+		return create( size, [&]( char* data ) { ( _detail_im_str_concat::addTo( data, args ), ... ); } );
+	}
+
+	void _new_chunk()
+	{
+		_retire_chunk();
+		auto buffer = Handle_t::allocate_null_terminated_char_buffer( static_cast<int>( _chunk_size ), _alloc );
+		_chunk      = std::move( buffer.handle );
+		_chunk_data = buffer.data;
+		_chunk_used = 0;
+		++_chunk_cnt;
+	}
+
+	void _retire_chunk() noexcept
+	{
+		if( _chunk == nullptr ) { return; }
+		if( _unused_refs != 0 ) { _chunk.add_ref_cnt( -_unused_refs ); }
+		_unused_refs = 0;
+		_chunk       = Handle_t{};
+		_chunk_data  = nullptr;
+		_chunk_used  = _chunk_size;
+	}
+
+	std::size_t                 _chunk_size;
+	_detail_im_str::alloc_ptr_t _alloc;
+
+	Handle_t    _chunk{};
+	char*       _chunk_data  = nullptr;
+	std::size_t _chunk_used  = _chunk_size; // no space left -> first string allocates a chunk
+	int         _unused_refs = 0;
+	std::size_t _chunk_cnt   = 0;
+};
+
+} // namespace mba
+
+#endif // IM_STR_ARENA_HPP
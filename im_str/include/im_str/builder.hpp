@@ -0,0 +1,187 @@
+#ifndef IM_STR_BUILDER_HPP
+#define IM_STR_BUILDER_HPP
+
+#include "im_str.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <climits>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace mba {
+
+/**
+ * @brief Builds a string piece by piece and turns it into an im_zstr without copying
+ *
+ * Example:
+ * im_str_builder b;
+ * b.append( "Port " ).append_number( port ).append( ':' );
+ * im_zstr msg = b.freeze();
+ *
+ * The chars are written directly into a buffer with the same layout im_zstr uses, so freeze
+ * just hands that buffer over to the returned string. The buffer grows geometrically. Any unused
+ * capacity stays allocated as long as the frozen string lives (use reserve, if the final size is known).
+ * Results that fit into the sso buffer are copied there and the builder keeps its buffer for the next string.
+ */
+template<class RefCntPolicy>
+class basic_im_str_builder {
+	using zstr_t   = basic_im_zstr<RefCntPolicy>;
+	using Handle_t = _detail_im_str::basic_ref_cnt_buffer<RefCntPolicy>;
+
+public:
+	static constexpr std::size_t min_capacity = 64;
+
+	explicit basic_im_str_builder( _detail_im_str::alloc_ptr_t alloc = nullptr ) noexcept
+		: _alloc( alloc )
+	{
+	}
+
+	basic_im_str_builder( basic_im_str_builder&& other ) noexcept
+		: _alloc( other._alloc )
+		, _buffer( std::move( other._buffer ) )
+		, _data( std::exchange( other._data, nullptr ) )
+		, _size( std::exchange( other._size, 0 ) )
+		, _capacity( std::exchange( other._capacity, 0 ) )
+	{
+	}
+
+	basic_im_str_builder& operator=( basic_im_str_builder&& other ) noexcept
+	{
+		if( this == &other ) { return *this; }
+		_alloc    = other._alloc;
+		_buffer   = std::move( other._buffer );
+		_data     = std::exchange( other._data, nullptr );
+		_size     = std::exchange( other._size, 0 );
+		_capacity = std::exchange( other._capacity, 0 );
+		return *this;
+	}
+
+	std::size_t      size() const noexcept { return _size; }
+	std::size_t      capacity() const noexcept { return _capacity; }
+	bool             empty() const noexcept { return _size == 0; }
+	std::string_view view() const noexcept { return { _data, _size }; }
+
+	// Keeps the buffer, such that it can be reused
+	void clear() noexcept { _size = 0; }
+
+	void reserve( std::size_t capacity )
+	{
+		if( capacity > _capacity ) { _reallocate( capacity ); }
+	}
+
+	basic_im_str_builder& append( std::string_view str )
+	{
+		std::copy_n( str.data(), str.size(), _grow_by( str.size() ) );
+		return *this;
+	}
+
+	basic_im_str_builder& append( char c )
+	{
+		*_grow_by( 1 ) = c;
+		return *this;
+	}
+
+	basic_im_str_builder& append( std::size_t cnt, char c )
+	{
+		std::fill_n( _grow_by( cnt ), cnt, c );
+		return *this;
+	}
+
+	/**
+	 * Appends the decimal representation of \p value (formatted with std::to_chars)
+	 */
+	template<class T>
+	basic_im_str_builder& append_number( T value )
+	{
+		static_assert( std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+					   "append_number can only be used with integral and floating point types" );
+		// worst case for all integer types and for the shortest round trip representation of double
+		constexpr std::size_t max_chars = 32;
+		if constexpr( std::is_floating_point_v<T> ) {
+#if defined( __cpp_lib_to_chars )
+			static_assert( sizeof( T ) <= sizeof( double ), "long double is not supported" );
+			_append_to_chars<max_chars>( value );
+#else
+			static_assert( !sizeof( T ), "The standard library doesn't provide std::to_chars for floating point types" );
+#endif
+		} else {
+			_append_to_chars<max_chars>( value );
+		}
+		return *this;
+	}
+
+	/**
+	 * Returns the content as an im_zstr and leaves the builder empty.
+	 * Apart from short strings, the chars are not copied. Short strings are copied into the sso buffer of the result
+	 * and the builder keeps its buffer.
+	 */
+	zstr_t freeze()
+	{
+		if( _size == 0 ) { return zstr_t{}; }
+		if( zstr_t::_fits_sso( _size ) ) {
+			auto ret = _detail_im_str_concat::create_with<zstr_t>(
+				_size, _alloc, [this]( char* data ) { std::copy_n( _data, _size, data ); } );
+			_size = 0;
+			return ret;
+		}
+
+		_data[_size] = '\0';
+		zstr_t ret( std::move( _buffer ), _data, _size );
+		_data     = nullptr;
+		_size     = 0;
+		_capacity = 0;
+		return ret;
+	}
+
+private:
+	void _ensure_space_for( std::size_t cnt )
+	{
+		if( cnt > _capacity - _size ) { _reallocate( std::max( { _size + cnt, 2 * _capacity, min_capacity } ) ); }
+	}
+
+	// Makes room for \p cnt more chars and returns a pointer to the first one
+	char* _grow_by( std::size_t cnt )
+	{
+		_ensure_space_for( cnt );
+		char* const pos = _data + _size;
+		_size += cnt;
+		return pos;
+	}
+
+	template<std::size_t MaxChars, class T>
+	void _append_to_chars( T value )
+	{
+		_ensure_space_for( MaxChars );
+		const auto [end, ec] = std::to_chars( _data + _size, _data + _capacity, value );
+		assert( ec == std::errc{} );
+		(void)ec;
+		_size = static_cast<std::size_t>( end - _data );
+	}
+
+	void _reallocate( std::size_t capacity )
+	{
+		assert( capacity <= INT_MAX );
+		// the header records the full capacity, so the buffer is deallocated with the size it was allocated with
+		auto buffer = Handle_t::allocate_null_terminated_char_buffer( static_cast<int>( capacity ), _alloc );
+		if( _size != 0 ) { std::copy_n( _data, _size, buffer.data ); }
+		_buffer   = std::move( buffer.handle );
+		_data     = buffer.data;
+		_capacity = capacity;
+	}
+
+	_detail_im_str::alloc_ptr_t _alloc;
+
+	Handle_t    _buffer{};
+	char*       _data     = nullptr;
+	std::size_t _size     = 0;
+	std::size_t _capacity = 0;
+};
+
+} // namespace mba
+
+#endif // IM_STR_BUILDER_HPP
@@ -36,6 +36,34 @@
 #endif
 
 
+// Store short strings inside the im_str object itself instead of allocating a ref counted buffer.
+// Changes the layout of im_str, so this has to be the same in all translation units
+#ifndef IM_STR_USE_SSO
+	#define IM_STR_USE_SSO 1
+#endif
+
+
+// Use SSE2/AVX2 (if the target supports them) when searching for delimiters
+#ifndef IM_STR_USE_SIMD
+	#define IM_STR_USE_SIMD 1
+#endif
+
+
+// Store the hash of a string in the header of its buffer, once it has been computed (see im_str::hash).
+// Changes the buffer layout, so this has to be the same in all translation units
+#ifndef IM_STR_CACHE_HASH
+	#define IM_STR_CACHE_HASH 0
+#endif
+
+
+// Per thread counters for ref count updates and allocations that can be switched on at runtime
+// (see enable_ref_cnt_stats). When switched off, each update only costs an additional relaxed load.
+// Has to be the same in all translation units
+#ifndef IM_STR_USE_REF_CNT_STATS
+	#define IM_STR_USE_REF_CNT_STATS 1
+#endif
+
+
 #ifndef IM_STR_USE_CUSTOM_DYN_ARRAY
 	#define IM_STR_USE_CUSTOM_DYN_ARRAY	1
 #else
@@ -0,0 +1,120 @@
+#ifndef IM_STR_DETAIL_HASH_HPP
+#define IM_STR_DETAIL_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace mba::_detail_im_str {
+
+namespace _hash {
+
+constexpr std::uint64_t secret[4]
+	= { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+// 64x64->128 bit multiplication. Returns the low half in a and the high half in b
+constexpr void mum( std::uint64_t& a, std::uint64_t& b ) noexcept
+{
+#if defined( __SIZEOF_INT128__ )
+	const unsigned __int128 r = static_cast<unsigned __int128>( a ) * b;
+	a                         = static_cast<std::uint64_t>( r );
+	b                         = static_cast<std::uint64_t>( r >> 64 );
+#else
+	const std::uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<std::uint32_t>( a ),
+						lb = static_cast<std::uint32_t>( b );
+	const std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	const std::uint64_t t  = rl + ( rm0 << 32 );
+	std::uint64_t       hi = rh + ( rm0 >> 32 ) + ( rm1 >> 32 ) + ( t < rl );
+	const std::uint64_t lo = t + ( rm1 << 32 );
+	hi += ( lo < t );
+	a = lo;
+	b = hi;
+#endif
+}
+
+constexpr std::uint64_t mix( std::uint64_t a, std::uint64_t b ) noexcept
+{
+	mum( a, b );
+	return a ^ b;
+}
+
+// Little endian loads, written such that the compiler turns them into single loads
+constexpr std::uint64_t read4( const char* p ) noexcept
+{
+	return static_cast<std::uint64_t>( static_cast<unsigned char>( p[0] ) )
+		   | static_cast<std::uint64_t>( static_cast<unsigned char>( p[1] ) ) << 8
+		   | static_cast<std::uint64_t>( static_cast<unsigned char>( p[2] ) ) << 16
+		   | static_cast<std::uint64_t>( static_cast<unsigned char>( p[3] ) ) << 24;
+}
+
+constexpr std::uint64_t read8( const char* p ) noexcept
+{
+	return read4( p ) | read4( p + 4 ) << 32;
+}
+
+// 1 to 3 bytes
+constexpr std::uint64_t read3( const char* p, std::size_t k ) noexcept
+{
+	return static_cast<std::uint64_t>( static_cast<unsigned char>( p[0] ) ) << 16
+		   | static_cast<std::uint64_t>( static_cast<unsigned char>( p[k >> 1] ) ) << 8
+		   | static_cast<std::uint64_t>( static_cast<unsigned char>( p[k - 1] ) );
+}
+
+} // namespace _hash
+
+/**
+ * 64 bit hash of the string content (wyhash, final version 4).
+ *
+ * Processes 8 to 48 bytes per step instead of a single one, so it is much faster
+ * than byte wise hashes like FNV-1a for anything but very short strings.
+ *
+ * Unlike std::hash<std::string_view> the result is the same on all platforms and
+ * in all processes, so it can be stored alongside the string.
+ */
+constexpr std::uint64_t hash_bytes( std::string_view str ) noexcept
+{
+	using namespace _hash;
+
+	const char*       p    = str.data();
+	const std::size_t len  = str.size();
+	std::uint64_t     seed = mix( secret[0], secret[1] );
+	std::uint64_t     a    = 0;
+	std::uint64_t     b    = 0;
+	if( len <= 16 ) {
+		if( len >= 4 ) {
+			a = ( read4( p ) << 32 ) | read4( p + ( ( len >> 3 ) << 2 ) );
+			b = ( read4( p + len - 4 ) << 32 ) | read4( p + len - 4 - ( ( len >> 3 ) << 2 ) );
+		} else if( len > 0 ) {
+			a = read3( p, len );
+		}
+	} else {
+		std::size_t i = len;
+		if( i > 48 ) {
+			std::uint64_t see1 = seed;
+			std::uint64_t see2 = seed;
+			do {
+				seed = mix( read8( p ) ^ secret[1], read8( p + 8 ) ^ seed );
+				see1 = mix( read8( p + 16 ) ^ secret[2], read8( p + 24 ) ^ see1 );
+				see2 = mix( read8( p + 32 ) ^ secret[3], read8( p + 40 ) ^ see2 );
+				p += 48;
+				i -= 48;
+			} while( i > 48 );
+			seed ^= see1 ^ see2;
+		}
+		while( i > 16 ) {
+			seed = mix( read8( p ) ^ secret[1], read8( p + 8 ) ^ seed );
+			i -= 16;
+			p += 16;
+		}
+		a = read8( p + i - 16 );
+		b = read8( p + i - 8 );
+	}
+	a ^= secret[1];
+	b ^= seed;
+	mum( a, b );
+	return mix( a ^ secret[0] ^ len, b ^ secret[1] );
+}
+
+} // namespace mba::_detail_im_str
+
+#endif // IM_STR_DETAIL_HASH_HPP
@@ -6,12 +6,52 @@
 #include <cstdint>
 #include <cstdlib>
 #include <new>     // placement new
+#include <string_view>
 #include <utility> // std::move
 
 #include "./config.hpp"
+#include "./hash.hpp"
+#include "./ref_cnt_stats.hpp"
 
 namespace mba::_detail_im_str {
 
+/*
+ * Ref count policies: Determine how the ref count in the header of a buffer gets modified.
+ * Both return the new value of the ref count.
+ */
+
+// Default: The buffer can be shared between threads
+struct atomic_ref_cnt_policy {
+	static int add( std::atomic_int& cnt, int n ) noexcept { return cnt.fetch_add( n, std::memory_order_relaxed ) + n; }
+	static int dec( std::atomic_int& cnt ) noexcept { return cnt.fetch_sub( 1 ) - 1; }
+};
+
+/*
+ * For buffers that are only ever accessed from a single thread: Uses plain loads and stores instead of
+ * atomic read-modify-write operations. The counter itself is still a std::atomic_int, such that
+ * a buffer can be handed over to the atomic flavor.
+ */
+struct local_ref_cnt_policy {
+	static int add( std::atomic_int& cnt, int n ) noexcept
+	{
+		const int new_cnt = cnt.load( std::memory_order_relaxed ) + n;
+		cnt.store( new_cnt, std::memory_order_relaxed );
+		return new_cnt;
+	}
+	static int dec( std::atomic_int& cnt ) noexcept { return add( cnt, -1 ); }
+};
+
+/*
+ * Use different types	to somewhat mitigate the ODR viaolation problem:
+ * Function versions that have been compiled with support for  std::pmr::memory_resource will
+ * get a different mangled name than functions without
+ */
+#if IM_STR_USE_ALLOC
+using alloc_ptr_t = std::pmr::memory_resource*;
+#else
+using alloc_ptr_t = std::nullptr_t;
+#endif
+
 #ifdef IM_STR_DEBUG_HOOKS
 inline namespace debug_version {
 struct Stats {
@@ -106,48 +146,94 @@ constexpr T c_expr_exchange( T& obj, U&& new_value ) noexcept
 	return old_value;
 }
 
-struct AllocResult;
+// Header in front of the string data of each buffer (the same for all ref count policies)
+struct buffer_header {
+	std::atomic_int ref_cnt;
+	int             size;
+	alloc_ptr_t     alloc;
+#if IM_STR_CACHE_HASH
+	std::atomic<std::uint64_t> hash; // 0: not computed yet
+#endif
+};
+#if IM_STR_CACHE_HASH
+// make sure we use 32bit integers and the only padding is the one in front of the hash, which has to be 8 byte aligned
+// (4 bytes on 32 bit targets)
+inline constexpr std::size_t buffer_header_hash_align = alignof( std::atomic<std::uint64_t> );
+static_assert( sizeof( buffer_header )
+			   <= ( 4 + 4 + sizeof( void* ) + buffer_header_hash_align - 1 ) / buffer_header_hash_align
+						  * buffer_header_hash_align
+					  + 8 );
+#else
+// make sure there is no padding and we use 32bit integers
+static_assert( sizeof( buffer_header ) <= 4 + 4 + sizeof( void* ) );
+#endif
+
+template<class RefCntPolicy>
+struct basic_alloc_result;
+
 /**
  * Note: Almost all of the member functions are labled constexpr.
  * However, they can only be used in a constexpr context if the
  * handle is default constructed (i.e. _cnt == nullptr)
  */
-class atomic_ref_cnt_buffer {
+template<class RefCntPolicy>
+class basic_ref_cnt_buffer {
 	using Cnt_t     = std::atomic_int;
 	using size_type = int;
 
 public:
-/*
- * Use different types	to somewhat mitigate the ODR viaolation problem:
- * Function versions that have been compiled with support for  std::pmr::memory_resource will
- * get a different mangled name than functions without
- */
 #if IM_STR_USE_ALLOC
-	using alloc_t     = std::pmr::memory_resource;
-	using alloc_ptr_t = alloc_t*;
-#else
-	using alloc_ptr_t = std::nullptr_t;
+	using alloc_t = std::pmr::memory_resource;
 #endif
+	using alloc_ptr_t = _detail_im_str::alloc_ptr_t;
+
 	/*vvvv Constructors and special member functions vvvvv*/
-	static AllocResult allocate_null_terminated_char_buffer( int size, alloc_ptr_t = nullptr );
+	static basic_alloc_result<RefCntPolicy> allocate_null_terminated_char_buffer( int size, alloc_ptr_t = nullptr );
+
+#if IM_STR_USE_ALLOC
+	/**
+	 * Takes ownership of a buffer that has not been created by allocate_null_terminated_char_buffer
+	 * (e.g. a memory mapped file): \p header has to be followed by header.size chars and a zero,
+	 * header.ref_cnt has to be 1 and header.alloc->deallocate( &header, sizeof( header ) + header.size + 1, ... )
+	 * gets called, when the last handle is gone.
+	 */
+	static basic_ref_cnt_buffer adopt_buffer( buffer_header& header ) noexcept
+	{
+		assert( header.alloc != nullptr && header.ref_cnt.load( std::memory_order_relaxed ) == 1 );
+		stats().alloc();
+		count_ref_cnt_event<&thread_ref_cnt_stats::allocs>();
+		return basic_ref_cnt_buffer{ header };
+	}
+#endif
 
-	constexpr atomic_ref_cnt_buffer() noexcept = default;
-	constexpr atomic_ref_cnt_buffer( const atomic_ref_cnt_buffer& other, defer_ref_cnt_tag_t ) noexcept
+	constexpr basic_ref_cnt_buffer() noexcept = default;
+	constexpr basic_ref_cnt_buffer( const basic_ref_cnt_buffer& other, defer_ref_cnt_tag_t ) noexcept
 		: _cnt{ other._cnt }
 	{
 	}
 
-	constexpr atomic_ref_cnt_buffer( const atomic_ref_cnt_buffer& other ) noexcept
+	/**
+	 * Takes over the buffer from a handle with a different ref count policy.
+	 * \p other has to be the only handle that refers to the buffer (see is_unique)
+	 */
+	template<class OtherPolicy>
+	explicit basic_ref_cnt_buffer( basic_ref_cnt_buffer<OtherPolicy>&& other ) noexcept
+		: _cnt{ c_expr_exchange( other._cnt, nullptr ) }
+	{
+		assert( _cnt == nullptr || _cnt->load( std::memory_order_relaxed ) == 1 );
+	}
+
+	constexpr basic_ref_cnt_buffer( const basic_ref_cnt_buffer& other ) noexcept
 		: _cnt{ other._cnt }
 	{
 		_incref();
 	}
-	constexpr atomic_ref_cnt_buffer( atomic_ref_cnt_buffer&& other ) noexcept
+	constexpr basic_ref_cnt_buffer( basic_ref_cnt_buffer&& other ) noexcept
 		: _cnt{ c_expr_exchange( other._cnt, nullptr ) }
 	{
 	}
 
-	constexpr atomic_ref_cnt_buffer& operator=( const atomic_ref_cnt_buffer& other ) noexcept
+	constexpr basic_ref_cnt_buffer& operator=( const basic_ref_cnt_buffer& other ) noexcept
 	{
 		// inc before dec to protect against dropping in self assignment
 		other._incref();
@@ -155,7 +241,7 @@ public:
 		_cnt = other._cnt;
 		return *this;
 	}
-	constexpr atomic_ref_cnt_buffer& operator=( atomic_ref_cnt_buffer&& other ) noexcept
+	constexpr basic_ref_cnt_buffer& operator=( basic_ref_cnt_buffer&& other ) noexcept
 	{
 		assert( ( ( _cnt == nullptr ) || ( this != &other ) ) && "Move assignment to self is not allowed, if cnt!=0" );
 		_decref();
@@ -163,9 +249,9 @@ public:
 		return *this;
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 ~atomic_ref_cnt_buffer() { _decref(); }
+	IM_STR_CONSTEXPR_IN_CPP_20 ~basic_ref_cnt_buffer() { _decref(); }
 
-	friend constexpr void swap( atomic_ref_cnt_buffer& l, atomic_ref_cnt_buffer& r ) noexcept
+	friend constexpr void swap( basic_ref_cnt_buffer& l, basic_ref_cnt_buffer& r ) noexcept
 	{
 		// TODO: C++20 		std::swap( l._cnt, r._cnt );  (not yet constexpr)
 		auto tmp = l._cnt;
@@ -180,7 +266,7 @@ public:
 	/**
 	 * @brief Bump the ref count by \p cnt
 	 *
-	 * Intended to be used with the atomic_ref_cnt_buffer( const atomic_ref_cnt_buffer& other, defer_ref_cnt_tag_t )
+	 * Intended to be used with the basic_ref_cnt_buffer( const basic_ref_cnt_buffer& other, defer_ref_cnt_tag_t )
 	 * constructor
 	 *
 	 * @param cnt
@@ -192,43 +278,76 @@ public:
 			return 0;
 		} else {
 			stats().inc_ref();
-			return _cnt->fetch_add( cnt, std::memory_order_relaxed ) + cnt;
+			if( cnt >= 0 ) {
+				count_ref_cnt_event<&thread_ref_cnt_stats::incs>();
+			} else {
+				count_ref_cnt_event<&thread_ref_cnt_stats::decs>();
+			}
+			return RefCntPolicy::add( *_cnt, cnt );
 		}
 	}
 
 	constexpr void release() { _cnt = nullptr; }
 
+	// true, if this is the only handle that refers to its buffer
+	bool is_unique() const noexcept { return _cnt != nullptr && _cnt->load( std::memory_order_acquire ) == 1; }
+
+	/**
+	 * @brief Returns hash_bytes( str ) for a string that refers to this buffer
+	 *
+	 * With IM_STR_CACHE_HASH, the hash of a string that spans the whole buffer is stored in the
+	 * header the first time it gets computed (substrings are always hashed from scratch).
+	 */
+	std::uint64_t hash_of( std::string_view str ) const noexcept
+	{
+#if IM_STR_CACHE_HASH
+		if( _cnt != nullptr ) {
+			Header& header = _header();
+			if( str.data() == reinterpret_cast<const char*>( &header ) + sizeof( Header )
+				&& str.size() == static_cast<std::size_t>( header.size ) ) {
+				std::uint64_t hash = header.hash.load( std::memory_order_relaxed );
+				if( hash == 0 ) {
+					hash = hash_bytes( str );
+					header.hash.store( hash, std::memory_order_relaxed );
+				}
+				return hash;
+			}
+		}
+#endif
+		return hash_bytes( str );
+	}
+
 	/*^^^^ API ^^^^*/
 
 	// clang-format off
-	friend constexpr bool operator==( const atomic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt == nullptr; }
-	friend constexpr bool operator==( std::nullptr_t, const atomic_ref_cnt_buffer& r ) noexcept { return r._cnt == nullptr; }
-	friend constexpr bool operator!=( const atomic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt != nullptr; }
-	friend constexpr bool operator!=( std::nullptr_t, const atomic_ref_cnt_buffer& r ) noexcept { return r._cnt != nullptr; }
+	friend constexpr bool operator==( const basic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt == nullptr; }
+	friend constexpr bool operator==( std::nullptr_t, const basic_ref_cnt_buffer& r ) noexcept { return r._cnt == nullptr; }
+	friend constexpr bool operator!=( const basic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt != nullptr; }
+	friend constexpr bool operator!=( std::nullptr_t, const basic_ref_cnt_buffer& r ) noexcept { return r._cnt != nullptr; }
 	// clang-format on
 
 private:
-	struct Header {
-		Cnt_t       ref_cnt;
-		size_type   size;
-		alloc_ptr_t alloc;
-	};
-	static_assert( sizeof( Header )
-				   <= 4 + 4 + sizeof( void* ) ); // make sure there is no padding and we use 32bit integers
+	template<class>
+	friend class basic_ref_cnt_buffer;
 
-	// This is used in allocate_null_terminated_char_buffer
-	constexpr explicit atomic_ref_cnt_buffer( Header& buffer ) noexcept
+	using Header = buffer_header;
+
+	// This is used in allocate_null_terminated_char_buffer and adopt_buffer
+	constexpr explicit basic_ref_cnt_buffer( Header& buffer ) noexcept
 		: _cnt( &( buffer.ref_cnt ) )
 	{
 	}
 
 	static void dealloc_buffer( Header* ptr );
 
+	Header& _header() const noexcept { return *static_cast<Header*>( static_cast<void*>( _cnt ) ); }
+
 	constexpr void _decref() const noexcept
 	{
 		if( _cnt ) {
 			stats().dec_ref();
-			if( _cnt->fetch_sub( 1 ) == 1 ) {
+			count_ref_cnt_event<&thread_ref_cnt_stats::decs>();
+			if( RefCntPolicy::dec( *_cnt ) == 0 ) {
 				Header* header = static_cast<Header*>( static_cast<void*>( _cnt ) );
 				dealloc_buffer( header );
 			}
@@ -239,7 +358,8 @@ private:
 	{
 		if( _cnt ) {
 			stats().inc_ref();
-			_cnt->fetch_add( 1, std::memory_order_relaxed );
+			count_ref_cnt_event<&thread_ref_cnt_stats::incs>();
+			RefCntPolicy::add( *_cnt, 1 );
 		}
 	}
 
@@ -248,15 +368,23 @@ private:
 	static constexpr auto alignment = alignof( Header );
 };
 
-struct AllocResult {
-	char*                 data;
-	atomic_ref_cnt_buffer handle;
+template<class RefCntPolicy>
+struct basic_alloc_result {
+	char*                              data;
+	basic_ref_cnt_buffer<RefCntPolicy> handle;
 };
 
-inline AllocResult atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer( size_type size, alloc_ptr_t resource )
+using atomic_ref_cnt_buffer = basic_ref_cnt_buffer<atomic_ref_cnt_policy>;
+using local_ref_cnt_buffer  = basic_ref_cnt_buffer<local_ref_cnt_policy>;
+using AllocResult           = basic_alloc_result<atomic_ref_cnt_policy>;
+
+template<class RefCntPolicy>
+inline basic_alloc_result<RefCntPolicy>
+basic_ref_cnt_buffer<RefCntPolicy>::allocate_null_terminated_char_buffer( size_type size, alloc_ptr_t resource )
 {
 	assert( size >= 0 );
 	stats().alloc();
+	count_ref_cnt_event<&thread_ref_cnt_stats::allocs>();
 
 	const auto total_size = sizeof( Header ) + size + 1;
 
@@ -269,17 +397,23 @@ inline AllocResult atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
 	char* const start = (char*)std::malloc( total_size );
 #endif
 
+#if IM_STR_CACHE_HASH
+	auto* const header_ptr = new( start ) Header{ Cnt_t{ 1 }, size_type{ size }, resource, { 0 } };
+#else
 	auto* const header_ptr = new( start ) Header{ Cnt_t{ 1 }, size_type{ size }, resource };
+#endif
 
 	auto* const data_ptr = start + sizeof( Header ); // Start of string
 	data_ptr[size]       = '\0';                     // zero terminate
 
-	return { data_ptr, atomic_ref_cnt_buffer{ *header_ptr } };
+	return { data_ptr, basic_ref_cnt_buffer{ *header_ptr } };
 }
 
-inline void atomic_ref_cnt_buffer::dealloc_buffer( Header* header )
+template<class RefCntPolicy>
+inline void basic_ref_cnt_buffer<RefCntPolicy>::dealloc_buffer( Header* header )
 {
 	stats().dealloc();
+	count_ref_cnt_event<&thread_ref_cnt_stats::deallocs>();
 
 #if IM_STR_USE_ALLOC
 	alloc_ptr_t alloc = header->alloc;
@@ -0,0 +1,177 @@
+#ifndef IM_STR_DETAIL_REF_CNT_STATS_HPP
+#define IM_STR_DETAIL_REF_CNT_STATS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "./config.hpp"
+
+namespace mba {
+
+/**
+ * Number of ref count updates and buffer (de)allocations of im_str and friends
+ * (see collect_ref_cnt_stats)
+ */
+struct ref_cnt_stats {
+	std::uint64_t incs     = 0;
+	std::uint64_t decs     = 0;
+	std::uint64_t allocs   = 0;
+	std::uint64_t deallocs = 0;
+
+	ref_cnt_stats& operator+=( const ref_cnt_stats& other ) noexcept
+	{
+		incs += other.incs;
+		decs += other.decs;
+		allocs += other.allocs;
+		deallocs += other.deallocs;
+		return *this;
+	}
+
+	// Difference between two snapshots
+	friend ref_cnt_stats operator-( ref_cnt_stats l, const ref_cnt_stats& r ) noexcept
+	{
+		l.incs -= r.incs;
+		l.decs -= r.decs;
+		l.allocs -= r.allocs;
+		l.deallocs -= r.deallocs;
+		return l;
+	}
+};
+
+namespace _detail_im_str {
+
+// Counters of a single thread. They are only written by that thread, but may be read by any
+struct thread_ref_cnt_stats {
+	std::atomic_uint64_t incs{ 0 };
+	std::atomic_uint64_t decs{ 0 };
+	std::atomic_uint64_t allocs{ 0 };
+	std::atomic_uint64_t deallocs{ 0 };
+
+	ref_cnt_stats load() const noexcept
+	{
+		return { incs.load( std::memory_order_relaxed ),
+				 decs.load( std::memory_order_relaxed ),
+				 allocs.load( std::memory_order_relaxed ),
+				 deallocs.load( std::memory_order_relaxed ) };
+	}
+};
+
+struct ref_cnt_stats_registry {
+	std::mutex                               mutex;
+	std::vector<const thread_ref_cnt_stats*> threads;
+	ref_cnt_stats                            exited_threads; // sum of the counters of all threads that have exited
+
+	static ref_cnt_stats_registry& instance()
+	{
+		// never destroyed, as threads might still exit after static destruction has begun
+		static ref_cnt_stats_registry* const registry = new ref_cnt_stats_registry{};
+		return *registry;
+	}
+};
+
+// Target of the events of threads that aren't counted: Either the registration failed or the thread is exiting and
+// its counters have already been destroyed (e.g. for strings with thread or static storage duration that are destroyed
+// later on). Never reported
+inline thread_ref_cnt_stats uncounted_thread_ref_cnt_stats;
+
+// Plain pointer, such that the fast path doesn't have to check, whether a thread_local object has been constructed
+inline thread_local thread_ref_cnt_stats* this_thread_ref_cnt_stats_ptr = nullptr;
+
+// Registers the counters of a thread for as long as it lives
+struct thread_ref_cnt_stats_owner {
+	thread_ref_cnt_stats stats;
+
+	thread_ref_cnt_stats_owner()
+	{
+		auto&                       registry = ref_cnt_stats_registry::instance();
+		std::lock_guard<std::mutex> lock( registry.mutex );
+		registry.threads.push_back( &stats );
+	}
+
+	~thread_ref_cnt_stats_owner()
+	{
+		auto&                       registry = ref_cnt_stats_registry::instance();
+		std::lock_guard<std::mutex> lock( registry.mutex );
+		registry.exited_threads += stats.load();
+		registry.threads.erase( std::find( registry.threads.begin(), registry.threads.end(), &stats ) );
+		this_thread_ref_cnt_stats_ptr = &uncounted_thread_ref_cnt_stats;
+	}
+};
+
+inline std::atomic_bool ref_cnt_stats_enabled_flag{ false };
+
+inline thread_ref_cnt_stats& this_thread_ref_cnt_stats_slow() noexcept
+{
+	try {
+		static thread_local thread_ref_cnt_stats_owner owner;
+		this_thread_ref_cnt_stats_ptr = &owner.stats;
+	} catch( ... ) {
+		// couldn't register the thread (mutex or allocation failure): leave it uncounted instead of retrying every time
+		this_thread_ref_cnt_stats_ptr = &uncounted_thread_ref_cnt_stats;
+	}
+	return *this_thread_ref_cnt_stats_ptr;
+}
+
+inline thread_ref_cnt_stats& this_thread_ref_cnt_stats() noexcept
+{
+	thread_ref_cnt_stats* const stats = this_thread_ref_cnt_stats_ptr;
+	return stats ? *stats : this_thread_ref_cnt_stats_slow();
+}
+
+/**
+ * Called for each ref count update / allocation. Costs a single relaxed load of a global
+ * flag, unless counting has been enabled with enable_ref_cnt_stats
+ */
+template<std::atomic_uint64_t thread_ref_cnt_stats::*Counter>
+inline void count_ref_cnt_event() noexcept
+{
+#if IM_STR_USE_REF_CNT_STATS
+	if( ref_cnt_stats_enabled_flag.load( std::memory_order_relaxed ) ) {
+		// only this thread writes to the counter, so there is no need for an atomic increment
+		std::atomic_uint64_t& cnt = this_thread_ref_cnt_stats().*Counter;
+		cnt.store( cnt.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	}
+#endif
+}
+
+} // namespace _detail_im_str
+
+/**
+ * Starts (or stops) counting ref count updates and allocations on all threads.
+ * Does nothing if the library has been compiled with IM_STR_USE_REF_CNT_STATS=0
+ */
+inline void enable_ref_cnt_stats( bool enable = true ) noexcept
+{
+	_detail_im_str::ref_cnt_stats_enabled_flag.store( IM_STR_USE_REF_CNT_STATS && enable, std::memory_order_relaxed );
+}
+
+inline bool ref_cnt_stats_enabled() noexcept
+{
+	return _detail_im_str::ref_cnt_stats_enabled_flag.load( std::memory_order_relaxed );
+}
+
+// Counters of the calling thread (take the difference of two snapshots to measure a piece of code)
+inline ref_cnt_stats this_thread_ref_cnt_stats()
+{
+	return _detail_im_str::this_thread_ref_cnt_stats().load();
+}
+
+// Sum of the counters of all threads, including those that have already exited
+inline ref_cnt_stats collect_ref_cnt_stats()
+{
+	auto&                       registry = _detail_im_str::ref_cnt_stats_registry::instance();
+	std::lock_guard<std::mutex> lock( registry.mutex );
+
+	ref_cnt_stats total = registry.exited_threads;
+	for( const auto* stats : registry.threads ) {
+		total += stats->load();
+	}
+	return total;
+}
+
+} // namespace mba
+
+#endif // IM_STR_DETAIL_REF_CNT_STATS_HPP
@@ -0,0 +1,241 @@
+#ifndef IM_STR_DETAIL_SCAN_HPP
+#define IM_STR_DETAIL_SCAN_HPP
+
+#include "./config.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits> // std::is_constant_evaluated
+#include <vector>
+
+// clang-format off
+#if IM_STR_USE_SIMD && defined( __AVX2__ )
+	#include <immintrin.h>
+	#define IM_STR_DETAIL_SIMD_WIDTH 32
+#elif IM_STR_USE_SIMD && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+	#include <emmintrin.h>
+	#define IM_STR_DETAIL_SIMD_WIDTH 16
+#else
+	#define IM_STR_DETAIL_SIMD_WIDTH 0
+#endif
+
+#if IM_STR_DETAIL_SIMD_WIDTH && defined( _MSC_VER )
+	#include <intrin.h> // _BitScanForward / _BitScanReverse
+#endif
+
+#if defined( __cpp_lib_is_constant_evaluated ) && IM_STR_USE_CONSTEXPR_DESTRUCTOR
+	#define IM_STR_DETAIL_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+	#define IM_STR_DETAIL_IS_CONSTANT_EVALUATED() false
+#endif
+// clang-format on
+
+namespace mba::_detail_im_str {
+
+/*
+ * Functions that search a string for a single char. They compare a whole block of chars
+ * (16 with SSE2, 32 with AVX2) at once and use a scalar loop for the remaining ones
+ */
+
+#if IM_STR_DETAIL_SIMD_WIDTH
+namespace simd {
+
+constexpr std::size_t width = IM_STR_DETAIL_SIMD_WIDTH;
+
+// Bit i is set, iff data[i] == c
+inline std::uint32_t match_mask( const char* data, char c ) noexcept
+{
+#if IM_STR_DETAIL_SIMD_WIDTH == 32
+	const __m256i block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data ) );
+	return static_cast<std::uint32_t>( _mm256_movemask_epi8( _mm256_cmpeq_epi8( block, _mm256_set1_epi8( c ) ) ) );
+#else
+	const __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data ) );
+	return static_cast<std::uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( block, _mm_set1_epi8( c ) ) ) );
+#endif
+}
+
+#if IM_STR_DETAIL_SIMD_WIDTH == 32
+using block_t = __m256i;
+inline block_t broadcast( char c ) noexcept { return _mm256_set1_epi8( c ); }
+#else
+using block_t = __m128i;
+inline block_t broadcast( char c ) noexcept { return _mm_set1_epi8( c ); }
+#endif
+
+// Bit i is set, iff data[i] is equal to one of the cnt chars in needles (see broadcast)
+inline std::uint32_t match_any_mask( const char* data, const block_t* needles, std::size_t cnt ) noexcept
+{
+#if IM_STR_DETAIL_SIMD_WIDTH == 32
+	const __m256i block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data ) );
+	__m256i       acc   = _mm256_cmpeq_epi8( block, needles[0] );
+	for( std::size_t k = 1; k < cnt; ++k ) {
+		acc = _mm256_or_si256( acc, _mm256_cmpeq_epi8( block, needles[k] ) );
+	}
+	return static_cast<std::uint32_t>( _mm256_movemask_epi8( acc ) );
+#else
+	const __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data ) );
+	__m128i       acc   = _mm_cmpeq_epi8( block, needles[0] );
+	for( std::size_t k = 1; k < cnt; ++k ) {
+		acc = _mm_or_si128( acc, _mm_cmpeq_epi8( block, needles[k] ) );
+	}
+	return static_cast<std::uint32_t>( _mm_movemask_epi8( acc ) );
+#endif
+}
+
+// mask must not be 0
+inline std::size_t lowest_set_bit( std::uint32_t mask ) noexcept
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward( &idx, mask );
+	return idx;
+#else
+	return static_cast<std::size_t>( __builtin_ctz( mask ) );
+#endif
+}
+
+// mask must not be 0
+inline std::size_t highest_set_bit( std::uint32_t mask ) noexcept
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanReverse( &idx, mask );
+	return idx;
+#else
+	return static_cast<std::size_t>( 31 - __builtin_clz( mask ) );
+#endif
+}
+
+} // namespace simd
+#endif // IM_STR_DETAIL_SIMD_WIDTH
+
+// Same as str.find( c )
+IM_STR_CONSTEXPR_IN_CPP_20 inline std::size_t find_char( std::string_view str, char c ) noexcept
+{
+	if( IM_STR_DETAIL_IS_CONSTANT_EVALUATED() ) { return str.find( c ); }
+
+	const char* const data = str.data();
+	const std::size_t size = str.size();
+	std::size_t       i    = 0;
+#if IM_STR_DETAIL_SIMD_WIDTH
+	for( ; i + simd::width <= size; i += simd::width ) {
+		if( const auto mask = simd::match_mask( data + i, c ) ) { return i + simd::lowest_set_bit( mask ); }
+	}
+#endif
+	for( ; i < size; ++i ) {
+		if( data[i] == c ) { return i; }
+	}
+	return std::string_view::npos;
+}
+
+// Same as str.rfind( c )
+IM_STR_CONSTEXPR_IN_CPP_20 inline std::size_t rfind_char( std::string_view str, char c ) noexcept
+{
+	if( IM_STR_DETAIL_IS_CONSTANT_EVALUATED() ) { return str.rfind( c ); }
+
+	const char* const data = str.data();
+	std::size_t       i    = str.size();
+#if IM_STR_DETAIL_SIMD_WIDTH
+	for( ; i >= simd::width; i -= simd::width ) {
+		if( const auto mask = simd::match_mask( data + i - simd::width, c ) ) {
+			return i - simd::width + simd::highest_set_bit( mask );
+		}
+	}
+#endif
+	while( i > 0 ) {
+		--i;
+		if( data[i] == c ) { return i; }
+	}
+	return std::string_view::npos;
+}
+
+// Maximal number of chars, find_first_of_chars can search for at once
+constexpr std::size_t max_find_first_of_chars = 16;
+
+/**
+ * Same as str.find_first_of( std::string_view( chars, cnt ), pos ), but
+ * requires 0 < cnt <= max_find_first_of_chars
+ */
+inline std::size_t find_first_of_chars( std::string_view str, std::size_t pos, const char* chars, std::size_t cnt ) noexcept
+{
+	assert( 0 < cnt && cnt <= max_find_first_of_chars );
+
+	const char* const data = str.data();
+	const std::size_t size = str.size();
+	std::size_t       i    = pos;
+#if IM_STR_DETAIL_SIMD_WIDTH
+	if( i + simd::width <= size ) {
+		simd::block_t needles[max_find_first_of_chars];
+		for( std::size_t k = 0; k < cnt; ++k ) {
+			needles[k] = simd::broadcast( chars[k] );
+		}
+		for( ; i + simd::width <= size; i += simd::width ) {
+			if( const auto mask = simd::match_any_mask( data + i, needles, cnt ) ) {
+				return i + simd::lowest_set_bit( mask );
+			}
+		}
+	}
+#endif
+	for( ; i < size; ++i ) {
+		for( std::size_t k = 0; k < cnt; ++k ) {
+			if( data[i] == chars[k] ) { return i; }
+		}
+	}
+	return std::string_view::npos;
+}
+
+// Calls on_match( pos ) for each occurence of c in str (in ascending order)
+template<class OnMatch>
+void for_each_char_pos( std::string_view str, char c, OnMatch&& on_match )
+{
+	const char* const data = str.data();
+	const std::size_t size = str.size();
+	std::size_t       i    = 0;
+#if IM_STR_DETAIL_SIMD_WIDTH
+	for( ; i + simd::width <= size; i += simd::width ) {
+		for( auto mask = simd::match_mask( data + i, c ); mask != 0; mask &= mask - 1 ) {
+			on_match( i + simd::lowest_set_bit( mask ) );
+		}
+	}
+#endif
+	for( ; i < size; ++i ) {
+		if( data[i] == c ) { on_match( i ); }
+	}
+}
+
+/**
+ * Collects the results of a scan. The first positions are stored inline, such that
+ * strings with only a few delimiters don't need an additional allocation
+ */
+class position_buffer {
+public:
+	void push_back( std::size_t pos )
+	{
+		if( _size < inline_capacity ) {
+			_inline[_size] = pos;
+		} else {
+			_overflow.push_back( pos );
+		}
+		++_size;
+	}
+
+	std::size_t operator[]( std::size_t i ) const noexcept
+	{
+		return i < inline_capacity ? _inline[i] : _overflow[i - inline_capacity];
+	}
+
+	std::size_t size() const noexcept { return _size; }
+
+private:
+	static constexpr std::size_t inline_capacity = 64;
+
+	std::size_t              _size = 0;
+	std::size_t              _inline[inline_capacity];
+	std::vector<std::size_t> _overflow;
+};
+
+} // namespace mba::_detail_im_str
+
+#endif // IM_STR_DETAIL_SCAN_HPP
@@ -0,0 +1,226 @@
+#ifndef IM_STR_FLAT_MAP_HPP
+#define IM_STR_FLAT_MAP_HPP
+
+#include "detail/hash.hpp"
+#include "im_str.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mba {
+
+/**
+ * @brief Hash map from im_str (or local_im_str) keys to values
+ *
+ * The entries are stored contiguously in insertion order (until something gets erased) and
+ * are indexed by an open addressing hash table with linear probing. All lookups accept a
+ * std::string_view, so no key has to be constructed for them.
+ *
+ * Differences to std::unordered_map:
+ * - value_type is std::pair<Key, Value> - the key must not be modified through an iterator
+ * - inserting and erasing invalidates all iterators and references
+ * - erasing moves the last entry into the gap
+ */
+template<class Value, class Key = im_str>
+class im_str_flat_map {
+	static_assert( std::is_convertible_v<const Key&, std::string_view>, "Key has to be an im_str" );
+
+public:
+	using key_type       = Key;
+	using mapped_type    = Value;
+	using value_type     = std::pair<Key, Value>;
+	using size_type      = std::size_t;
+	using iterator       = typename std::vector<value_type>::iterator;
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+
+	im_str_flat_map() = default;
+
+	/* ############### Capacity / iteration ######################################################################### */
+	size_type size() const noexcept { return _entries.size(); }
+	bool      empty() const noexcept { return _entries.empty(); }
+
+	iterator       begin() noexcept { return _entries.begin(); }
+	iterator       end() noexcept { return _entries.end(); }
+	const_iterator begin() const noexcept { return _entries.begin(); }
+	const_iterator end() const noexcept { return _entries.end(); }
+
+	void clear() noexcept
+	{
+		_entries.clear();
+		std::fill( _buckets.begin(), _buckets.end(), Bucket{} );
+	}
+
+	void reserve( size_type cnt )
+	{
+		_entries.reserve( cnt );
+		if( _needs_grow( cnt ) ) { _rehash( _bucket_cnt_for( cnt ) ); }
+	}
+
+	/* ############### Lookup ####################################################################################### */
+	iterator find( std::string_view key ) noexcept
+	{
+		const auto i = _find( key, _detail_im_str::hash_bytes( key ) );
+		return i == npos ? end() : begin() + i;
+	}
+	const_iterator find( std::string_view key ) const noexcept
+	{
+		const auto i = _find( key, _detail_im_str::hash_bytes( key ) );
+		return i == npos ? end() : begin() + i;
+	}
+
+	bool      contains( std::string_view key ) const noexcept { return find( key ) != end(); }
+	size_type count( std::string_view key ) const noexcept { return contains( key ) ? 1 : 0; }
+
+	Value& at( std::string_view key )
+	{
+		const auto it = find( key );
+		if( it == end() ) { throw std::out_of_range( "im_str_flat_map::at: key not found" ); }
+		return it->second;
+	}
+	const Value& at( std::string_view key ) const
+	{
+		const auto it = find( key );
+		if( it == end() ) { throw std::out_of_range( "im_str_flat_map::at: key not found" ); }
+		return it->second;
+	}
+
+	/* ############### Modification ################################################################################# */
+	template<class... ARGS>
+	std::pair<iterator, bool> try_emplace( Key key, ARGS&&... args )
+	{
+		const auto hash = key.hash();
+		if( const auto i = _find( key, hash ); i != npos ) { return { begin() + i, false }; }
+
+		if( _needs_grow( _entries.size() + 1 ) ) { _rehash( _bucket_cnt_for( _entries.size() + 1 ) ); }
+		_entries.emplace_back( std::piecewise_construct,
+							   std::forward_as_tuple( std::move( key ) ),
+							   std::forward_as_tuple( std::forward<ARGS>( args )... ) );
+		_place( Bucket{ static_cast<std::uint32_t>( hash ), static_cast<std::uint32_t>( _entries.size() ) } );
+		return { end() - 1, true };
+	}
+
+	std::pair<iterator, bool> insert( value_type entry )
+	{
+		return try_emplace( std::move( entry.first ), std::move( entry.second ) );
+	}
+
+	template<class V>
+	std::pair<iterator, bool> insert_or_assign( Key key, V&& value )
+	{
+		auto ret = try_emplace( std::move( key ), std::forward<V>( value ) );
+		if( !ret.second ) { ret.first->second = std::forward<V>( value ); }
+		return ret;
+	}
+
+	Value& operator[]( Key key ) { return try_emplace( std::move( key ) ).first->second; }
+
+	// Returns the number of erased entries (0 or 1)
+	size_type erase( std::string_view key )
+	{
+		if( _buckets.empty() ) { return 0; }
+
+		const std::size_t b = _bucket_of( key, _detail_im_str::hash_bytes( key ) );
+		if( b == npos ) { return 0; }
+
+		const std::size_t idx = _buckets[b].idx - 1;
+		_remove_bucket( b );
+
+		// fill the gap in the entries with the last one
+		const std::size_t last = _entries.size() - 1;
+		if( idx != last ) {
+			const auto& moved = _entries[last].first;
+			_buckets[_bucket_of( moved, moved.hash() )].idx = static_cast<std::uint32_t>( idx + 1 );
+			_entries[idx]                                   = std::move( _entries[last] );
+		}
+		_entries.pop_back();
+		return 1;
+	}
+
+private:
+	static constexpr std::size_t npos = std::size_t( -1 );
+
+	struct Bucket {
+		std::uint32_t hash_lo = 0; // lower 32 bits of the hash (enough for the bucket index)
+		std::uint32_t idx     = 0; // index into _entries + 1 (0: empty)
+	};
+
+	std::size_t _mask() const noexcept { return _buckets.size() - 1; }
+
+	// max load factor 0.75
+	bool _needs_grow( std::size_t cnt ) const noexcept { return cnt * 4 > _buckets.size() * 3; }
+
+	static std::size_t _bucket_cnt_for( std::size_t cnt ) noexcept
+	{
+		std::size_t bucket_cnt = 16;
+		while( cnt * 4 > bucket_cnt * 3 ) {
+			bucket_cnt *= 2;
+		}
+		return bucket_cnt;
+	}
+
+	// Index of the bucket that refers to the entry with \p key (npos if there is none)
+	std::size_t _bucket_of( std::string_view key, std::uint64_t hash ) const noexcept
+	{
+		const auto hash_lo = static_cast<std::uint32_t>( hash );
+		for( std::size_t i = hash_lo & _mask();; i = ( i + 1 ) & _mask() ) {
+			const Bucket& bucket = _buckets[i];
+			if( bucket.idx == 0 ) { return npos; }
+			if( bucket.hash_lo == hash_lo && std::string_view( _entries[bucket.idx - 1].first ) == key ) { return i; }
+		}
+	}
+
+	// Index of the entry with \p key (npos if there is none)
+	std::size_t _find( std::string_view key, std::uint64_t hash ) const noexcept
+	{
+		if( _buckets.empty() ) { return npos; }
+		const std::size_t b = _bucket_of( key, hash );
+		return b == npos ? npos : _buckets[b].idx - 1;
+	}
+
+	void _place( Bucket bucket ) noexcept
+	{
+		std::size_t i = bucket.hash_lo & _mask();
+		while( _buckets[i].idx != 0 ) {
+			i = ( i + 1 ) & _mask();
+		}
+		_buckets[i] = bucket;
+	}
+
+	// Backward shift deletion: moves following buckets of the same probe sequence into the gap
+	void _remove_bucket( std::size_t gap ) noexcept
+	{
+		for( std::size_t i = ( gap + 1 ) & _mask(); _buckets[i].idx != 0; i = ( i + 1 ) & _mask() ) {
+			const std::size_t home = _buckets[i].hash_lo & _mask();
+			// distance from the home bucket to the gap has to be smaller than to the current position
+			if( ( ( gap - home ) & _mask() ) < ( ( i - home ) & _mask() ) ) {
+				_buckets[gap] = _buckets[i];
+				gap           = i;
+			}
+		}
+		_buckets[gap] = Bucket{};
+	}
+
+	void _rehash( std::size_t bucket_cnt )
+	{
+		assert( bucket_cnt <= std::size_t( 1 ) << 32 );
+		std::vector<Bucket> old = std::exchange( _buckets, std::vector<Bucket>( bucket_cnt ) );
+		for( const Bucket& bucket : old ) {
+			if( bucket.idx != 0 ) { _place( bucket ); }
+		}
+	}
+
+	std::vector<value_type> _entries;
+	std::vector<Bucket>     _buckets;
+};
+
+} // namespace mba
+
+#endif // IM_STR_FLAT_MAP_HPP
@@ -3,7 +3,9 @@
 
 #include "detail/config.hpp"
 #include "detail/ref_cnt_buf.hpp"
+#include "detail/scan.hpp"
 #include "detail/string_view_mixin.hpp"
+#include "im_str_fwd.hpp"
 
 #if IM_STR_USE_CUSTOM_DYN_ARRAY
 #include "detail/dynamic_array.hpp"
@@ -13,6 +15,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <functional> // std::hash
 #include <numeric>
 #include <string_view>
 #include <type_traits>
@@ -20,47 +24,66 @@
 
 namespace mba {
 
-/**
- * Same as im_str, but guaranteed to be zero terminated
- *
- * Forward declaration, as some im_str member functions return a
- * zero terminated im_str
- */
-class im_zstr;
+namespace _detail_im_str {
+// shared by all ref count policies, such that to_shared can keep the zero termination guarantee
+struct is_zero_terminated_tag {
+};
+} // namespace _detail_im_str
 
 /**
  * im_str is an immutable string class that doesn't allocate
  * when constructed from string litterals
  *
- * Forward declaration, as some im_str member functions return a
- * zero terminated im_str
+ * Short strings (up to sso_capacity chars) are stored inside the im_str object
+ * itself (small string optimization). Copying them copies the characters instead
+ * of bumping a ref count. As with std::string, data() and the string_view
+ * conversion are then only valid as long as that particular object lives.
+ *
+ * The RefCntPolicy determines how the ref count of a shared buffer is modified:
+ * im_str uses atomic operations, local_im_str plain loads and stores (see im_str_fwd.hpp).
+ * A local_im_str and all strings that share its buffer must only be used by a single
+ * thread. Use to_shared() to pass it to other threads.
  */
-class im_str : public mba::_detail::str_view_mixin<im_str> {
-	using Base_t = mba::_detail::str_view_mixin<im_str>;
+template<class RefCntPolicy>
+class basic_im_str : public mba::_detail::str_view_mixin<basic_im_str<RefCntPolicy>> {
+	using Base_t = mba::_detail::str_view_mixin<basic_im_str<RefCntPolicy>>;
+	using zstr_t = basic_im_zstr<RefCntPolicy>;
 
 protected:
-	using Handle_t = _detail_im_str::atomic_ref_cnt_buffer;
+	using Handle_t = _detail_im_str::basic_ref_cnt_buffer<RefCntPolicy>;
 
 public:
+	using typename Base_t::iterator;
+	using typename Base_t::size_type;
+	using Base_t::npos;
+
+	using Base_t::begin;
+	using Base_t::data;
+	using Base_t::end;
+	using Base_t::size;
+
+	// Strings up to this length don't need a heap allocation (see IM_STR_USE_SSO)
+	static constexpr std::size_t sso_capacity = IM_STR_USE_SSO ? sizeof( Handle_t ) - 1 : 0;
+
 #ifdef IM_STR_USE_CUSTOM_DYN_ARRAY
-	using DynArray_t = _detail_im_str::dynamic_array<im_str>;
+	using DynArray_t = _detail_im_str::dynamic_array<basic_im_str>;
 #else
-	using DynArray_t = std::vector<im_str>;
+	using DynArray_t = std::vector<basic_im_str>;
 #endif
 	/* #################### CTORS ################################################################################### */
 
 	// Default ConstString points at empty string
-	constexpr im_str() noexcept = default;
+	constexpr basic_im_str() noexcept = default;
 
-	IM_STR_CONSTEXPR_IN_CPP_20 explicit im_str( std::string_view                                   other,
-												_detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc = nullptr )
+	IM_STR_CONSTEXPR_IN_CPP_20 explicit basic_im_str( std::string_view                                   other,
+												_detail_im_str::alloc_ptr_t alloc = nullptr )
 	{
 		_copy_from( other, alloc );
 	}
 
 	// NOTE: Use only for string literals (arrays with static storage duration)!!!
 	template<std::size_t N>
-	constexpr im_str( const char ( &other )[N] ) noexcept
+	constexpr basic_im_str( const char ( &other )[N] ) noexcept
 		: _view( other )
 	// we don't have to copy the data to the freestore as string litterals already have static lifetime
 	{
@@ -83,7 +106,7 @@ public:
 	 * @param Tag type
 	 * @return
 	 */
-	constexpr im_str( std::string_view string, trust_me_this_is_from_a_string_litteral_t ) noexcept
+	constexpr basic_im_str( std::string_view string, trust_me_this_is_from_a_string_litteral_t ) noexcept
 		: _view( string )
 	{
 	}
@@ -91,67 +114,106 @@ public:
 	// don't accept c-strings in the form of pointer
 	// if you need to create a im_str from a c string use the factory function im_str::from_c_str
 	template<class T>
-	im_str( T const* const& other ) = delete;
+	basic_im_str( T const* const& other ) = delete;
 
-	IM_STR_CONSTEXPR_IN_CPP_20 static im_str from_c_str( const char* str )
+	IM_STR_CONSTEXPR_IN_CPP_20 static basic_im_str from_c_str( const char* str )
 	{
-		return im_str{ std::string_view( str ) };
+		return basic_im_str{ std::string_view( str ) };
 	};
 
 
 	/* ############### Special member functions ##################################################################### */
-	constexpr im_str( const im_str& other ) noexcept = default;
-	constexpr im_str( im_str&& other ) noexcept
-		: _view( _detail_im_str::c_expr_exchange( other._as_strview(), std::string_view{} ) )
-		, _handle( std::move( other._handle ) )
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str( const basic_im_str& other ) noexcept
+		: _view( other._view )
+		, _handle( other._is_sso() ? Handle_t{} : other._handle )
+	{
+		if( other._is_sso() ) { _store_sso( other._view ); }
+	}
+
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str( basic_im_str&& other ) noexcept
+		: _view( other._view )
+		, _handle( other._is_sso() ? Handle_t{} : std::move( other._handle ) )
 	{
+		if( other._is_sso() ) {
+			_store_sso( other._view );
+			other._leave_sso();
+		}
+		other._view = std::string_view{};
 	}
 
-	// NOTE could be = defaulted in c++20 but needs to be written down explicitly in c++17 in order to be constexpr
-	constexpr im_str& operator=( const im_str& other ) noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str& operator=( const basic_im_str& other ) noexcept
 	{
-		this->_view   = other._view;
-		this->_handle = other._handle;
+		if( this == &other ) { return *this; }
+		if( other._is_sso() ) {
+			_drop_handle();
+			_store_sso( other._view );
+		} else {
+			if( _is_sso() ) { _leave_sso(); }
+			this->_handle = other._handle;
+			this->_view   = other._view;
+		}
 		return *this;
 	}
 
-	constexpr im_str& operator=( im_str&& other ) noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str& operator=( basic_im_str&& other ) noexcept
 	{
-		this->_view   = _detail_im_str::c_expr_exchange( other._as_strview(), std::string_view{} );
-		this->_handle = std::move( other._handle );
+		if( other._is_sso() ) {
+			_drop_handle();
+			_store_sso( other._view );
+			other._leave_sso();
+		} else {
+			if( _is_sso() ) { _leave_sso(); }
+			this->_view   = _detail_im_str::c_expr_exchange( other._as_strview(), std::string_view{} );
+			this->_handle = std::move( other._handle );
+		}
 		return *this;
 	}
 
+	IM_STR_CONSTEXPR_IN_CPP_20 ~basic_im_str()
+	{
+		if( !_is_sso() ) { _handle.~Handle_t(); }
+	}
+
 	/* ################## String functions  ######################################################################### */
 	constexpr operator std::string_view() const { return this->_view; }
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( std::size_t offset = 0, std::size_t count = npos ) const& noexcept
+	// Same value as _detail_im_str::hash_bytes( std::string_view( *this ) ), cached if IM_STR_CACHE_HASH is set
+	std::uint64_t hash() const noexcept
 	{
+		if( _is_sso() ) { return _detail_im_str::hash_bytes( _view ); }
+		return _handle.hash_of( _view );
+	}
+
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( std::size_t offset = 0, std::size_t count = npos ) const& noexcept
+	{
+		if( _is_sso() ) { return basic_im_str( this->_as_strview().substr( offset, count ), sso_tag{} ); }
 		return {
 			this->_as_strview().substr( offset, count ), //
 			this->_handle                                //
 		};
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( std::size_t offset = 0, std::size_t count = npos ) && noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( std::size_t offset = 0, std::size_t count = npos ) && noexcept
 	{
+		if( _is_sso() ) { return basic_im_str( this->_as_strview().substr( offset, count ), sso_tag{} ); }
 		return {
 			this->_as_strview().substr( offset, count ), //
 			std::move( this->_handle )                   //
 		};
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( std::string_view range ) const noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( std::string_view range ) const noexcept
 	{
 		// TODO: strictly speaking those pointer comparisons are UB
 		assert( ( data() <= range.data() ) && ( range.data() + range.size() <= data() + size() ) );
+		if( _is_sso() ) { return basic_im_str( range, sso_tag{} ); }
 		return {
 			range,        //
 			this->_handle //
 		};
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( iterator start, iterator end ) const noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( iterator start, iterator end ) const noexcept
 	{
 		assert( end >= start );
 		// UGLY: start-begin()+data() is necessary to convert from an iterator to a pointer
@@ -159,7 +221,7 @@ public:
 		return substr( std::string_view( start - begin() + data(), static_cast<size_type>( end - start ) ) );
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr_sentinel( std::size_t offset, char sentinel ) const noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr_sentinel( std::size_t offset, char sentinel ) const noexcept
 	{
 		const auto size = _view.find( sentinel, offset );
 		return substr( offset, size - offset );
@@ -176,13 +238,13 @@ public:
 	enum class Split { Drop, Before, After };
 
 	// split string into two substrings [0,i) and [i, this->size() )
-	[[deprecated( "Use split_at instead" )]] std::pair<im_str, im_str> split( std::size_t i ) const
+	[[deprecated( "Use split_at instead" )]] std::pair<basic_im_str, basic_im_str> split( std::size_t i ) const
 	{
 		return split_at( i );
 	}
 
 	// split string into two substrings [0,i) and [i, this->size() )
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_at( std::size_t i ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_at( std::size_t i ) const
 	{
 		assert( i < size() || i == npos );
 		if( i == npos ) { return { *this, {} }; }
@@ -190,7 +252,7 @@ public:
 	}
 
 	// split string into two substrings [0,i) and [i, this->size() )
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_at( std::size_t i, Split s ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_at( std::size_t i, Split s ) const
 	{
 		assert( i < size() || i == npos );
 		if( i == npos ) { return { *this, {} }; }
@@ -199,30 +261,30 @@ public:
 	}
 
 	// split string on first occurence of c.
-	[[deprecated( "Use split_on_first instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str>
+	[[deprecated( "Use split_on_first instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str>
 																			  split_first( char c = ' ', Split s = Split::Drop ) const
 	{
 		return split_on_first( c, s );
 	}
 
 	// split string on last occurence of c.
-	[[deprecated( "Use split_on_last instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str>
+	[[deprecated( "Use split_on_last instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str>
 																			 split_last( char c = ' ', Split s = Split::Drop ) const
 	{
 		return split_on_last( c, s );
 	}
 
 	// split string on first occurence of c.
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_on_first( char c = ' ', Split s = Split::Drop ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_on_first( char c = ' ', Split s = Split::Drop ) const
 	{
-		auto pos = _view.find( c );
+		auto pos = _detail_im_str::find_char( _view, c );
 		return split_at( pos, s );
 	}
 
 	// split string on last occurence of c
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_on_last( char c = ' ', Split s = Split::Drop ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_on_last( char c = ' ', Split s = Split::Drop ) const
 	{
-		auto pos = _view.rfind( c );
+		auto pos = _detail_im_str::rfind_char( _view, c );
 		return split_at( pos, s );
 	}
 
@@ -244,7 +306,11 @@ public:
 	{
 		if( size() == 0 ) { return {}; }
 
-		const auto split_cnt = 1 + std::count( begin(), end(), delimiter );
+		// single pass over the data, that finds all delimiters
+		_detail_im_str::position_buffer positions;
+		_detail_im_str::for_each_char_pos( _view, delimiter, [&]( std::size_t pos ) { positions.push_back( pos ); } );
+
+		const auto split_cnt = 1 + positions.size();
 
 		DynArray_t ret( split_cnt );
 		{
@@ -269,17 +335,21 @@ public:
 
 			const std::string_view self_view = this->_as_strview();
 			std::size_t            start_pos = 0;
+			std::size_t            i         = 0;
 			for( auto& slice : ret ) {
 
-				const auto found_pos = _view.find( delimiter, start_pos + (s == Split::Before) );
+				const auto found_pos = i < positions.size() ? positions[i++] : npos;
 
-				slice = im_str(
-					// std::string_view::substr(offset,count) allows count to be bigger than size,
-					// so we don't have to check for npos here
-					self_view.substr( start_pos, found_pos - start_pos + ( s == Split::After ) ),
-					_handle,
-					_detail_im_str::defer_ref_cnt_tag // ref count will be incremented at the end of the function
-				);
+				// std::string_view::substr(offset,count) allows count to be bigger than size,
+				// so we don't have to check for npos here
+				const auto slice_view = self_view.substr( start_pos, found_pos - start_pos + ( s == Split::After ) );
+
+				slice = _is_sso()
+							? basic_im_str( slice_view, sso_tag{} )
+							: basic_im_str( slice_view,
+									  _handle,
+									  _detail_im_str::defer_ref_cnt_tag // ref count will be incremented at the end
+							  );
 
 				start_pos = found_pos + ( s == Split::Drop || s == Split::After );
 			}
@@ -294,58 +364,70 @@ public:
 #endif
 			guard.comitted = true;
 		}
-		_handle.add_ref_cnt( static_cast<int>( split_cnt ) );
+		if( !_is_sso() ) { _handle.add_ref_cnt( static_cast<int>( split_cnt ) ); }
 
 		return ret;
 	}
 
 	constexpr bool is_zero_terminated() const noexcept { return this->data()[size()] == '\0'; }
 
-	constexpr bool wrapps_a_string_litteral() const noexcept { return _handle == nullptr; }
+	constexpr bool wrapps_a_string_litteral() const noexcept { return !_is_sso() && _handle == nullptr; }
 
 	/**
-	 * This will create a new im_str (actually a im_zstr) whose data resides in a freshly
-	 * allocated memory block
+	 * This will create a new im_str (actually a im_zstr) whose data isn't shared with any
+	 * other string (it resides in a freshly allocated memory block or the sso buffer)
 	 */
-	IM_STR_CONSTEXPR_IN_CPP_20 im_zstr unshare() const;
+	IM_STR_CONSTEXPR_IN_CPP_20 zstr_t unshare() const;
 
 	/**
 	 * Returns a copy if the string is already zero terminated and calls unshare otherwise
 	 */
-	IM_STR_CONSTEXPR_IN_CPP_20 im_zstr create_zstr() const&;
+	IM_STR_CONSTEXPR_IN_CPP_20 zstr_t create_zstr() const&;
 
 	/**
 	 * Moves "this" into the return value if string is already zero terminated and calls unshare otherwise
 	 */
-	IM_STR_CONSTEXPR_IN_CPP_20 im_zstr create_zstr() &&;
+	IM_STR_CONSTEXPR_IN_CPP_20 zstr_t create_zstr() &&;
+
+	/**
+	 * Converts the string into the flavor with atomic ref counts (im_str), which can be shared between threads.
+	 * The data is only copied, if other strings still refer to the same buffer
+	 */
+	im_str to_shared() const& { return _convert_to<_detail_im_str::atomic_ref_cnt_policy>( *this ); }
+	im_str to_shared() && { return _convert_to<_detail_im_str::atomic_ref_cnt_policy>( std::move( *this ) ); }
 
 protected:
 	class static_lifetime_tag {
 	};
 
 	// used for constructor in im_zstr
-	class is_zero_terminated_tag {
+	using is_zero_terminated_tag = _detail_im_str::is_zero_terminated_tag;
+
+	// copy the data into the sso buffer
+	class sso_tag {
 	};
 
-	constexpr im_str( std::string_view sv, static_lifetime_tag )  noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str( std::string_view sv, sso_tag ) noexcept { _store_sso( sv ); }
+
+	constexpr basic_im_str( std::string_view sv, static_lifetime_tag )  noexcept
 		: _view( sv )
 	{
 	}
 
 	// mostly used in substr
-	constexpr im_str( std::string_view sv, const Handle_t& data ) noexcept
+	constexpr basic_im_str( std::string_view sv, const Handle_t& data ) noexcept
 		: _view( sv )
 		, _handle{ data }
 	{
 	}
 
-	constexpr im_str( std::string_view sv, Handle_t&& data ) noexcept
+	constexpr basic_im_str( std::string_view sv, Handle_t&& data ) noexcept
 		: _view( sv )
 		, _handle{ std::move(data) }
 	{
 	}
 
-	constexpr im_str( std::string_view sv, const Handle_t& data, _detail_im_str::defer_ref_cnt_tag_t ) noexcept
+	constexpr basic_im_str( std::string_view sv, const Handle_t& data, _detail_im_str::defer_ref_cnt_tag_t ) noexcept
 		: _view( sv )
 		, _handle{ data, _detail_im_str::defer_ref_cnt_tag_t{} }
 	{
@@ -354,20 +436,44 @@ protected:
 	/**
 	 * private constructor, that takes ownership of a buffer and a size (used in _copy_from and _concat_impl)
 	 */
-	constexpr im_str( Handle_t&& handle, const char* data, size_t size )
+	constexpr basic_im_str( Handle_t&& handle, const char* data, size_t size )
 		: _view( data, size )
 		, _handle( std::move( handle ) )
 	{
 	}
 
-	friend constexpr void swap( im_str& l, im_str& r ) noexcept;
+	friend IM_STR_CONSTEXPR_IN_CPP_20 void swap( basic_im_str& l, basic_im_str& r ) noexcept
+	{
+		if( l._is_sso() || r._is_sso() ) {
+			basic_im_str tmp( std::move( l ) );
+			l = std::move( r );
+			r = std::move( tmp );
+			return;
+		}
+
+		swap( l._handle, r._handle );
+
+		// TODO: in c++20:
+		// using std::swap;
+		// swap( l._as_strview(), r._as_strview() );  // not yet constexpr
+		std::string_view t = l._as_strview();
+		l._as_strview()    = r._as_strview();
+		r._as_strview()    = t;
+	}
+
+	friend void swap( basic_im_str& l, std::string_view& r ) = delete;
+	friend void swap( std::string_view& l, basic_im_str& r ) = delete;
 
-	friend void swap( im_str& l, std::string_view& r ) = delete;
-	friend void swap( std::string_view& l, im_str& r ) = delete;
+	template<class>
+	friend class basic_im_str;
 
 protected:
 	std::string_view _view{};
-	Handle_t         _handle{};
+	union {
+		Handle_t _handle{};
+		// Active, iff _view points into it
+		char _sso[sso_capacity + 1];
+	};
 
 	friend Base_t;
 	constexpr std::size_t _size_for_mixin() const noexcept { return _view.size(); }
@@ -376,173 +482,240 @@ protected:
 	constexpr std::string_view&       _as_strview() { return _view; }
 	constexpr const std::string_view& _as_strview() const { return _view; }
 
-	constexpr void release() noexcept { _handle.release(); }
+	constexpr void release() noexcept
+	{
+		if( !_is_sso() ) { _handle.release(); }
+	}
+
+	static constexpr bool _fits_sso( std::size_t size ) noexcept { return IM_STR_USE_SSO && size <= sso_capacity; }
+
+	// The size check is redundant, but lets the compiler drop the sso branches for strings of known length
+	constexpr bool _is_sso() const noexcept
+	{
+		return IM_STR_USE_SSO && _view.data() == _sso && _view.size() <= sso_capacity;
+	}
+
+	// Copies sv into the sso buffer. The handle must not own a buffer (i.e. be empty or inactive)
+	IM_STR_CONSTEXPR_IN_CPP_20 void _store_sso( std::string_view sv ) noexcept
+	{
+		assert( _fits_sso( sv.size() ) );
+		char* const end = std::copy_n( sv.data(), sv.size(), _sso );
+		*end            = '\0';
+		_view           = std::string_view( _sso, sv.size() );
+	}
+
+	// Lets fill( char* ) write \p size chars directly into the sso buffer
+	template<class Fill>
+	void _fill_sso( std::size_t size, Fill&& fill )
+	{
+		assert( _fits_sso( size ) );
+		_drop_handle();
+		fill( _sso );
+		_sso[size] = '\0';
+		_view      = std::string_view( _sso, size );
+	}
+
+	// Turns a sso string into an empty string with an (empty) active handle
+	void _leave_sso() noexcept
+	{
+		assert( _is_sso() );
+		::new( static_cast<void*>( &_handle ) ) Handle_t{};
+		_view = std::string_view{};
+	}
+
+	// Releases the buffer owned by the handle (if any)
+	IM_STR_CONSTEXPR_IN_CPP_20 void _drop_handle() noexcept
+	{
+		if( !_is_sso() ) { _handle = Handle_t{}; }
+	}
 
 	IM_STR_CONSTEXPR_IN_CPP_20 void _copy_from( const std::string_view                             other,
-												_detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc )
+												_detail_im_str::alloc_ptr_t alloc )
 	{
 		if( other.data() == nullptr ) {
 			this->_as_strview() = std::string_view{ "" };
 			return;
 		}
+		if( _fits_sso( other.size() ) ) {
+			_drop_handle();
+			_store_sso( other );
+			return;
+		}
 		// create buffer and copy data over
 		auto [data, handle] = Handle_t::allocate_null_terminated_char_buffer( static_cast<int>( other.size() ), alloc );
 		std::copy_n( other.data(), other.size(), data );
 
 		// initialize data fields;
-		*this = im_str( std::move( handle ), data, other.size() );
+		*this = basic_im_str( std::move( handle ), data, other.size() );
 	}
-};
 
-constexpr void swap( im_str& l, im_str& r ) noexcept
-{
-	swap( l._handle, r._handle );
-
-	// TODO: in c++20:
-	// using std::swap;
-	// swap( l._as_strview(), r._as_strview() );  // not yet constexpr
-	std::string_view t = l._as_strview();
-	l._as_strview()    = r._as_strview();
-	r._as_strview()    = t;
-}
+	// Hands the buffer over to a string with a different ref count policy if possible and copies the data otherwise
+	template<class OtherPolicy, class Self>
+	static basic_im_str<OtherPolicy> _convert_to( Self&& self )
+	{
+		using Other_t = basic_im_str<OtherPolicy>;
+		if constexpr( std::is_same_v<OtherPolicy, RefCntPolicy> ) { return std::forward<Self>( self ); }
+		if( self._is_sso() ) { return Other_t( self._view, typename Other_t::sso_tag{} ); }
+		if( self._handle == nullptr ) { return Other_t( self._view, typename Other_t::static_lifetime_tag{} ); }
+		if constexpr( !std::is_lvalue_reference_v<Self> ) {
+			if( self._handle.is_unique() ) {
+				const std::string_view view = _detail_im_str::c_expr_exchange( self._view, std::string_view{} );
+				return Other_t( view, typename Other_t::Handle_t( std::move( self._handle ) ) );
+			}
+		}
+		return Other_t( self._view );
+	}
+};
 
 namespace _detail_im_str_concat {
-// ARGS must be std::string_view
-template<class... ARGS>
-im_zstr variadic_helper( const ARGS... args );
-
-template<class T>
-im_zstr range_helper( const T& args );
-
-template<class... ARGS>
-im_zstr variadic_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, const ARGS... args );
-
-template<class T>
-im_zstr range_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, const T& args );
-
+template<class ZStr, class Fill>
+ZStr create_with( std::size_t size, _detail_im_str::alloc_ptr_t alloc, Fill&& fill );
 } // namespace _detail_im_str_concat
 
 namespace _detail_im_str {
+/**
+ * Creates a ZStr that takes ownership of \p handle, whose buffer has to contain \p size chars
+ * starting at \p data followed by a zero (used for buffers that are not allocated by im_str itself)
+ */
+template<class ZStr, class Handle>
+ZStr zstr_from_handle( Handle&& handle, const char* data, std::size_t size )
+{
+	return ZStr( std::move( handle ), data, size );
+}
+
 inline constexpr std::string_view getEmptyZeroTerminatedStringView() noexcept
 {
 	return std::string_view{ "" };
 }
 } // namespace _detail_im_str
 
-class im_zstr : public im_str {
-	using im_str::im_str;
+/**
+ * Same as im_str, but guaranteed to be zero terminated
+ */
+template<class RefCntPolicy>
+class basic_im_zstr : public basic_im_str<RefCntPolicy> {
+	using Str_t = basic_im_str<RefCntPolicy>;
+	using Str_t::Str_t;
+
+	using typename Str_t::Handle_t;
+	using typename Str_t::is_zero_terminated_tag;
+	using typename Str_t::static_lifetime_tag;
 
 public:
-	constexpr im_zstr() noexcept
-		: im_str( _detail_im_str::getEmptyZeroTerminatedStringView(), im_str::static_lifetime_tag{} )
+	using typename Str_t::trust_me_this_is_from_a_string_litteral_t;
+
+	constexpr basic_im_zstr() noexcept
+		: Str_t( _detail_im_str::getEmptyZeroTerminatedStringView(), static_lifetime_tag{} )
 	{
 	}
-	IM_STR_CONSTEXPR_IN_CPP_20 explicit im_zstr( std::string_view other )
-		: im_str( other.data() == nullptr ? _detail_im_str::getEmptyZeroTerminatedStringView() : other )
+	IM_STR_CONSTEXPR_IN_CPP_20 explicit basic_im_zstr( std::string_view other )
+		: Str_t( other.data() == nullptr ? _detail_im_str::getEmptyZeroTerminatedStringView() : other )
 	{
 	}
 
-	constexpr im_zstr( const im_str& other, is_zero_terminated_tag ) noexcept
-		: im_str( other )
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_zstr( const Str_t& other, is_zero_terminated_tag ) noexcept
+		: Str_t( other )
 	{
 	}
 
-	constexpr im_zstr( im_str&& other, is_zero_terminated_tag ) noexcept
-		: im_str( std::move( other ) )
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_zstr( Str_t&& other, is_zero_terminated_tag ) noexcept
+		: Str_t( std::move( other ) )
 	{
 	}
 
 	// NOTE: Use only for string literals (arrays with static storage duration)!!!
 	template<std::size_t N>
-	constexpr im_zstr( const char ( &other )[N] ) noexcept
-		: im_str( other )
+	constexpr basic_im_zstr( const char ( &other )[N] ) noexcept
+		: Str_t( other )
 	{
 	}
 
-	constexpr im_zstr( std::string_view other, trust_me_this_is_from_a_string_litteral_t t ) noexcept
-		: im_str( other, t )
+	constexpr basic_im_zstr( std::string_view other, trust_me_this_is_from_a_string_litteral_t t ) noexcept
+		: Str_t( other, t )
 	{
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 static im_zstr from_c_str( const char* str )
+	IM_STR_CONSTEXPR_IN_CPP_20 static basic_im_zstr from_c_str( const char* str )
 	{
-		return im_zstr{ std::string_view( str ) };
+		return basic_im_zstr{ std::string_view( str ) };
 	};
 
 	constexpr const char* c_str() const { return this->data(); }
 
 	constexpr bool is_zero_terminated() const noexcept
 	{
-		assert( im_str::is_zero_terminated() );
+		assert( Str_t::is_zero_terminated() );
 		return true;
 	}
 
-	friend constexpr void swap( im_zstr& l,
-								im_zstr& r ) noexcept; // needs to be defined out of line, otherwise swap(handle,handle)
-													   // can't be used in the implemenentation
+	// Same as basic_im_str::to_shared, but keeps the guarantee that the string is zero terminated
+	im_zstr to_shared() const& { return im_zstr( Str_t::to_shared(), is_zero_terminated_tag{} ); }
+	im_zstr to_shared() && { return im_zstr( static_cast<Str_t&&>( *this ).to_shared(), is_zero_terminated_tag{} ); }
 
-	friend void swap( im_str& l, im_zstr& r ) = delete;
-	friend void swap( im_zstr& l, im_str& r ) = delete;
+	friend IM_STR_CONSTEXPR_IN_CPP_20 void swap( basic_im_zstr& l, basic_im_zstr& r ) noexcept
+	{
+		swap( static_cast<Str_t&>( l ), static_cast<Str_t&>( r ) );
+	}
+
+	friend void swap( Str_t& l, basic_im_zstr& r ) = delete;
+	friend void swap( basic_im_zstr& l, Str_t& r ) = delete;
 
 private:
+	template<class>
+	friend class basic_im_zstr;
+
 	/**
 	 * private constructor, that takes ownership of a buffer and a size (used in _copy_from and _concat_impl)
 	 */
-	im_zstr( _detail_im_str::atomic_ref_cnt_buffer&& handle, const char* data, size_t size )
-		: im_str( std::move( handle ), data, size )
+	basic_im_zstr( Handle_t&& handle, const char* data, size_t size )
+		: Str_t( std::move( handle ), data, size )
 	{
 	}
 
-	template<class... ARGS>
-	friend im_zstr _detail_im_str_concat::variadic_helper( const ARGS... args );
+	template<class ZStr, class Fill>
+	friend ZStr _detail_im_str_concat::create_with( std::size_t size, _detail_im_str::alloc_ptr_t alloc, Fill&& fill );
 
-	template<class T>
-	friend im_zstr _detail_im_str_concat::range_helper( const T& args );
-
-	template<class... ARGS>
-	friend im_zstr _detail_im_str_concat::variadic_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc,
-														   const ARGS... args );
+	template<class ZStr, class Handle>
+	friend ZStr _detail_im_str::zstr_from_handle( Handle&& handle, const char* data, std::size_t size );
 
-	template<class T>
-	friend im_zstr _detail_im_str_concat::range_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc,
-														const T&                                           args );
+	friend basic_im_str_arena<RefCntPolicy>;
+	friend basic_im_str_builder<RefCntPolicy>;
 };
 
-constexpr void swap( im_zstr& l, im_zstr& r ) noexcept
-{
-	swap( l._handle, r._handle );
-
-	// TODO: in c++20:
-	// using std::swap;
-	// swap( l._as_strview(), r._as_strview() );  // not yet constexpr
-	std::string_view t = l._as_strview();
-	l._as_strview()    = r._as_strview();
-	r._as_strview()    = t;
-}
-
-IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr im_str::unshare() const
+template<class RefCntPolicy>
+IM_STR_CONSTEXPR_IN_CPP_20 inline basic_im_zstr<RefCntPolicy> basic_im_str<RefCntPolicy>::unshare() const
 {
-	return im_zstr( static_cast<std::string_view>( *this ) );
+	return zstr_t( static_cast<std::string_view>( *this ) );
 }
 
-IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr im_str::create_zstr() const&
+template<class RefCntPolicy>
+IM_STR_CONSTEXPR_IN_CPP_20 inline basic_im_zstr<RefCntPolicy> basic_im_str<RefCntPolicy>::create_zstr() const&
 {
 	if( is_zero_terminated() ) {
-		return im_zstr{ { *this }, is_zero_terminated_tag{} }; // just copy
+		return zstr_t{ { *this }, is_zero_terminated_tag{} }; // just copy
 	} else {
 		return unshare();
 	}
 }
 
-IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr im_str::create_zstr() &&
+template<class RefCntPolicy>
+IM_STR_CONSTEXPR_IN_CPP_20 inline basic_im_zstr<RefCntPolicy> basic_im_str<RefCntPolicy>::create_zstr() &&
 {
 	if( is_zero_terminated() ) {
-		return im_zstr{ std::move( *this ), is_zero_terminated_tag{} }; // already zero terminated - just move
+		return zstr_t{ std::move( *this ), is_zero_terminated_tag{} }; // already zero terminated - just move
 	} else {
 		return unshare();
 	}
 }
 
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC diagnostic push
+// gcc can't tell that the sso branch in create_with is only taken for short strings
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#pragma GCC diagnostic ignored "-Wrestrict"
+#endif
+
 namespace _detail_im_str_concat {
 //######## impl helper for concat ###############
 inline void addTo( char*& buffer, const std::string_view str )
@@ -550,6 +723,25 @@ inline void addTo( char*& buffer, const std::string_view str )
 	buffer = std::copy_n( str.data(), str.size(), buffer );
 }
 
+/**
+ * Creates a ZStr (im_zstr or local_im_zstr) with \p size chars, which are written by fill( char* data ).
+ * Short strings end up in the sso buffer, all others in a newly allocated buffer
+ */
+template<class ZStr, class Fill>
+ZStr create_with( std::size_t size, _detail_im_str::alloc_ptr_t alloc, Fill&& fill )
+{
+	if( ZStr::_fits_sso( size ) ) {
+		ZStr ret;
+		ret._fill_sso( size, fill );
+		return ret;
+	}
+
+	auto buffer = ZStr::Handle_t::allocate_null_terminated_char_buffer( static_cast<int>( size ), alloc );
+	fill( buffer.data );
+
+	return ZStr( std::move( buffer.handle ), buffer.data, size );
+}
+
 /**
  * Function that can concatenate an arbitrary number of std::string_views
  */
@@ -559,13 +751,7 @@ im_zstr variadic_helper( const ARGS... args )
 	static_assert( ( std::is_same_v<ARGS, std::string_view> && ... ) );
 	const std::size_t newSize = ( 0 + ... + args.size() );
 
-	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
-		static_cast<int>( newSize ) );
-
-	auto* tmp_data_ptr = buffer.data;
-	( addTo( tmp_data_ptr, args ), ... );
-
-	return im_zstr( std::move( buffer.handle ), buffer.data, newSize );
+	return create_with<im_zstr>( newSize, nullptr, [&]( char* data ) { ( addTo( data, args ), ... ); } );
 }
 
 template<class T>
@@ -576,55 +762,45 @@ im_zstr range_helper( const T& args )
 			  return s + std::string_view( str ).size();
 		  } );
 
-	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
-		static_cast<int>( newSize ) );
-
-	auto* tmp_data_ptr = buffer.data;
-	for( auto&& e : args ) {
-		addTo( tmp_data_ptr, std::string_view( e ) );
-	}
-
-	return im_zstr( std::move( buffer.handle ), buffer.data, newSize );
+	return create_with<im_zstr>( newSize, nullptr, [&]( char* data ) {
+		for( auto&& e : args ) {
+			addTo( data, std::string_view( e ) );
+		}
+	} );
 }
 
 // overloads that use memory resources
 
 template<class... ARGS>
-im_zstr variadic_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, const ARGS... args )
+im_zstr variadic_helper( _detail_im_str::alloc_ptr_t alloc, const ARGS... args )
 {
 	static_assert( ( std::is_same_v<ARGS, std::string_view> && ... ) );
 	const std::size_t newSize = ( 0 + ... + args.size() );
 
-	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
-		static_cast<int>( newSize ), alloc );
-
-	auto* tmp_data_ptr = buffer.data;
-	( addTo( tmp_data_ptr, args ), ... );
-
-	return im_zstr( std::move( buffer.handle ), buffer.data, newSize );
+	return create_with<im_zstr>( newSize, alloc, [&]( char* data ) { ( addTo( data, args ), ... ); } );
 }
 
 template<class T>
-im_zstr range_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, const T& args )
+im_zstr range_helper( _detail_im_str::alloc_ptr_t alloc, const T& args )
 {
 	const std::size_t newSize
 		= std::accumulate( args.begin(), args.end(), std::size_t( 0 ), []( std::size_t s, const auto& str ) {
 			  return s + std::string_view( str ).size();
 		  } );
 
-	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
-		static_cast<int>( newSize ), alloc );
-
-	auto* tmp_data_ptr = buffer.data;
-	for( auto&& e : args ) {
-		addTo( tmp_data_ptr, std::string_view( e ) );
-	}
-
-	return im_zstr( std::move( buffer.handle ), buffer.data, newSize );
+	return create_with<im_zstr>( newSize, alloc, [&]( char* data ) {
+		for( auto&& e : args ) {
+			addTo( data, std::string_view( e ) );
+		}
+	} );
 }
 
 } // namespace _detail_im_str_concat
 
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC diagnostic pop
+#endif
+
 template<class ARG1, class... ARGS>
 inline auto concat( const ARG1 arg1, const ARGS&... args )
 	-> std::enable_if_t<std::is_convertible_v<ARG1, std::string_view>, im_zstr>
@@ -641,7 +817,7 @@ inline auto concat( const T& args ) -> std::enable_if_t<!std::is_convertible_v<T
 }
 
 template<class ARG1, class... ARGS>
-inline auto concat( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, const ARG1 arg1, const ARGS&... args )
+inline auto concat( _detail_im_str::alloc_ptr_t alloc, const ARG1 arg1, const ARGS&... args )
 	-> std::enable_if_t<std::is_convertible_v<ARG1, std::string_view>, im_zstr>
 {
 	static_assert( ( std::is_convertible_v<ARGS, std::string_view> && ... ),
@@ -649,7 +825,7 @@ inline auto concat( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, co
 	return _detail_im_str_concat::variadic_helper( alloc, std::string_view( arg1 ), std::string_view( args )... );
 }
 template<class T>
-inline auto concat( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, const T& args )
+inline auto concat( _detail_im_str::alloc_ptr_t alloc, const T& args )
 	-> std::enable_if_t<!std::is_convertible_v<T, std::string_view>, im_zstr>
 {
 	// static_assert( <args_is_a_range> )
@@ -661,4 +837,23 @@ static_assert( sizeof( im_zstr ) <= 3 * sizeof( void* ) );
 
 } // namespace mba
 
+// Transparent, so containers that support heterogeneous lookup can be searched with a std::string_view
+template<class RefCntPolicy>
+struct std::hash<mba::basic_im_str<RefCntPolicy>> {
+	using is_transparent = void;
+
+	std::size_t operator()( const mba::basic_im_str<RefCntPolicy>& str ) const noexcept
+	{
+		return static_cast<std::size_t>( str.hash() );
+	}
+	std::size_t operator()( std::string_view str ) const noexcept
+	{
+		return static_cast<std::size_t>( mba::_detail_im_str::hash_bytes( str ) );
+	}
+};
+
+template<class RefCntPolicy>
+struct std::hash<mba::basic_im_zstr<RefCntPolicy>> : std::hash<mba::basic_im_str<RefCntPolicy>> {
+};
+
 #endif
@@ -0,0 +1,37 @@
+#ifndef IM_STR_IM_STR_FWD_H
+#define IM_STR_IM_STR_FWD_H
+
+namespace mba {
+
+namespace _detail_im_str {
+struct atomic_ref_cnt_policy;
+struct local_ref_cnt_policy;
+} // namespace _detail_im_str
+
+template<class RefCntPolicy>
+class basic_im_str;
+
+template<class RefCntPolicy>
+class basic_im_zstr;
+
+template<class RefCntPolicy>
+class basic_im_str_arena;
+
+template<class RefCntPolicy>
+class basic_im_str_builder;
+
+using im_str  = basic_im_str<_detail_im_str::atomic_ref_cnt_policy>;
+using im_zstr = basic_im_zstr<_detail_im_str::atomic_ref_cnt_policy>;
+
+using local_im_str  = basic_im_str<_detail_im_str::local_ref_cnt_policy>;
+using local_im_zstr = basic_im_zstr<_detail_im_str::local_ref_cnt_policy>;
+
+using im_str_arena       = basic_im_str_arena<_detail_im_str::atomic_ref_cnt_policy>;
+using local_im_str_arena = basic_im_str_arena<_detail_im_str::local_ref_cnt_policy>;
+
+using im_str_builder       = basic_im_str_builder<_detail_im_str::atomic_ref_cnt_policy>;
+using local_im_str_builder = basic_im_str_builder<_detail_im_str::local_ref_cnt_policy>;
+
+} // namespace mba
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef IM_STR_INTERN_POOL_HPP
+#define IM_STR_INTERN_POOL_HPP
+
+#include "detail/hash.hpp"
+#include "im_str.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // std::hash
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace mba {
+
+class intern_pool;
+
+namespace _detail_im_str {
+struct intern_entry {
+	std::uint64_t hash;
+	im_zstr       str;
+};
+} // namespace _detail_im_str
+
+/**
+ * Handle to a string stored in an intern_pool
+ *
+ * All handles for the same value from the same pool refer to the same entry, so
+ * comparing two handles is a single pointer comparison and the hash is computed
+ * only once (when the string gets interned).
+ *
+ * A handle must not outlive the pool it came from (the im_zstr returned by str() can).
+ * A default constructed handle refers to the empty string.
+ */
+class interned_str {
+public:
+	constexpr interned_str() noexcept = default;
+
+	const im_zstr& str() const noexcept { return _entry ? _entry->str : _empty(); }
+	const char*    c_str() const noexcept { return str().c_str(); }
+	std::size_t    size() const noexcept { return str().size(); }
+	bool           empty() const noexcept { return _entry == nullptr; }
+
+	std::uint64_t hash() const noexcept { return _entry ? _entry->hash : _detail_im_str::hash_bytes( {} ); }
+
+	operator std::string_view() const noexcept { return str(); }
+
+	// Only meaningful for handles from the same pool
+	friend constexpr bool operator==( interned_str l, interned_str r ) noexcept { return l._entry == r._entry; }
+	friend constexpr bool operator!=( interned_str l, interned_str r ) noexcept { return l._entry != r._entry; }
+
+private:
+	friend intern_pool;
+
+	constexpr explicit interned_str( const _detail_im_str::intern_entry* entry ) noexcept
+		: _entry( entry )
+	{
+	}
+
+	static const im_zstr& _empty() noexcept
+	{
+		static const im_zstr empty{};
+		return empty;
+	}
+
+	const _detail_im_str::intern_entry* _entry = nullptr;
+};
+
+/**
+ * @brief Deduplicates strings, such that each distinct value is stored exactly once
+ *
+ * The pool is split into independent shards (selected by the hash of the string), each of
+ * which is an open addressing hash table. Looking up a value that is already in the pool
+ * doesn't take any lock. Only inserting a new value locks the mutex of a single shard.
+ *
+ * Entries are never removed, so the pool is meant for a bounded set of values like
+ * logger names, config keys or topic names.
+ */
+class intern_pool {
+	using Entry = _detail_im_str::intern_entry;
+
+public:
+	explicit intern_pool( std::size_t shard_cnt = 16 )
+	{
+		std::size_t cnt = 1;
+		while( cnt < shard_cnt && cnt < max_shard_cnt ) {
+			cnt *= 2;
+		}
+		_shard_mask = cnt - 1;
+		_shards     = std::make_unique<Shard[]>( cnt );
+		for( std::size_t i = 0; i < cnt; ++i ) {
+			_shards[i].tables.push_back( std::make_unique<Table>( initial_table_size ) );
+			_shards[i].table.store( _shards[i].tables.back().get(), std::memory_order_relaxed );
+		}
+	}
+
+	intern_pool( const intern_pool& ) = delete;
+	intern_pool& operator=( const intern_pool& ) = delete;
+
+	~intern_pool()
+	{
+		for( std::size_t i = 0; i <= _shard_mask; ++i ) {
+			// all entries are contained in the newest table
+			const Table& table = *_shards[i].tables.back();
+			for( std::size_t s = 0; s <= table.mask; ++s ) {
+				delete table.slots[s].load( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	/**
+	 * Returns the handle for \p str. If the value isn't in the pool yet, the data is copied into a new buffer
+	 */
+	interned_str intern( std::string_view str )
+	{
+		return _intern( str, [str] { return im_zstr( str ); } );
+	}
+
+	/**
+	 * Same as intern(std::string_view), but if the value isn't in the pool yet and \p str is zero terminated,
+	 * the pool shares the buffer of \p str instead of copying the data
+	 */
+	interned_str intern( const im_str& str )
+	{
+		return _intern( str, [&str] { return str.create_zstr(); } );
+	}
+
+	// NOTE: Use only for string literals (arrays with static storage duration)!!!
+	template<std::size_t N>
+	interned_str intern( const char ( &str )[N] )
+	{
+		return intern( im_str( str ) );
+	}
+
+	// Returns the handle for \p str if the value is in the pool
+	std::optional<interned_str> find( std::string_view str ) const noexcept
+	{
+		if( str.empty() ) { return interned_str{}; }
+		const auto   hash  = _detail_im_str::hash_bytes( str );
+		const Entry* entry = _find_in( *_shard_for( hash ).table.load( std::memory_order_acquire ), hash, str );
+		if( entry == nullptr ) { return std::nullopt; }
+		return interned_str{ entry };
+	}
+
+	// Number of distinct values in the pool
+	std::size_t size() const noexcept
+	{
+		std::size_t ret = 0;
+		for( std::size_t i = 0; i <= _shard_mask; ++i ) {
+			ret += _shards[i].count.load( std::memory_order_relaxed );
+		}
+		return ret;
+	}
+
+	std::size_t shard_count() const noexcept { return _shard_mask + 1; }
+
+private:
+	static constexpr std::size_t max_shard_cnt      = 1024;
+	static constexpr std::size_t initial_table_size = 16;
+
+	struct Table {
+		explicit Table( std::size_t capacity )
+			: mask( capacity - 1 )
+			, slots( std::make_unique<std::atomic<const Entry*>[]>( capacity ) )
+		{
+		}
+
+		std::size_t                                  mask;
+		std::unique_ptr<std::atomic<const Entry*>[]> slots;
+	};
+
+	// aligned to a cache line, such that inserts into different shards don't interfere
+	struct alignas( 64 ) Shard {
+		std::atomic<const Table*> table{ nullptr };
+		std::atomic<std::size_t>  count{ 0 };
+		std::mutex                mutex;
+		// tables.back() is the current table. Older ones are kept alive, as lookups might still use them
+		std::vector<std::unique_ptr<Table>> tables;
+	};
+
+	const Shard& _shard_for( std::uint64_t hash ) const noexcept
+	{
+		// the table uses the low bits of the hash
+		return _shards[static_cast<std::size_t>( hash >> 48 ) & _shard_mask];
+	}
+	Shard& _shard_for( std::uint64_t hash ) noexcept
+	{
+		return _shards[static_cast<std::size_t>( hash >> 48 ) & _shard_mask];
+	}
+
+	static const Entry* _find_in( const Table& table, std::uint64_t hash, std::string_view str ) noexcept
+	{
+		for( std::size_t i = hash & table.mask;; i = ( i + 1 ) & table.mask ) {
+			const Entry* entry = table.slots[i].load( std::memory_order_acquire );
+			if( entry == nullptr || ( entry->hash == hash && entry->str == str ) ) { return entry; }
+		}
+	}
+
+	static void _place( Table& table, const Entry* entry ) noexcept
+	{
+		std::size_t i = entry->hash & table.mask;
+		while( table.slots[i].load( std::memory_order_relaxed ) != nullptr ) {
+			i = ( i + 1 ) & table.mask;
+		}
+		table.slots[i].store( entry, std::memory_order_release );
+	}
+
+	template<class MakeStr>
+	interned_str _intern( std::string_view str, MakeStr&& make_str )
+	{
+		if( str.empty() ) { return interned_str{}; }
+		const auto hash  = _detail_im_str::hash_bytes( str );
+		Shard&     shard = _shard_for( hash );
+
+		if( const Entry* entry = _find_in( *shard.table.load( std::memory_order_acquire ), hash, str ) ) {
+			return interned_str{ entry };
+		}
+
+		std::lock_guard<std::mutex> lock( shard.mutex );
+
+		// another thread might have inserted the value in the meantime
+		Table* table = shard.tables.back().get();
+		if( const Entry* entry = _find_in( *table, hash, str ) ) { return interned_str{ entry }; }
+
+		const std::size_t new_cnt = shard.count.load( std::memory_order_relaxed ) + 1;
+		if( new_cnt * 2 > table->mask + 1 ) { table = _grow( shard ); }
+
+		auto entry = std::make_unique<Entry>( Entry{ hash, make_str() } );
+		_place( *table, entry.get() );
+		shard.count.store( new_cnt, std::memory_order_relaxed );
+		return interned_str{ entry.release() };
+	}
+
+	// Must be called with the shard mutex locked
+	static Table* _grow( Shard& shard )
+	{
+		const Table& old_table = *shard.tables.back();
+
+		auto new_table = std::make_unique<Table>( 2 * ( old_table.mask + 1 ) );
+		for( std::size_t i = 0; i <= old_table.mask; ++i ) {
+			if( const Entry* entry = old_table.slots[i].load( std::memory_order_relaxed ) ) {
+				_place( *new_table, entry );
+			}
+		}
+
+		shard.tables.push_back( std::move( new_table ) );
+		shard.table.store( shard.tables.back().get(), std::memory_order_release );
+		return shard.tables.back().get();
+	}
+
+	std::size_t              _shard_mask = 0;
+	std::unique_ptr<Shard[]> _shards;
+};
+
+/**
+ * Pool that lives until the end of the program (handles from it can be used everywhere)
+ */
+inline intern_pool& global_intern_pool()
+{
+	static intern_pool pool;
+	return pool;
+}
+
+} // namespace mba
+
+template<>
+struct std::hash<mba::interned_str> {
+	std::size_t operator()( mba::interned_str str ) const noexcept { return static_cast<std::size_t>( str.hash() ); }
+};
+
+#endif // IM_STR_INTERN_POOL_HPP
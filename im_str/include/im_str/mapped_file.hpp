@@ -0,0 +1,145 @@
+#ifndef IM_STR_MAPPED_FILE_HPP
+#define IM_STR_MAPPED_FILE_HPP
+
+#include "im_str.hpp"
+
+#if IM_STR_USE_ALLOC && __has_include( <sys/mman.h> ) && __has_include( <unistd.h> )
+#define IM_STR_HAS_MAP_FILE 1
+#else
+#define IM_STR_HAS_MAP_FILE 0
+#endif
+
+#if IM_STR_HAS_MAP_FILE
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <filesystem>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mba {
+
+namespace _detail_im_str {
+
+/*
+ * Layout of a mapping created by map_file:
+ *
+ * | anonymous page (buffer_header at its end) | file content ... | zero filled rest of the last page(s) |
+ *
+ * The header directly precedes the string data, as in any other buffer, and the kernel zero fills
+ * everything behind the end of the file, so the string is zero terminated. When the last string
+ * is gone, deallocate gets called for the header and unmaps the whole range.
+ */
+class mapped_file_resource : public std::pmr::memory_resource {
+public:
+	static mapped_file_resource& instance()
+	{
+		// never destroyed, as strings with static storage duration might outlive it otherwise
+		static mapped_file_resource* const resource = new mapped_file_resource{};
+		return *resource;
+	}
+
+	static std::size_t page_size() noexcept
+	{
+		static const std::size_t size = static_cast<std::size_t>( ::sysconf( _SC_PAGESIZE ) );
+		return size;
+	}
+
+	// Size of the whole mapping for a file with \p file_size bytes
+	static std::size_t mapping_size( std::size_t file_size ) noexcept
+	{
+		const std::size_t page = page_size();
+		return page + ( file_size + 1 + page - 1 ) / page * page;
+	}
+
+private:
+	void* do_allocate( std::size_t, std::size_t ) override { throw std::bad_alloc{}; }
+
+	void do_deallocate( void* header, std::size_t bytes, std::size_t ) override
+	{
+		const std::size_t file_size = bytes - sizeof( buffer_header ) - 1;
+		char* const       start     = static_cast<char*>( header ) + sizeof( buffer_header ) - page_size();
+		::munmap( start, mapping_size( file_size ) );
+	}
+
+	bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override { return this == &other; }
+};
+
+// Closes the file descriptor at the end of the scope
+struct file_descriptor {
+	int fd;
+	~file_descriptor() { ::close( fd ); }
+};
+
+[[noreturn]] inline void throw_map_file_error( int error, const char* what )
+{
+	throw std::system_error( error, std::generic_category(), what );
+}
+
+} // namespace _detail_im_str
+
+/**
+ * @brief Maps the file at \p path into memory and returns its content as an im_zstr
+ *
+ * Nothing gets copied or read up front: the pages are loaded by the os when they are first accessed.
+ * All substrings (substr, split, tokenize, ...) share the mapping, which is released when the
+ * last of them is gone.
+ *
+ * The file must not be modified or truncated while it is mapped (the content of the strings would
+ * change or accessing them would crash). Files with more than INT_MAX bytes are not supported.
+ *
+ * Throws std::system_error, if the file can't be opened or mapped.
+ */
+inline im_zstr map_file( const std::filesystem::path& path )
+{
+	using _detail_im_str::mapped_file_resource;
+	using _detail_im_str::throw_map_file_error;
+
+	const _detail_im_str::file_descriptor file{ ::open( path.c_str(), O_RDONLY | O_CLOEXEC ) };
+	if( file.fd < 0 ) { throw_map_file_error( errno, "map_file: can't open file" ); }
+
+	struct ::stat info {};
+	if( ::fstat( file.fd, &info ) != 0 ) { throw_map_file_error( errno, "map_file: can't determine file size" ); }
+	if( info.st_size > INT_MAX ) { throw_map_file_error( EFBIG, "map_file: file is too big" ); }
+
+	const auto file_size = static_cast<std::size_t>( info.st_size );
+	if( file_size == 0 ) { return im_zstr{}; }
+
+	// reserve the whole range first, such that the header page and the zero page(s) behind the file are adjacent
+	const std::size_t total_size = mapped_file_resource::mapping_size( file_size );
+	void* const       start = ::mmap( nullptr, total_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if( start == MAP_FAILED ) { throw_map_file_error( errno, "map_file: can't reserve memory" ); }
+
+	char* const data = static_cast<char*>( start ) + mapped_file_resource::page_size();
+	if( ::mmap( data, file_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, file.fd, 0 ) == MAP_FAILED ) {
+		const int error = errno;
+		::munmap( start, total_size );
+		throw_map_file_error( error, "map_file: can't map file" );
+	}
+
+	using _detail_im_str::buffer_header;
+#if IM_STR_CACHE_HASH
+	auto* const header = ::new( data - sizeof( buffer_header ) )
+		buffer_header{ { 1 }, static_cast<int>( file_size ), &mapped_file_resource::instance(), { 0 } };
+#else
+	auto* const header = ::new( data - sizeof( buffer_header ) )
+		buffer_header{ { 1 }, static_cast<int>( file_size ), &mapped_file_resource::instance() };
+#endif
+
+	return _detail_im_str::zstr_from_handle<im_zstr>(
+		_detail_im_str::atomic_ref_cnt_buffer::adopt_buffer( *header ), data, file_size );
+}
+
+} // namespace mba
+
+#endif // IM_STR_HAS_MAP_FILE
+
+#endif // IM_STR_MAPPED_FILE_HPP
@@ -0,0 +1,210 @@
+#ifndef IM_STR_TOKENIZER_HPP
+#define IM_STR_TOKENIZER_HPP
+
+#include "detail/scan.hpp"
+#include "im_str.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace mba {
+
+/**
+ * A set of delimiter chars for tokenize
+ *
+ * Sets with up to 16 different chars are searched with the vectorized scan from
+ * detail/scan.hpp, larger ones char by char.
+ */
+class char_set {
+public:
+	constexpr char_set() noexcept = default;
+	constexpr char_set( char c ) noexcept { _add( c ); }
+	constexpr char_set( std::string_view chars ) noexcept
+	{
+		for( const char c : chars ) {
+			_add( c );
+		}
+	}
+	template<std::size_t N>
+	constexpr char_set( const char ( &chars )[N] ) noexcept
+		: char_set( std::string_view( chars ) )
+	{
+	}
+
+	static constexpr char_set whitespace() noexcept { return char_set( " \t\n\v\f\r" ); }
+
+	constexpr bool contains( char c ) const noexcept
+	{
+		const auto u = static_cast<unsigned char>( c );
+		return ( _bits[u / 64] >> ( u % 64 ) ) & 1u;
+	}
+
+	// number of distinct chars in the set
+	constexpr std::size_t size() const noexcept { return _cnt; }
+
+	// Position of the first char in \p str at or after \p pos that is in the set (npos if there is none)
+	std::size_t find_in( std::string_view str, std::size_t pos ) const noexcept
+	{
+		if( _cnt == 0 ) { return std::string_view::npos; }
+		if( _cnt <= _detail_im_str::max_find_first_of_chars ) {
+			return _detail_im_str::find_first_of_chars( str, pos, _chars, _cnt );
+		}
+		for( ; pos < str.size(); ++pos ) {
+			if( contains( str[pos] ) ) { return pos; }
+		}
+		return std::string_view::npos;
+	}
+
+private:
+	constexpr void _add( char c ) noexcept
+	{
+		if( contains( c ) ) { return; }
+		const auto u = static_cast<unsigned char>( c );
+		_bits[u / 64] |= std::uint64_t( 1 ) << ( u % 64 );
+		if( _cnt < _detail_im_str::max_find_first_of_chars ) { _chars[_cnt] = c; }
+		++_cnt;
+	}
+
+	std::uint64_t _bits[4]{};
+	char          _chars[_detail_im_str::max_find_first_of_chars]{};
+	std::size_t   _cnt = 0;
+};
+
+enum class empty_tokens { keep, skip };
+
+namespace _detail_im_str {
+template<class Pred>
+struct predicate_delims {
+	Pred pred;
+
+	std::size_t find_in( std::string_view str, std::size_t pos ) const
+	{
+		for( ; pos < str.size(); ++pos ) {
+			if( pred( str[pos] ) ) { return pos; }
+		}
+		return std::string_view::npos;
+	}
+};
+} // namespace _detail_im_str
+
+/**
+ * @brief Lazy range over the tokens of a string (see tokenize)
+ *
+ * The tokens are substrings that share the buffer of the original string and are only
+ * created when the iterator gets dereferenced, so iterating over the range doesn't allocate.
+ * The range holds its own copy of the string, so it may outlive the original.
+ */
+template<class Str, class Delims>
+class token_range {
+public:
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type        = Str;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = void;
+		using reference         = Str;
+
+		constexpr iterator() noexcept = default;
+
+		Str operator*() const { return _range->_str.substr( _begin, _end - _begin ); }
+
+		iterator& operator++()
+		{
+			_load( _end + 1 );
+			return *this;
+		}
+
+		iterator operator++( int )
+		{
+			auto tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		friend bool operator==( const iterator& l, const iterator& r ) noexcept { return l._begin == r._begin; }
+		friend bool operator!=( const iterator& l, const iterator& r ) noexcept { return l._begin != r._begin; }
+
+	private:
+		friend token_range;
+
+		explicit iterator( const token_range* range ) noexcept
+			: _range( range )
+		{
+		}
+
+		// Finds the (next non-empty) token that starts at pos or turns this into the end iterator
+		void _load( std::size_t pos )
+		{
+			const std::string_view str = _range->_str;
+			while( pos <= str.size() ) {
+				const auto delim_pos = _range->_delims.find_in( str, pos );
+				_begin               = pos;
+				_end                 = delim_pos == std::string_view::npos ? str.size() : delim_pos;
+				if( _end != _begin || _range->_empty == empty_tokens::keep ) { return; }
+				pos = _end + 1;
+			}
+			_begin = std::string_view::npos;
+		}
+
+		const token_range* _range = nullptr;
+		std::size_t        _begin = std::string_view::npos;
+		std::size_t        _end   = std::string_view::npos;
+	};
+
+	token_range( Str str, Delims delims, empty_tokens empty )
+		: _str( std::move( str ) )
+		, _delims( std::move( delims ) )
+		, _empty( empty )
+	{
+	}
+
+	iterator begin() const
+	{
+		iterator it( this );
+		// same as split_full: an empty string has no tokens
+		if( !_str.empty() ) { it._load( 0 ); }
+		return it;
+	}
+
+	iterator end() const noexcept { return iterator( this ); }
+
+private:
+	Str          _str;
+	Delims       _delims;
+	empty_tokens _empty;
+};
+
+/**
+ * @brief Splits \p str at each char that is contained in \p delims (dropping the delimiters)
+ *
+ * Example:
+ * for( im_str token : tokenize( line, ",;", empty_tokens::skip ) ) { ... }
+ * for( im_str word : tokenize( text, char_set::whitespace(), empty_tokens::skip ) ) { ... }
+ *
+ * Unlike split_full, the tokens are created one by one while iterating over the returned range.
+ */
+template<class RefCntPolicy>
+token_range<basic_im_str<RefCntPolicy>, char_set>
+tokenize( basic_im_str<RefCntPolicy> str, char_set delims, empty_tokens empty = empty_tokens::keep )
+{
+	return { std::move( str ), delims, empty };
+}
+
+/**
+ * Same as above, but a char is a delimiter, if \p is_delim( c ) returns true
+ */
+template<class RefCntPolicy, class Pred, class = std::enable_if_t<std::is_invocable_r_v<bool, const Pred&, char>>>
+token_range<basic_im_str<RefCntPolicy>, _detail_im_str::predicate_delims<Pred>>
+tokenize( basic_im_str<RefCntPolicy> str, Pred is_delim, empty_tokens empty = empty_tokens::keep )
+{
+	return { std::move( str ), _detail_im_str::predicate_delims<Pred>{ std::move( is_delim ) }, empty };
+}
+
+} // namespace mba
+
+#endif // IM_STR_TOKENIZER_HPP
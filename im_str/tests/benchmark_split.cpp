@@ -1,4 +1,5 @@
 #include <im_str/im_str.hpp>
+#include <im_str/tokenizer.hpp>
 
 #include <chrono>
 
@@ -39,13 +40,14 @@ std::vector<std::string> generate_random_strings( int cnt )
 	return ret;
 }
 
-im_str::DynArray_t flatten( std::vector<im_str::DynArray_t>& collections )
+template<class Str>
+typename Str::DynArray_t flatten( std::vector<typename Str::DynArray_t>& collections )
 {
 	const std::size_t total_size
 		= std::accumulate( collections.begin(), collections.end(), size_t( 0 ), []( size_t size, const auto& e ) {
 			  return size + e.size();
 		  } );
-	im_str::DynArray_t ret( total_size );
+	typename Str::DynArray_t ret( total_size );
 
 	auto out_it = ret.begin();
 
@@ -56,12 +58,12 @@ im_str::DynArray_t flatten( std::vector<im_str::DynArray_t>& collections )
 	return ret;
 }
 
-template<int Algo>
-im_str run( const im_str::DynArray_t& strings, const std::vector<char>& split_chars )
+template<class Str, int Algo>
+im_str run( const typename Str::DynArray_t& strings, const std::vector<char>& split_chars )
 {
 	auto cstrings = strings;
 	for( char split_char : split_chars ) {
-		std::vector<im_str::DynArray_t> tmp( cstrings.size() );
+		std::vector<typename Str::DynArray_t> tmp( cstrings.size() );
 
 		size_t i = 0;
 
@@ -73,15 +75,15 @@ im_str run( const im_str::DynArray_t& strings, const std::vector<char>& split_ch
 				// put other algorithm here
 			} */
 		}
-		cstrings = flatten( tmp );
+		cstrings = flatten<Str>( tmp );
 	}
 
 	return concat( cstrings );
 }
 
-template<int Algo, int Rep = 10, int It = 20>
+template<class Str, int Algo, int Rep = 10, int It = 20>
 // __declspec(noinline)
-void test_algo( const im_str::DynArray_t& s, const std::vector<char>& split_chars )
+void test_algo( const typename Str::DynArray_t& s, const std::vector<char>& split_chars )
 {
 	using namespace std::chrono;
 	std::vector<int> res( Rep );
@@ -91,7 +93,7 @@ void test_algo( const im_str::DynArray_t& s, const std::vector<char>& split_char
 
 		const auto start = steady_clock::now();
 		for( int i = 0; i < It; ++i ) {
-			run<Algo>( s, split_chars );
+			run<Str, Algo>( s, split_chars );
 		}
 		const auto end = steady_clock::now();
 
@@ -110,20 +112,121 @@ void test_algo( const im_str::DynArray_t& s, const std::vector<char>& split_char
 
 }
 
+/*
+ * Walks over all tokens with split_on_first. Apart from the ref count updates (two increments
+ * and two decrements per token) there is hardly any work, so this shows the cost of atomic
+ * ref counting (im_str) compared to plain ref counting (local_im_str)
+ */
+template<class Str, int Rep = 10, int It = 20>
+void test_tokenize( const typename Str::DynArray_t& strings, char split_char )
+{
+	using namespace std::chrono;
+
+	std::size_t total_size = 0;
+	double      total_ms   = 0;
+	for( int z = -1; z < Rep; ++z ) {
+		const auto start = steady_clock::now();
+		for( int i = 0; i < It; ++i ) {
+			for( const auto& s : strings ) {
+				Str rest = s;
+				while( !rest.empty() ) {
+					auto [token, tail] = rest.split_on_first( split_char );
+					total_size += token.size();
+					rest = std::move( tail );
+				}
+			}
+		}
+		const auto end = steady_clock::now();
+
+		// discard first repetition
+		if( z >= 0 ) { total_ms += duration<double, std::milli>( end - start ).count() / It; }
+	}
+	std::cout << "Avg: " << total_ms / Rep << "ms per iteration (checksum " << total_size << ")" << std::endl;
+}
+
+/*
+ * Splits a single multi-MB string. Here, the time is dominated by searching for the delimiters
+ */
+template<int Rep = 10, int It = 20>
+void test_large_input( const im_str& str )
+{
+	using namespace std::chrono;
+
+	const auto measure = [&]( const char* name, auto&& func ) {
+		std::size_t checksum = 0;
+		double      total_ms = 0;
+		for( int z = -1; z < Rep; ++z ) {
+			const auto start = steady_clock::now();
+			for( int i = 0; i < It; ++i ) {
+				checksum += func();
+			}
+			const auto end = steady_clock::now();
+
+			// discard first repetition
+			if( z >= 0 ) { total_ms += duration<double, std::milli>( end - start ).count() / It; }
+		}
+		std::cout << name << " Avg: " << total_ms / Rep << "ms per iteration (checksum " << checksum << ")"
+				  << std::endl;
+	};
+
+	measure( "split_full(';')       ", [&] { return str.split_full( ';' ).size(); } );
+	measure( "split_full('#')       ", [&] { return str.split_full( '#' ).size(); } );
+	measure( "tokenize(';')         ", [&] {
+		std::size_t cnt = 0;
+		for( const auto& token : tokenize( str, ';' ) ) {
+			cnt += token.size();
+		}
+		return cnt;
+	} );
+	measure( "tokenize(\" ,:;\", skip)", [&] {
+		std::size_t cnt = 0;
+		for( const auto& token : tokenize( str, " ,:;", empty_tokens::skip ) ) {
+			cnt += token.size();
+		}
+		return cnt;
+	} );
+	measure( "split_on_first('#')   ", [&] { return str.split_on_first( '#' ).first.size(); } );
+	measure( "split_on_last('#')    ", [&] { return str.split_on_last( '#' ).first.size(); } );
+}
+
+template<class Str>
+typename Str::DynArray_t to_dyn_array( const std::vector<std::string>& strings )
+{
+	typename Str::DynArray_t ret( strings.size() );
+
+	auto it = ret.begin();
+	for( const auto& s : strings ) {
+		*it = ( Str( s ) );
+		++it;
+	}
+	return ret;
+}
+
 int main()
 {
 	const auto my_strings = generate_random_strings( 200 );
 
 	const std::vector<char> split_chars{ ' ', ':', '/', ';', ',' };
-	im_str::DynArray_t      cstrings( my_strings.size() );
 
-	auto it = cstrings.begin();
-	for( const auto& s : my_strings ) {
-		*it = ( im_str( s ) );
-		++it;
+	// Same workloads with atomic ref counts (im_str) and plain ones (local_im_str)
+	std::cout << "im_str split_full:" << std::endl;
+	test_algo<im_str, 0>( to_dyn_array<im_str>( my_strings ), split_chars );
+	std::cout << "========================================================" << std::endl;
+	std::cout << "local_im_str split_full:" << std::endl;
+	test_algo<local_im_str, 0>( to_dyn_array<local_im_str>( my_strings ), split_chars );
+	std::cout << "========================================================" << std::endl;
+	std::cout << "im_str split_on_first:" << std::endl;
+	test_tokenize<im_str>( to_dyn_array<im_str>( my_strings ), ' ' );
+	std::cout << "========================================================" << std::endl;
+	std::cout << "local_im_str split_on_first:" << std::endl;
+	test_tokenize<local_im_str>( to_dyn_array<local_im_str>( my_strings ), ' ' );
+	std::cout << "========================================================" << std::endl;
+	std::string large_input;
+	for( int i = 0; i < 4; ++i ) {
+		large_input = concat( large_input, concat( my_strings ) );
 	}
-
-	test_algo<0>( cstrings, split_chars );
+	std::cout << "large input (" << large_input.size() / 1'000'000 << "MB):" << std::endl;
+	test_large_input( im_str( large_input ) );
 	std::cout << "========================================================" << std::endl;
 	// test_algo<2>( cstrings, split_chars );
 	// std::cout << "========================================================" << std::endl;
@@ -0,0 +1,78 @@
+// Counts allocations and ref count operations (see stats())
+#define IM_STR_DEBUG_HOOKS
+
+#include <im_str/im_str.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Typical workload for short strings: create module tags, parse short key/value pairs
+ * and copy them around. Build this once with and once without IM_STR_USE_SSO to compare.
+ */
+
+using namespace mba;
+
+namespace {
+
+std::vector<std::string> make_input( int cnt )
+{
+	const char* const modules[] = { "Nav", "Gps", "Imu", "Can", "Ctl", "Log" };
+
+	std::vector<std::string> ret;
+	for( int i = 0; i < cnt; ++i ) {
+		ret.push_back( modules[i % 6] + std::to_string( i % 10 ) + "=" + std::to_string( i % 997 ) );
+	}
+	return ret;
+}
+
+std::size_t run( const std::vector<std::string>& input )
+{
+	std::vector<im_zstr> tags;
+	std::vector<im_zstr> ids;
+
+	for( const auto& line : input ) {
+		const auto pos = line.find( '=' );
+		// e.g. "[Nav3]" and "42"
+		tags.push_back( concat( "[", std::string_view( line ).substr( 0, pos ), "]" ) );
+		ids.push_back( im_zstr( std::string_view( line ).substr( pos + 1 ) ) );
+	}
+
+	// copies, as they happen when passing strings around
+	std::vector<im_str> copies( tags.begin(), tags.end() );
+	copies.insert( copies.end(), ids.begin(), ids.end() );
+
+	std::size_t total = 0;
+	for( const auto& s : copies ) {
+		total += s.substr( 1 ).size();
+	}
+	return total;
+}
+
+} // namespace
+
+int main()
+{
+	using namespace std::chrono;
+	const auto input = make_input( 200'000 );
+
+	run( input ); // warm up
+	_detail_im_str::stats().reset();
+
+	const auto  start = steady_clock::now();
+	std::size_t total = 0;
+	for( int i = 0; i < 10; ++i ) {
+		total += run( input );
+	}
+	const auto end = steady_clock::now();
+
+	const auto& stats = _detail_im_str::stats();
+	std::cout << "sso " << ( IM_STR_USE_SSO ? "enabled" : "disabled" ) << " (capacity " << im_str::sso_capacity
+			  << ")\n"
+			  << "  time:            " << duration_cast<milliseconds>( end - start ).count() << "ms\n"
+			  << "  allocations:     " << stats.get_total_allocs() << "\n"
+			  << "  ref count ops:   " << stats.get_total_cnt_accesses() << "\n"
+			  << "  (checksum " << total << ")" << std::endl;
+}
@@ -0,0 +1,149 @@
+#include <im_str/arena.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <vector>
+
+#if IM_STR_USE_ALLOC
+#include <memory_resource>
+#endif
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+#if IM_STR_USE_ALLOC
+
+namespace {
+
+struct CountingResource : std::pmr::memory_resource {
+	int total_allocs   = 0;
+	int current_allocs = 0;
+
+	void* do_allocate( std::size_t bytes, std::size_t alignment ) override
+	{
+		++total_allocs;
+		++current_allocs;
+		return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+	}
+
+	void do_deallocate( void* ptr, std::size_t bytes, std::size_t alignment ) override
+	{
+		--current_allocs;
+		std::pmr::new_delete_resource()->deallocate( ptr, bytes, alignment );
+	}
+
+	bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override { return this == &other; }
+};
+
+} // namespace
+
+TEST_CASE( "arena_strings_share_chunk", "[im_str]" )
+{
+	CountingResource resource;
+
+	std::vector<im_zstr> strings;
+	{
+		im_str_arena arena( 1024, &resource );
+
+		for( int i = 0; i < 50; ++i ) {
+			strings.push_back( arena.make( "Value number " + std::to_string( i ) ) );
+		}
+		CHECK( arena.chunk_count() == 1 );
+		CHECK( resource.total_allocs == 1 );
+
+		for( int i = 0; i < 50; ++i ) {
+			REQUIRE( strings[i] == "Value number " + std::to_string( i ) );
+			REQUIRE( strings[i].c_str()[strings[i].size()] == '\0' );
+		}
+		// consecutive strings are stored back to back
+		CHECK( strings[1].data() == strings[0].data() + strings[0].size() + 1 );
+
+		// more strings than fit into one chunk
+		for( int i = 0; i < 200; ++i ) {
+			strings.push_back( arena.concat( "Key_", std::to_string( i ), "=", "some value" ) );
+		}
+		CHECK( arena.chunk_count() > 1 );
+		CHECK( resource.total_allocs == static_cast<int>( arena.chunk_count() ) );
+	}
+	// strings outlive the arena
+	CHECK( resource.current_allocs > 0 );
+	CHECK( strings[42] == "Value number 42" );
+	CHECK( strings[50 + 123] == "Key_123=some value" );
+
+	strings.clear();
+	CHECK( resource.current_allocs == 0 );
+}
+
+TEST_CASE( "arena_chunk_freed_with_last_string", "[im_str]" )
+{
+	CountingResource resource;
+
+	im_zstr survivor;
+	{
+		im_str_arena arena( im_str_arena::default_chunk_size, &resource );
+		for( int i = 0; i < 5000; ++i ) {
+			const auto s = arena.make( "temporary string " + std::to_string( i ) );
+			if( i == 1234 ) { survivor = s; }
+		}
+		arena.release_chunk();
+		CHECK( resource.current_allocs == 1 );
+
+		const auto after_release = arena.make( "Starts a new chunk" );
+		CHECK( after_release == "Starts a new chunk" );
+		CHECK( resource.current_allocs == 2 );
+	}
+	CHECK( resource.current_allocs == 1 );
+	CHECK( survivor == "temporary string 1234" );
+
+	survivor = im_zstr{};
+	CHECK( resource.current_allocs == 0 );
+}
+
+#endif // IM_STR_USE_ALLOC
+
+TEST_CASE( "arena_short_long_and_empty_strings", "[im_str]" )
+{
+	im_str_arena arena( 256 );
+
+	const auto empty = arena.make( "" );
+	CHECK( empty.empty() );
+	CHECK( *empty.c_str() == '\0' );
+
+	// short strings don't need the arena
+	const auto short_str = arena.make( "abc" );
+	CHECK( short_str == "abc" );
+	CHECK( arena.chunk_count() == 0 );
+
+	// strings that don't fit well into a chunk get their own buffer
+	const std::string long_str( 200, 'x' );
+	const auto        l = arena.make( long_str );
+	CHECK( l == long_str );
+	CHECK( arena.chunk_count() == 0 );
+
+	const auto medium = arena.make( "a medium sized string" );
+	CHECK( medium == "a medium sized string" );
+	CHECK( arena.chunk_count() == 1 );
+
+	// strings from the arena behave like any other im_zstr
+	const auto [first, second] = medium.split_on_first( ' ' );
+	CHECK( first == "a" );
+	CHECK( second == "medium sized string" );
+	im_str copy = second;
+	CHECK( copy.data() == medium.data() + 2 );
+}
+
+TEST_CASE( "local_arena", "[im_str]" )
+{
+	local_im_str_arena         arena;
+	std::vector<local_im_zstr> strings;
+	for( int i = 0; i < 100; ++i ) {
+		strings.push_back( arena.make( "local value " + std::to_string( i ) ) );
+	}
+	CHECK( strings[99] == "local value 99" );
+
+	// the chunk is shared, so this has to copy
+	const im_zstr shared = strings[10].to_shared();
+	CHECK( shared == "local value 10" );
+	CHECK( shared.data() != strings[10].data() );
+}
@@ -0,0 +1,123 @@
+#include <im_str/builder.hpp>
+
+#include "include_catch.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#if IM_STR_USE_ALLOC
+#include <memory_resource>
+#endif
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+TEST_CASE( "builder_append_and_freeze", "[im_str]" )
+{
+	im_str_builder b;
+	CHECK( b.empty() );
+	CHECK( b.freeze() == "" );
+
+	b.append( "Hello" ).append( ' ' ).append( "World"s ).append( 3, '!' );
+	CHECK( b.view() == "Hello World!!!" );
+	CHECK( b.size() == 14 );
+
+	const char* const data = b.view().data();
+
+	const im_zstr s = b.freeze();
+	CHECK( s == "Hello World!!!" );
+	CHECK( s.c_str()[s.size()] == '\0' );
+	// the string took over the buffer of the builder
+	CHECK( s.data() == data );
+
+	// the builder can be reused afterwards
+	CHECK( b.empty() );
+	CHECK( b.capacity() == 0 );
+	b.append( "Second string" );
+	CHECK( b.freeze() == "Second string" );
+	CHECK( s == "Hello World!!!" );
+
+	// short strings end up in the sso buffer and the builder keeps its buffer
+	b.append( "abc" );
+	const auto    capacity  = b.capacity();
+	const im_zstr short_str = b.freeze();
+	CHECK( short_str == "abc" );
+	CHECK( short_str.c_str()[3] == '\0' );
+	CHECK( b.empty() );
+	CHECK( b.capacity() == capacity );
+
+	// self move assignment leaves the builder unchanged
+	b.append( "def" );
+	auto& self = b;
+	b          = std::move( self );
+	CHECK( b.view() == "def" );
+}
+
+TEST_CASE( "builder_grows_geometrically", "[im_str]" )
+{
+	im_str_builder b;
+	std::string    expected;
+
+	int reallocations = 0;
+	for( int i = 0; i < 10000; ++i ) {
+		const auto old_capacity = b.capacity();
+		b.append( "x_" ).append_number( i );
+		expected += "x_" + std::to_string( i );
+		if( b.capacity() != old_capacity ) {
+			CHECK( b.capacity() >= 2 * old_capacity );
+			++reallocations;
+		}
+	}
+	CHECK( reallocations < 20 );
+	CHECK( b.view() == expected );
+	CHECK( b.freeze() == expected );
+
+	b.reserve( 1000 );
+	CHECK( b.capacity() == 1000 );
+	const char* const data = b.view().data();
+	b.append( 1000, 'y' );
+	CHECK( b.view().data() == data );
+	CHECK( b.freeze() == std::string( 1000, 'y' ) );
+}
+
+TEST_CASE( "builder_append_number", "[im_str]" )
+{
+	im_str_builder b;
+	b.append_number( 0 )
+		.append( ',' )
+		.append_number( -42 )
+		.append( ',' )
+		.append_number( std::numeric_limits<std::int64_t>::min() )
+		.append( ',' )
+		.append_number( std::numeric_limits<std::uint64_t>::max() )
+		.append( ',' )
+		.append_number( 'A' );
+	CHECK( b.freeze() == "0,-42,-9223372036854775808,18446744073709551615,65" );
+
+#if defined( __cpp_lib_to_chars )
+	b.append_number( 0.5 ).append( ',' ).append_number( -1.25f ).append( ',' ).append_number(
+		std::numeric_limits<double>::lowest() );
+	CHECK( b.freeze() == "0.5,-1.25,-1.7976931348623157e+308" );
+#endif
+}
+
+#if IM_STR_USE_ALLOC
+
+TEST_CASE( "builder_with_memory_resource", "[im_str]" )
+{
+	std::pmr::monotonic_buffer_resource resource;
+
+	local_im_str_builder b( &resource );
+	for( int i = 0; i < 100; ++i ) {
+		b.append( "Number " ).append_number( i ).append( '\n' );
+	}
+	local_im_zstr s = b.freeze();
+	CHECK( s.size() == 990 );
+	CHECK( s.substr( 0, 9 ) == "Number 0\n" );
+
+	const im_zstr shared = std::move( s ).to_shared();
+	CHECK( shared.size() == 990 );
+}
+
+#endif // IM_STR_USE_ALLOC
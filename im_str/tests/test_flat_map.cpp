@@ -0,0 +1,117 @@
+#include <im_str/flat_map.hpp>
+
+#include "include_catch.hpp"
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+TEST_CASE( "hash_is_content_based", "[im_str]" )
+{
+	const im_str lit   = "Hello World, this is a longer string";
+	const im_str heap  = im_str( "Hello World, this is a longer string"s );
+	const im_zstr cat  = concat( "Hello World, ", "this is a longer string" );
+	const im_str  sub  = im_str( "xxHello World, this is a longer stringxx"s ).substr( 2, lit.size() );
+	const auto    hash = _detail_im_str::hash_bytes( "Hello World, this is a longer string" );
+
+	CHECK( lit.hash() == hash );
+	CHECK( heap.hash() == hash );
+	CHECK( heap.hash() == hash ); // possibly cached
+	CHECK( cat.hash() == hash );
+	CHECK( sub.hash() == hash );
+	CHECK( local_im_str( lit ).hash() == hash );
+	CHECK( im_str( "abc"s ).hash() == _detail_im_str::hash_bytes( "abc" ) );
+
+	CHECK( std::hash<im_str>{}( heap ) == std::hash<im_str>{}( std::string_view( lit ) ) );
+	CHECK( std::hash<im_zstr>{}( cat ) == static_cast<std::size_t>( hash ) );
+
+	// all lengths take a different path through the hash function
+	std::unordered_set<std::uint64_t> hashes;
+	std::string                       str;
+	for( int i = 0; i < 200; ++i ) {
+		hashes.insert( _detail_im_str::hash_bytes( str ) );
+		str += static_cast<char>( 'a' + i % 26 );
+	}
+	CHECK( hashes.size() == 200 );
+	CHECK( _detail_im_str::hash_bytes( "ab" ) != _detail_im_str::hash_bytes( "ba" ) );
+}
+
+TEST_CASE( "flat_map_insert_and_find", "[im_str]" )
+{
+	im_str_flat_map<int> map;
+	CHECK( map.empty() );
+	CHECK( map.find( "missing" ) == map.end() );
+	CHECK( map.erase( "missing" ) == 0 );
+
+	CHECK( map.try_emplace( "navigation", 1 ).second );
+	CHECK( map.try_emplace( im_str( "planning"s ), 2 ).second );
+	CHECK( !map.try_emplace( "navigation", 3 ).second );
+	map["control"] = 4;
+	map.insert_or_assign( "planning", 5 );
+	CHECK( map.insert( { "perception", 6 } ).second );
+
+	CHECK( map.size() == 4 );
+	CHECK( map.at( "navigation" ) == 1 );
+	CHECK( map.at( "planning" ) == 5 );
+	CHECK( map.at( "control"s ) == 4 );
+	CHECK( map.contains( std::string_view( "perception" ) ) );
+	CHECK( !map.contains( "perceptio" ) );
+	CHECK( map.count( "control" ) == 1 );
+	CHECK_THROWS_AS( map.at( "missing" ), std::out_of_range );
+
+	// entries are stored in insertion order
+	auto it = map.begin();
+	CHECK( it++->first == "navigation" );
+	CHECK( it++->first == "planning" );
+	CHECK( it++->first == "control" );
+	CHECK( it++->first == "perception" );
+	CHECK( it == map.end() );
+
+	const auto& cmap = map;
+	CHECK( cmap.find( "control" )->second == 4 );
+}
+
+TEST_CASE( "flat_map_many_entries_and_erase", "[im_str]" )
+{
+	im_str_flat_map<std::string, local_im_str> map;
+	map.reserve( 100 );
+
+	for( int i = 0; i < 5000; ++i ) {
+		const auto key = "key_" + std::to_string( i );
+		REQUIRE( map.try_emplace( local_im_str( key ), key ).second );
+	}
+	REQUIRE( map.size() == 5000 );
+
+	// erase every third entry
+	for( int i = 0; i < 5000; i += 3 ) {
+		REQUIRE( map.erase( "key_" + std::to_string( i ) ) == 1 );
+	}
+	for( int i = 0; i < 5000; ++i ) {
+		const auto key = "key_" + std::to_string( i );
+		const auto it  = map.find( key );
+		if( i % 3 == 0 ) {
+			REQUIRE( it == map.end() );
+		} else {
+			REQUIRE( it != map.end() );
+			REQUIRE( it->first == key );
+			REQUIRE( it->second == key );
+		}
+	}
+	CHECK( map.size() == 5000 - 1667 );
+
+	for( int i = 0; i < 5000; i += 3 ) {
+		map[local_im_str( "key_" + std::to_string( i ) )] = "re-added";
+	}
+	CHECK( map.size() == 5000 );
+	CHECK( map.at( "key_3" ) == "re-added" );
+	CHECK( map.at( "key_4" ) == "key_4" );
+
+	map.clear();
+	CHECK( map.empty() );
+	CHECK( !map.contains( "key_4" ) );
+	map["key_4"] = "new";
+	CHECK( map.size() == 1 );
+}
@@ -0,0 +1,131 @@
+#include <im_str/intern_pool.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace ::mba;
+
+TEST_CASE( "intern_pool_deduplicates", "[im_str]" )
+{
+	intern_pool pool;
+
+	const std::string s1 = "Logger";
+	const std::string s2 = "Logger";
+
+	const auto h1 = pool.intern( s1 );
+	const auto h2 = pool.intern( s2 );
+	const auto h3 = pool.intern( std::string_view( "Network" ) );
+
+	CHECK( h1 == h2 );
+	CHECK( h1 != h3 );
+	CHECK( h1.str() == "Logger" );
+	CHECK( h3.str() == "Network" );
+	CHECK( h1.hash() == h2.hash() );
+	CHECK( std::hash<interned_str>{}( h1 ) == h1.hash() );
+
+	// one shared buffer per distinct value
+	CHECK( h1.str().data() == h2.str().data() );
+	CHECK( h1.str().data() != s1.data() );
+	CHECK( pool.size() == 2 );
+
+	CHECK( pool.find( "Logger" ) == h1 );
+	CHECK( !pool.find( "Unknown" ) );
+	CHECK( pool.size() == 2 );
+}
+
+TEST_CASE( "intern_pool_empty_string", "[im_str]" )
+{
+	intern_pool pool;
+
+	const auto h = pool.intern( std::string_view{} );
+	CHECK( h == interned_str{} );
+	CHECK( h == pool.intern( "" ) );
+	CHECK( h.empty() );
+	CHECK( h.str() == "" );
+	CHECK( *h.c_str() == '\0' );
+	CHECK( pool.find( "" ) == h );
+	CHECK( pool.size() == 0 );
+}
+
+TEST_CASE( "intern_pool_reuses_im_str_buffers", "[im_str]" )
+{
+	intern_pool pool;
+
+	const im_zstr owned = concat( "Topic", "/", "Position" );
+	const auto    h1    = pool.intern( owned );
+	CHECK( h1.str().data() == owned.data() );
+
+	// not zero terminated -> has to be copied
+	const im_str sub = owned.substr( 0, 5 );
+	const auto   h2  = pool.intern( sub );
+	CHECK( h2.str() == "Topic" );
+	CHECK( h2.str().data() != sub.data() );
+
+	// string literals are never copied
+	const auto h3 = pool.intern( "Literal" );
+	CHECK( h3.str().wrapps_a_string_litteral() );
+	CHECK( pool.intern( im_zstr( std::string_view( "Literal" ) ) ) == h3 );
+}
+
+TEST_CASE( "intern_pool_many_values", "[im_str]" )
+{
+	intern_pool pool( 4 );
+	CHECK( pool.shard_count() == 4 );
+
+	std::vector<interned_str> handles;
+	for( int i = 0; i < 10'000; ++i ) {
+		handles.push_back( pool.intern( std::to_string( i ) ) );
+	}
+	CHECK( pool.size() == 10'000 );
+
+	std::unordered_set<interned_str> unique( handles.begin(), handles.end() );
+	CHECK( unique.size() == 10'000 );
+
+	for( int i = 0; i < 10'000; ++i ) {
+		const auto h = pool.intern( std::to_string( i ) );
+		REQUIRE( h == handles[i] );
+		REQUIRE( h.str() == std::to_string( i ) );
+	}
+	CHECK( pool.size() == 10'000 );
+}
+
+TEST_CASE( "intern_pool_concurrent", "[im_str]" )
+{
+	intern_pool pool;
+
+	constexpr int thread_cnt = 4;
+	// prime, so every odd stride visits all values
+	constexpr int value_cnt = 2'003;
+	constexpr int strides[thread_cnt]{ 1, 3, 5, 7 };
+
+	// results[t][v]: what thread t got for value v
+	std::vector<std::vector<interned_str>> results( thread_cnt, std::vector<interned_str>( value_cnt ) );
+	std::vector<std::thread>               threads;
+	for( int t = 0; t < thread_cnt; ++t ) {
+		threads.emplace_back( [&, t] {
+			for( int i = 0; i < value_cnt; ++i ) {
+				// every thread interns all values, but in a different order
+				const int v   = ( i * strides[t] + t ) % value_cnt;
+				results[t][v] = pool.intern( "key_" + std::to_string( v ) );
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+
+	CHECK( pool.size() == value_cnt );
+	for( int v = 0; v < value_cnt; ++v ) {
+		REQUIRE( results[0][v].str() == "key_" + std::to_string( v ) );
+		REQUIRE( results[0][v] == *pool.find( "key_" + std::to_string( v ) ) );
+		for( int t = 1; t < thread_cnt; ++t ) {
+			// all threads got the same entry
+			REQUIRE( results[t][v] == results[0][v] );
+			REQUIRE( results[t][v].c_str() == results[0][v].c_str() );
+		}
+	}
+}
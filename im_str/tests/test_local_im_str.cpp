@@ -0,0 +1,129 @@
+#include <im_str/im_str.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+static_assert( !std::is_convertible_v<local_im_str, im_str> );
+static_assert( !std::is_convertible_v<im_str, local_im_str> );
+static_assert( sizeof( local_im_str ) == sizeof( im_str ) );
+
+TEST_CASE( "local_im_str_basic_operations", "[im_str]" )
+{
+	const local_im_str s( "Hello World, this is a local string"s );
+	CHECK( s == "Hello World, this is a local string" );
+	CHECK( s.is_zero_terminated() );
+
+	const local_im_str sub = s.substr( 6, 5 );
+	CHECK( sub == "World" );
+	CHECK( sub.data() == s.data() + 6 );
+
+	auto [first, rest] = s.split_on_first( ',' );
+	CHECK( first == "Hello World" );
+	CHECK( rest == " this is a local string" );
+
+	const auto words = s.split_full( ' ' );
+	REQUIRE( words.size() == 7 );
+	CHECK( words[0] == "Hello" );
+	CHECK( words[6] == "string" );
+	CHECK( words[6].data() == s.data() + s.size() - 6 );
+
+	const local_im_zstr z = s.substr( 13 ).create_zstr();
+	CHECK( z == "this is a local string" );
+	CHECK( z.c_str()[z.size()] == '\0' );
+
+	local_im_str lit = "literal";
+	CHECK( lit.wrapps_a_string_litteral() );
+	local_im_str copy = lit;
+	swap( lit, copy );
+	CHECK( lit == copy );
+}
+
+TEST_CASE( "local_im_str_to_shared_takes_over_unique_buffer", "[im_str]" )
+{
+	local_im_str s( "A string that is too long for the sso buffer"s );
+	const char*  data = s.data();
+
+	const im_str shared = std::move( s ).to_shared();
+	CHECK( shared.data() == data );
+	CHECK( shared == "A string that is too long for the sso buffer" );
+	CHECK( s.empty() );
+
+	// works for substrings as well
+	local_im_str s2 = local_im_str( "Yet another string that is too long"s ).substr( 4 );
+	const char*  data2 = s2.data();
+	const im_str shared2 = std::move( s2 ).to_shared();
+	CHECK( shared2.data() == data2 );
+	CHECK( shared2 == "another string that is too long" );
+
+	local_im_zstr z( "A zero terminated string that is too long"s );
+	const char*   zdata = z.data();
+	const im_zstr zshared = std::move( z ).to_shared();
+	CHECK( zshared.data() == zdata );
+	CHECK( zshared.c_str()[zshared.size()] == '\0' );
+}
+
+TEST_CASE( "local_im_str_to_shared_copies_shared_buffer", "[im_str]" )
+{
+	const local_im_str s( "A string that is too long for the sso buffer"s );
+	const local_im_str sub = s.substr( 2, 6 );
+
+	// other strings still use the buffer
+	const im_str shared1 = s.to_shared();
+	CHECK( shared1.data() != s.data() );
+	CHECK( shared1 == std::string_view( s ) );
+
+	local_im_str sub_copy = sub;
+	const im_str shared2  = std::move( sub_copy ).to_shared();
+	CHECK( shared2.data() != sub.data() );
+	CHECK( shared2 == "string" );
+	CHECK( shared2.is_zero_terminated() );
+
+	// literals and short strings don't have a buffer
+	const local_im_str lit = "literal";
+	CHECK( lit.to_shared().data() == lit.data() );
+	CHECK( lit.to_shared().wrapps_a_string_litteral() );
+	CHECK( local_im_str( "abc"s ).to_shared() == "abc" );
+	CHECK( local_im_str().to_shared().empty() );
+
+	// im_str::to_shared doesn't have to copy
+	const im_str shared3 = shared1.to_shared();
+	CHECK( shared3.data() == shared1.data() );
+}
+
+TEST_CASE( "local_im_str_hand_over_to_other_threads", "[im_str]" )
+{
+	std::vector<im_str> shared;
+	for( int i = 0; i < 100; ++i ) {
+		local_im_str s( "Entry number " + std::to_string( i ) + " with some padding" );
+		const auto   parts = s.split_full( ' ' );
+		CHECK( parts.size() == 6 );
+		shared.push_back( std::move( s ).to_shared() );
+	}
+
+	std::vector<std::thread> threads;
+	std::vector<std::size_t> sizes( 4 );
+	for( int t = 0; t < 4; ++t ) {
+		threads.emplace_back( [&, t] {
+			for( int r = 0; r < 100; ++r ) {
+				for( const auto& s : shared ) {
+					const im_str copy = s.substr( 6 );
+					sizes[t] += copy.size();
+				}
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	for( int t = 1; t < 4; ++t ) {
+		CHECK( sizes[t] == sizes[0] );
+	}
+	CHECK( shared[42] == "Entry number 42 with some padding" );
+}
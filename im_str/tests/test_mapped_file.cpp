@@ -0,0 +1,86 @@
+#include <im_str/mapped_file.hpp>
+
+#include "include_catch.hpp"
+
+#if IM_STR_HAS_MAP_FILE
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+namespace {
+
+std::filesystem::path write_temp_file( const std::string& name, const std::string& content )
+{
+	const auto    path = std::filesystem::temp_directory_path() / ( "im_str_test_" + name );
+	std::ofstream file( path, std::ios::binary | std::ios::trunc );
+	file << content;
+	return path;
+}
+
+} // namespace
+
+TEST_CASE( "map_file_content_and_substrings", "[im_str]" )
+{
+	std::string content;
+	for( int i = 0; i < 1000; ++i ) {
+		content += "line " + std::to_string( i ) + ";value=" + std::to_string( i * i ) + "\n";
+	}
+	const auto path = write_temp_file( "content.txt", content );
+
+	enable_ref_cnt_stats();
+	const auto before = this_thread_ref_cnt_stats();
+
+	im_str line_500;
+	{
+		const im_zstr file = map_file( path );
+		REQUIRE( file == content );
+		CHECK( file.c_str()[file.size()] == '\0' );
+		CHECK( this_thread_ref_cnt_stats().allocs - before.allocs == 1 );
+
+		const auto lines = file.split_full( '\n' );
+		REQUIRE( lines.size() == 1001 );
+		CHECK( lines[500] == "line 500;value=250000" );
+		// substrings refer to the mapping directly
+		CHECK( lines[500].data() == file.data() + content.find( "line 500;" ) );
+		line_500 = lines[500];
+	}
+	// the substring keeps the mapping alive
+	CHECK( this_thread_ref_cnt_stats().deallocs == before.deallocs );
+	CHECK( line_500.split_on_first( '=' ).second == "250000" );
+
+	line_500 = im_str{};
+	CHECK( this_thread_ref_cnt_stats().deallocs - before.deallocs == 1 );
+	enable_ref_cnt_stats( false );
+
+	std::filesystem::remove( path );
+}
+
+TEST_CASE( "map_file_sizes", "[im_str]" )
+{
+	const auto empty_path = write_temp_file( "empty.txt", "" );
+	CHECK( map_file( empty_path ).empty() );
+	std::filesystem::remove( empty_path );
+
+	// the zero terminator has to come from behind the mapped file, if its size is a multiple of the page size
+	for( const std::size_t size : { std::size_t( 1 ), std::size_t( 4096 ), std::size_t( 3 * 65536 ) } ) {
+		const std::string content( size, 'x' );
+		const auto        path = write_temp_file( "size.txt", content );
+		const im_zstr     file = map_file( path );
+		CHECK( file == content );
+		CHECK( file.c_str()[size] == '\0' );
+		std::filesystem::remove( path );
+	}
+}
+
+TEST_CASE( "map_file_errors", "[im_str]" )
+{
+	CHECK_THROWS_AS( map_file( std::filesystem::temp_directory_path() / "im_str_test_does_not_exist.txt" ),
+					 std::system_error );
+}
+
+#endif // IM_STR_HAS_MAP_FILE
@@ -0,0 +1,97 @@
+#include <im_str/im_str.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+#if IM_STR_USE_REF_CNT_STATS
+
+TEST_CASE( "ref_cnt_stats_count_only_while_enabled", "[im_str]" )
+{
+	const im_str s( "A string that doesn't fit into the sso buffer"s );
+
+	const auto before_disabled = this_thread_ref_cnt_stats();
+	{
+		im_str copy = s;
+		CHECK( copy == s );
+	}
+	CHECK( this_thread_ref_cnt_stats().incs == before_disabled.incs );
+
+	enable_ref_cnt_stats();
+	CHECK( ref_cnt_stats_enabled() );
+
+	const auto before = this_thread_ref_cnt_stats();
+	{
+		im_str copy1 = s;
+		im_str copy2 = copy1;
+		im_str moved = std::move( copy2 );
+		const im_str other( "Another string that needs a buffer"s );
+		CHECK( moved == s );
+	}
+	const auto diff = this_thread_ref_cnt_stats() - before;
+
+	enable_ref_cnt_stats( false );
+	CHECK( !ref_cnt_stats_enabled() );
+
+	CHECK( diff.incs == 2 );
+	CHECK( diff.decs == 3 );
+	CHECK( diff.allocs == 1 );
+	CHECK( diff.deallocs == 1 );
+}
+
+TEST_CASE( "ref_cnt_stats_aggregate_over_threads", "[im_str]" )
+{
+	const im_str s( "A string that is shared between threads"s );
+
+	enable_ref_cnt_stats();
+	const auto before = collect_ref_cnt_stats();
+
+	std::vector<std::thread> threads;
+	for( int t = 0; t < 4; ++t ) {
+		threads.emplace_back( [s] {
+			for( int i = 0; i < 1000; ++i ) {
+				im_str copy = s;
+				(void)copy;
+			}
+		} );
+	}
+	// counters of threads that are still running are included as well
+	const auto while_running = collect_ref_cnt_stats() - before;
+	for( auto& t : threads ) {
+		t.join();
+	}
+	const auto diff = collect_ref_cnt_stats() - before;
+
+	enable_ref_cnt_stats( false );
+
+	CHECK( while_running.incs <= diff.incs );
+	// the copies inside the threads (the lambda captures are copied on this thread)
+	CHECK( diff.incs >= 4 * 1000 );
+	CHECK( diff.decs >= 4 * 1000 );
+}
+
+TEST_CASE( "ref_cnt_stats_thread_local_strings_outlive_counters", "[im_str]" )
+{
+	const im_str s( "A string that is referenced by a thread_local"s );
+
+	std::thread t( [&s] {
+		// constructed before this thread's counters exist, so it is destroyed after them
+		thread_local im_str tl_copy = s;
+		(void)tl_copy;
+
+		enable_ref_cnt_stats();
+		im_str copy = s;
+		(void)copy;
+	} );
+	t.join();
+	enable_ref_cnt_stats( false );
+
+	CHECK( s == "A string that is referenced by a thread_local" );
+}
+
+#endif // IM_STR_USE_REF_CNT_STATS
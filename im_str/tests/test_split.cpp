@@ -2,7 +2,9 @@
 
 #include "include_catch.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <string>
 
 using namespace ::mba;
 
@@ -183,6 +185,49 @@ TEST_CASE( "Split full", "[im_str]" )
 	}
 }
 
+TEST_CASE( "Split_long_strings", "[im_str]" )
+{
+	// delimiters at all positions relative to the blocks used by the vectorized search
+	for( std::size_t size : { 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000 } ) {
+		for( std::size_t step : { 1, 3, 7, 16, 29, 200 } ) {
+			std::string base( size, 'x' );
+			for( std::size_t i = step / 2; i < size; i += step ) {
+				base[i] = ';';
+			}
+			const std::string_view ref( base );
+			const im_str           s( base );
+
+			REQUIRE( s.split_on_first( ';' ).first.size() == std::min( ref.find( ';' ), size ) );
+			REQUIRE( s.split_on_last( ';' ).first.size() == std::min( ref.rfind( ';' ), size ) );
+
+			const auto parts = s.split_full( ';' );
+			REQUIRE( parts.size() == 1 + static_cast<std::size_t>( std::count( base.begin(), base.end(), ';' ) ) );
+			std::size_t start = 0;
+			for( const auto& part : parts ) {
+				const auto end = std::min( ref.find( ';', start ), size );
+				REQUIRE( part == ref.substr( start, end - start ) );
+				start = end + 1;
+			}
+		}
+	}
+}
+
+TEST_CASE( "Split_full_leading_delimiter", "[im_str]" )
+{
+	const im_str s = ";ab;c";
+	const auto   before = s.split_full( ';', im_str::Split::Before );
+	REQUIRE( before.size() == 3 );
+	CHECK( before[0] == "" );
+	CHECK( before[1] == ";ab" );
+	CHECK( before[2] == ";c" );
+
+	const auto after = s.split_full( ';', im_str::Split::After );
+	REQUIRE( after.size() == 3 );
+	CHECK( after[0] == ";" );
+	CHECK( after[1] == "ab;" );
+	CHECK( after[2] == "c" );
+}
+
 TEST_CASE( "Split_on_nonexisting_char", "[im_str]" )
 {
 	im_str ref{ "Hello" };
@@ -0,0 +1,137 @@
+#include <im_str/im_str.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+namespace {
+
+bool is_stored_inline( const im_str& str )
+{
+	const auto* const obj_begin = reinterpret_cast<const char*>( &str );
+	return obj_begin <= str.data() && str.data() < obj_begin + sizeof( str );
+}
+
+} // namespace
+
+#if IM_STR_USE_SSO
+
+TEST_CASE( "sso_short_strings_are_stored_inline", "[im_str]" )
+{
+	static_assert( im_str::sso_capacity == sizeof( void* ) - 1 );
+
+	const std::string short_str( im_str::sso_capacity, 'x' );
+	const std::string long_str( im_str::sso_capacity + 1, 'x' );
+
+	const im_zstr s1( short_str );
+	CHECK( is_stored_inline( s1 ) );
+	CHECK( s1 == short_str );
+	CHECK( s1.is_zero_terminated() );
+	CHECK( s1.c_str()[s1.size()] == '\0' );
+	CHECK( !s1.wrapps_a_string_litteral() );
+
+	const im_zstr s2( long_str );
+	CHECK( !is_stored_inline( s2 ) );
+	CHECK( s2 == long_str );
+
+	// literals are still referenced directly
+	const im_str s3 = "[Nav]";
+	CHECK( !is_stored_inline( s3 ) );
+	CHECK( s3.wrapps_a_string_litteral() );
+
+	const im_zstr s4 = concat( "[", "Nav", "]" );
+	CHECK( is_stored_inline( s4 ) );
+	CHECK( s4 == "[Nav]" );
+	CHECK( s4.is_zero_terminated() );
+
+	CHECK( !is_stored_inline( concat( "[", "Navigation", "]" ) ) );
+	CHECK( is_stored_inline( concat( std::vector<std::string>{ "a", "b", "c" } ) ) );
+	CHECK( is_stored_inline( im_str( "Hello World" ).substr( 0, 5 ).unshare() ) );
+}
+
+TEST_CASE( "sso_copy_and_move", "[im_str]" )
+{
+	im_str s1( "Nav"s );
+	REQUIRE( is_stored_inline( s1 ) );
+
+	im_str s2 = s1;
+	CHECK( is_stored_inline( s2 ) );
+	CHECK( s2.data() != s1.data() );
+	CHECK( s2 == "Nav" );
+
+	im_str s3 = std::move( s1 );
+	CHECK( is_stored_inline( s3 ) );
+	CHECK( s3 == "Nav" );
+	CHECK( s1.empty() );
+
+	// assignment between inline, literal and heap strings
+	im_str heap( "A longer string"s );
+	im_str lit = "literal";
+
+	s1 = heap;
+	CHECK( s1 == "A longer string" );
+	CHECK( !is_stored_inline( s1 ) );
+	s1 = s2;
+	CHECK( s1 == "Nav" );
+	CHECK( is_stored_inline( s1 ) );
+	s1 = lit;
+	CHECK( s1 == "literal" );
+	s1 = std::move( s3 );
+	CHECK( s1 == "Nav" );
+	CHECK( is_stored_inline( s1 ) );
+	CHECK( s3.empty() );
+	s1 = std::move( heap );
+	CHECK( s1 == "A longer string" );
+	CHECK( heap.empty() );
+
+	im_zstr z1( "abc"s );
+	im_zstr z2( "A longer string"s );
+	swap( z1, z2 );
+	CHECK( z1 == "A longer string" );
+	CHECK( z2 == "abc" );
+	CHECK( is_stored_inline( z2 ) );
+	CHECK( z2.c_str()[3] == '\0' );
+
+	std::vector<im_str> v;
+	for( int i = 0; i < 100; ++i ) {
+		v.push_back( im_str( std::to_string( i ) ) );
+	}
+	for( int i = 0; i < 100; ++i ) {
+		REQUIRE( v[i] == std::to_string( i ) );
+	}
+}
+
+TEST_CASE( "sso_substr_and_split", "[im_str]" )
+{
+	const im_str s( "a;bc;d"s );
+	REQUIRE( is_stored_inline( s ) );
+
+	const auto sub = s.substr( 2, 2 );
+	CHECK( sub == "bc" );
+	CHECK( is_stored_inline( sub ) );
+	CHECK( sub.is_zero_terminated() );
+
+	auto [first, rest] = s.split_on_first( ';' );
+	CHECK( first == "a" );
+	CHECK( rest == "bc;d" );
+
+	const auto parts = s.split_full( ';' );
+	REQUIRE( parts.size() == 3 );
+	CHECK( parts[0] == "a" );
+	CHECK( parts[1] == "bc" );
+	CHECK( parts[2] == "d" );
+	for( const auto& p : parts ) {
+		CHECK( is_stored_inline( p ) );
+	}
+
+	// moving the source doesn't affect the results
+	im_str moved = std::move( sub ).substr( 1 );
+	CHECK( moved == "c" );
+}
+
+#endif // IM_STR_USE_SSO
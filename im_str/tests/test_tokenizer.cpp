@@ -0,0 +1,129 @@
+#include <im_str/tokenizer.hpp>
+
+#include "include_catch.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace ::mba;
+using namespace std::string_literals;
+
+namespace {
+
+template<class Range>
+std::vector<std::string> to_strings( const Range& range )
+{
+	std::vector<std::string> ret;
+	for( const auto& token : range ) {
+		ret.emplace_back( token );
+	}
+	return ret;
+}
+
+// reference implementation
+std::vector<std::string> split_ref( std::string_view str, char_set delims, empty_tokens empty )
+{
+	std::vector<std::string> ret;
+	if( str.empty() ) { return ret; }
+	std::string current;
+	for( const char c : str ) {
+		if( delims.contains( c ) ) {
+			if( !current.empty() || empty == empty_tokens::keep ) { ret.push_back( current ); }
+			current.clear();
+		} else {
+			current.push_back( c );
+		}
+	}
+	if( !current.empty() || empty == empty_tokens::keep ) { ret.push_back( current ); }
+	return ret;
+}
+
+} // namespace
+
+TEST_CASE( "tokenize_single_delimiter", "[im_str]" )
+{
+	const im_str s( "a,bc,,def,"s );
+
+	CHECK( to_strings( tokenize( s, ',' ) ) == std::vector<std::string>{ "a", "bc", "", "def", "" } );
+	CHECK( to_strings( tokenize( s, ',', empty_tokens::skip ) ) == std::vector<std::string>{ "a", "bc", "def" } );
+
+	// same result as split_full
+	const auto parts = s.split_full( ',' );
+	CHECK( std::equal( parts.begin(), parts.end(), tokenize( s, ',' ).begin(), tokenize( s, ',' ).end() ) );
+
+	CHECK( to_strings( tokenize( im_str(), ',' ) ).empty() );
+	CHECK( to_strings( tokenize( im_str( ",,,"s ), ',', empty_tokens::skip ) ).empty() );
+	CHECK( to_strings( tokenize( im_str( "abc"s ), ',' ) ) == std::vector<std::string>{ "abc" } );
+}
+
+TEST_CASE( "tokenize_delimiter_sets", "[im_str]" )
+{
+	const im_str line( "  key = value;\tother:  42 \n"s );
+
+	CHECK( to_strings( tokenize( line, char_set::whitespace(), empty_tokens::skip ) )
+		   == std::vector<std::string>{ "key", "=", "value;", "other:", "42" } );
+	CHECK( to_strings( tokenize( line, " =;:\t\n", empty_tokens::skip ) )
+		   == std::vector<std::string>{ "key", "value", "other", "42" } );
+
+	const im_str csv( "1,2;3"s );
+	CHECK( to_strings( tokenize( csv, ",;" ) ) == std::vector<std::string>{ "1", "2", "3" } );
+
+	// more chars than the vectorized scan can handle at once
+	const char_set many( "abcdefghijklmnopqrstuvwxyz" );
+	CHECK( many.size() == 26 );
+	CHECK( to_strings( tokenize( im_str( "1a2bb3z4"s ), many, empty_tokens::skip ) )
+		   == std::vector<std::string>{ "1", "2", "3", "4" } );
+}
+
+TEST_CASE( "tokenize_predicate", "[im_str]" )
+{
+	const im_str s( "12ab345c6"s );
+	const auto   is_alpha = []( char c ) { return 'a' <= c && c <= 'z'; };
+
+	CHECK( to_strings( tokenize( s, is_alpha, empty_tokens::skip ) ) == std::vector<std::string>{ "12", "345", "6" } );
+	CHECK( to_strings( tokenize( s, is_alpha ) ) == std::vector<std::string>{ "12", "", "345", "6" } );
+}
+
+TEST_CASE( "tokenize_shares_buffer", "[im_str]" )
+{
+	const im_zstr s( "This line is long enough to be stored in a separate buffer"s );
+
+	auto range = tokenize( s, ' ' );
+	CHECK( std::distance( range.begin(), range.end() ) == 12 );
+	for( const im_str token : range ) {
+		CHECK( s.data() <= token.data() );
+		CHECK( token.data() + token.size() <= s.data() + s.size() );
+	}
+
+	// the range keeps the string alive
+	auto tmp_range = tokenize( im_str( "Another long string, that only the range refers to"s ), ',' );
+	CHECK( to_strings( tmp_range ) == std::vector<std::string>{ "Another long string", " that only the range refers to" } );
+
+	local_im_str local( "local,strings,work,too"s );
+	std::vector<local_im_str> tokens;
+	for( auto token : tokenize( local, ',' ) ) {
+		tokens.push_back( token );
+	}
+	REQUIRE( tokens.size() == 4 );
+	CHECK( tokens[2] == "work" );
+	CHECK( tokens[2].data() == local.data() + 14 );
+}
+
+TEST_CASE( "tokenize_long_strings", "[im_str]" )
+{
+	const char_set delims( ",; " );
+	for( std::size_t size : { 1, 15, 16, 17, 31, 32, 33, 64, 65, 1000 } ) {
+		for( std::size_t step : { 1, 2, 5, 16, 33 } ) {
+			std::string base( size, 'x' );
+			for( std::size_t i = step / 2, k = 0; i < size; i += step, ++k ) {
+				base[i] = ",; "[k % 3];
+			}
+			const im_str s( base );
+			REQUIRE( to_strings( tokenize( s, delims ) ) == split_ref( base, delims, empty_tokens::keep ) );
+			REQUIRE( to_strings( tokenize( s, delims, empty_tokens::skip ) )
+					 == split_ref( base, delims, empty_tokens::skip ) );
+		}
+	}
+}
@@ -16,14 +16,12 @@
 
 #include "types.h"
 
+#include <im_str/im_str_fwd.hpp>
+
 #include <atomic>
 #include <mutex>
 #include <string_view>
 
-namespace mba {
-class im_zstr;
-}
-
 namespace mart {
 namespace log {
 /**
@@ -23,6 +23,7 @@
 #include <mart-common/ArrayView.h>
 
 /* Standard Library Includes */
+#include <array>
 #include <cerrno>
 #include <chrono>
 #include <cstring>
@@ -49,6 +50,26 @@ inline byte_range to_byte_range( const std::string_view memory )
 	return byte_range{reinterpret_cast<unsigned char const*>( memory.data() ), memory.size()};
 }
 
+inline bool to_byte_ranges( mart::ArrayView<const mart::ConstMemoryView>            memory,
+							std::array<byte_range, port_layer::max_io_buffer_cnt>& out ) noexcept
+{
+	if( memory.size() > out.size() ) { return false; }
+	for( std::size_t i = 0; i < memory.size(); ++i ) {
+		out[i] = to_byte_range( memory[i] );
+	}
+	return true;
+}
+
+inline bool to_byte_ranges( mart::ArrayView<const mart::MemoryView>                    memory,
+							std::array<byte_range_mut, port_layer::max_io_buffer_cnt>& out ) noexcept
+{
+	if( memory.size() > out.size() ) { return false; }
+	for( std::size_t i = 0; i < memory.size(); ++i ) {
+		out[i] = to_mutable_byte_range( memory[i] );
+	}
+	return true;
+}
+
 } // namespace _detail_socket_
 
 inline std::string_view to_text_rep( ErrorCode code )
@@ -89,6 +110,8 @@ public:
 	RaiiSocket( RaiiSocket&& other ) noexcept
 		: _handle{std::exchange( other._handle, port_layer::handle_t::Invalid )}
 		, _is_blocking{std::exchange( other._is_blocking, false )}
+		, _tx_timeout{std::exchange( other._tx_timeout, invalid_timeout_v )}
+		, _rx_timeout{std::exchange( other._rx_timeout, invalid_timeout_v )}
 	{
 	}
 
@@ -97,6 +120,8 @@ public:
 		close();
 		_handle      = std::exchange( other._handle, port_layer::handle_t::Invalid );
 		_is_blocking = std::exchange( other._is_blocking, true );
+		_tx_timeout  = std::exchange( other._tx_timeout, invalid_timeout_v );
+		_rx_timeout  = std::exchange( other._rx_timeout, invalid_timeout_v );
 		return *this;
 	}
 
@@ -107,6 +132,8 @@ public:
 	{
 		ErrorCode ret = port_layer::close_socket( _handle );
 		_handle       = port_layer::handle_t::Invalid;
+		_tx_timeout   = invalid_timeout_v;
+		_rx_timeout   = invalid_timeout_v;
 		return ret;
 	}
 
@@ -157,6 +184,67 @@ public:
 		}
 	}
 
+	/* ###### scatter / gather ############### */
+	// All buffers are sent / filled in a single system call (at most port_layer::max_io_buffer_cnt buffers)
+
+	ReturnValue<txrx_size_t> send( mart::ArrayView<const mart::ConstMemoryView> data, int flags ) noexcept
+	{
+		std::array<byte_range, port_layer::max_io_buffer_cnt> buffers;
+		if( !_detail_socket_::to_byte_ranges( data, buffers ) ) {
+			return ReturnValue<txrx_size_t>{ErrorCodeValues::InvalidArgument};
+		}
+		return port_layer::sendmsg( _handle, buffers.data(), data.size(), flags );
+	}
+
+	ReturnValue<txrx_size_t>
+	sendto( mart::ArrayView<const mart::ConstMemoryView> data, int flags, const Sockaddr& addr ) noexcept
+	{
+		std::array<byte_range, port_layer::max_io_buffer_cnt> buffers;
+		if( !_detail_socket_::to_byte_ranges( data, buffers ) ) {
+			return ReturnValue<txrx_size_t>{ErrorCodeValues::InvalidArgument};
+		}
+		return port_layer::sendmsg( _handle, buffers.data(), data.size(), flags, addr );
+	}
+
+	ReturnValue<txrx_size_t> recv( mart::ArrayView<const mart::MemoryView> buffers, int flags ) noexcept
+	{
+		std::array<byte_range_mut, port_layer::max_io_buffer_cnt> ranges;
+		if( !_detail_socket_::to_byte_ranges( buffers, ranges ) ) {
+			return ReturnValue<txrx_size_t>{ErrorCodeValues::InvalidArgument};
+		}
+		return port_layer::recvmsg( _handle, ranges.data(), buffers.size(), flags );
+	}
+
+	ReturnValue<txrx_size_t>
+	recvfrom( mart::ArrayView<const mart::MemoryView> buffers, int flags, Sockaddr& src_addr ) noexcept
+	{
+		std::array<byte_range_mut, port_layer::max_io_buffer_cnt> ranges;
+		if( !_detail_socket_::to_byte_ranges( buffers, ranges ) ) {
+			return ReturnValue<txrx_size_t>{ErrorCodeValues::InvalidArgument};
+		}
+		return port_layer::recvmsg( _handle, ranges.data(), buffers.size(), flags, src_addr );
+	}
+
+	ReturnValue<txrx_size_t> recvfrom( mart::ArrayView<const mart::MemoryView> buffers,
+									   int                                     flags,
+									   Sockaddr&                               src_addr,
+									   port_layer::RecvMsgInfo&                info ) noexcept
+	{
+		std::array<byte_range_mut, port_layer::max_io_buffer_cnt> ranges;
+		if( !_detail_socket_::to_byte_ranges( buffers, ranges ) ) {
+			return ReturnValue<txrx_size_t>{ErrorCodeValues::InvalidArgument};
+		}
+		return port_layer::recvmsg( _handle, ranges.data(), buffers.size(), flags, src_addr, info );
+	}
+
+	/* ###### zero copy file transmission ############### */
+
+	ReturnValue<txrx_size_t>
+	send_file( port_layer::file_handle_t file, std::uint64_t offset, std::size_t count ) noexcept
+	{
+		return port_layer::send_file( _handle, file, offset, count );
+	}
+
 	/* ###### connection related ############### */
 
 	auto bind( const Sockaddr& addr ) noexcept { return port_layer::bind( _handle, addr ); }
@@ -185,12 +273,28 @@ public:
 		}
 	}
 
+	// Doesn't need additional syscalls to set / query the blocking mode of the accepted socket (see port_layer::accept4)
+	// If no socket could be accepted, the returned socket is invalid and error tells why
+	RaiiSocket accept4( Sockaddr& remote_addr, bool non_blocking, ErrorCode& error ) noexcept
+	{
+		auto res = port_layer::accept4( _handle, remote_addr, non_blocking );
+		error    = res.error_code();
+		if( res ) {
+			return RaiiSocket( res.value(), !non_blocking );
+		} else {
+			return RaiiSocket{};
+		}
+	}
+
 	auto getsockname( Sockaddr& src_addr ) const noexcept { return port_layer::getsockname( _handle, src_addr );	}
 
 	/* ###### Configuration ############### */
 	template<class T>
 	ErrorCode setsockopt( SocketOptionLevel level, SocketOption optname, const T& option_data ) noexcept
 	{
+		// the timeouts might be changed behind the back of the cache
+		if( optname == SocketOption::so_sndtimeo ) { _tx_timeout = invalid_timeout_v; }
+		if( optname == SocketOption::so_rcvtimeo ) { _rx_timeout = invalid_timeout_v; }
 		auto opmem = byte_range_from_pod( option_data );
 		return port_layer::setsockopt( _handle, level, optname, opmem );
 	}
@@ -198,7 +302,8 @@ public:
 	template<class T>
 	ErrorCode getsockopt( SocketOptionLevel level, SocketOption optname, T& option_data ) const noexcept
 	{
-		return port_layer::getsockopt( _handle, level, optname, byte_range_from_pod( option_data ) );
+		auto opmem = byte_range_from_pod( option_data );
+		return port_layer::getsockopt( _handle, level, optname, opmem );
 	}
 
 	ErrorCode set_blocking( bool should_block ) noexcept
@@ -215,14 +320,16 @@ public:
 
 	static constexpr std::chrono::microseconds invalid_timeout_v = std::chrono::microseconds( -1 );
 
+	// Like the blocking mode, the last timeouts set through these functions are cached and setting the same
+	// value again doesn't need a syscall
 	bool set_tx_timeout( std::chrono::microseconds timeout ) noexcept
 	{
-		return port_layer::set_timeout( _handle, Direction::Tx, timeout ).success();
+		return _set_timeout_cached( Direction::Tx, _tx_timeout, timeout );
 	}
 
 	bool set_rx_timeout( std::chrono::microseconds timeout ) noexcept
 	{
-		return port_layer::set_timeout( _handle, Direction::Rx, timeout ).success();
+		return _set_timeout_cached( Direction::Rx, _rx_timeout, timeout );
 	}
 	std::chrono::microseconds get_tx_timeout() const noexcept
 	{
@@ -237,6 +344,13 @@ public:
 	port_layer::handle_t get() const { return _handle; }
 
 private:
+	// takes ownership of a handle whose blocking mode is already known
+	RaiiSocket( port_layer::handle_t handle, bool is_blocking ) noexcept
+		: _handle( handle )
+		, _is_blocking( is_blocking )
+	{
+	}
+
 	ErrorCode _open( Domain domain, TransportType type ) noexcept
 	{
 		auto res = port_layer::socket( domain, type );
@@ -254,8 +368,18 @@ private:
 		return res;
 	}
 
-	port_layer::handle_t _handle      = port_layer::handle_t::Invalid;
-	bool                 _is_blocking = true;
+	bool _set_timeout_cached( Direction direction, std::chrono::microseconds& cache, std::chrono::microseconds timeout ) noexcept
+	{
+		if( cache == timeout && timeout != invalid_timeout_v ) { return true; }
+		const bool success = port_layer::set_timeout( _handle, direction, timeout ).success();
+		cache              = success ? timeout : invalid_timeout_v;
+		return success;
+	}
+
+	port_layer::handle_t      _handle      = port_layer::handle_t::Invalid;
+	bool                      _is_blocking = true;
+	std::chrono::microseconds _tx_timeout  = invalid_timeout_v; // invalid_timeout_v: unknown
+	std::chrono::microseconds _rx_timeout  = invalid_timeout_v;
 };
 
 } // namespace socks
@@ -195,9 +195,29 @@ enum class TransportType {
 
 enum class Protocol { Default, Udp, Tcp };
 
-enum class SocketOptionLevel { Socket };
+enum class SocketOptionLevel { Socket, Ip, Ipv6, Tcp, Udp };
 
-enum class SocketOption { so_rcvtimeo, so_sndtimeo, so_reuseaddr };
+/* NOTE: Not all options are supported on all platforms. If the platform doesn't know an option,
+ * port_layer::setsockopt/getsockopt fail with the error provided by the native api
+ */
+enum class SocketOption {
+	so_rcvtimeo,
+	so_sndtimeo,
+	so_reuseaddr,
+	so_reuseport, // not on windows
+	so_rcvbuf,
+	so_sndbuf,
+	so_busy_poll,   // linux only
+	so_priority,    // linux only
+	so_timestampns, // linux only
+	ip_tos,
+	ipv6_v6only,
+	ipv6_tclass,
+	tcp_nodelay,
+	tcp_quickack, // linux only
+	udp_segment,  // generic segmentation offload: size of the datagrams a send buffer gets split into (linux only)
+	udp_gro,      // generic receive offload: allow the kernel to coalesce datagrams (linux only)
+};
 
 enum class Direction { Tx, Rx };
 
@@ -240,8 +260,19 @@ enum class ErrorCodeValues : int {
 	TryAgain        = EAGAIN,
 	InvalidArgument = EINVAL,
 	WouldBlock      = EWOULDBLOCK,
-	Timeout         = 10060,     // Windows
-	WsaeConnReset   = 0x00002746 // Windows WSAECONNRESET ECONNRESET
+	Timeout         = 10060,      // Windows
+	WsaeConnReset   = 0x00002746, // Windows WSAECONNRESET ECONNRESET
+#ifdef MBA_UTILS_USE_WINSOCKS
+	InProgress        = 10035,   // WSAEWOULDBLOCK: what connect reports on non-blocking sockets
+	TimedOut          = Timeout, // WSAETIMEDOUT
+	AlreadyInProgress = 10037,   // WSAEALREADY
+	IsConnected       = 10056,   // WSAEISCONN
+#else
+	InProgress        = EINPROGRESS, // connect on a non-blocking socket
+	TimedOut          = ETIMEDOUT,
+	AlreadyInProgress = EALREADY, // connect while a previous one is still pending
+	IsConnected       = EISCONN,
+#endif
 };
 
 struct ErrorCode {
@@ -0,0 +1,171 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_CAPTURE_HPP
+#define LIB_MART_COMMON_GUARD_NW_CAPTURE_HPP
+/**
+ * capture.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Recording udp traffic into memory mapped capture files and replaying it
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "udp.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+/*
+ * Capture file layout (all fields in host byte order):
+ *
+ *   [header: 64 bytes][index: max_datagrams x uint64 record offsets][records ...]
+ *
+ * Each record is a 24 byte record header (timestamp, source, size) followed by the payload, padded to 8 bytes.
+ * The header is updated after every record, so a file whose writer crashed is still readable up to the last
+ * complete record.
+ */
+
+struct CaptureConfig {
+	// Size of the file that gets allocated (and mapped) up front. Capturing stops when it is full
+	std::uint64_t capacity_bytes = std::uint64_t{256} * 1024 * 1024;
+	// Number of entries in the index - capturing stops after that many datagrams
+	std::uint64_t max_datagrams = 1024 * 1024;
+	// Larger datagrams get truncated when captured from a socket
+	std::size_t max_datagram_size = 65507;
+	// Touch all pages of the file up front, so capturing doesn't incur page faults (linux only)
+	bool prefault = false;
+};
+
+struct CapturedDatagram {
+	std::chrono::system_clock::time_point timestamp;
+	endpoint                              source;
+	mart::ConstMemoryView                 data;
+	// false if the timestamp was taken in user space, because kernel timestamps weren't enabled
+	bool kernel_timestamp = false;
+};
+
+namespace detail {
+class MappedFile;
+}
+
+/*
+ * Writes datagrams into a preallocated, memory mapped capture file. Not thread safe.
+ */
+class CaptureWriter {
+public:
+	// creates (or truncates) the file. Throws generic_nw_error if the file can't be created
+	explicit CaptureWriter( std::string_view file_name, const CaptureConfig& config = {} );
+	CaptureWriter( CaptureWriter&& other ) noexcept;
+	CaptureWriter& operator=( CaptureWriter&& other ) noexcept;
+	~CaptureWriter();
+
+	/*
+	 * Receives one datagram from the socket directly into the file (respecting the blocking mode and timeout of
+	 * the socket). Enable rx timestamping on the socket to record the kernel timestamps, otherwise the time of
+	 * the receive call is recorded.
+	 * Returns the error of the receive call or ENOSPC if the file is full.
+	 */
+	socks::ErrorCode try_capture( Socket& socket ) noexcept;
+	// Throws generic_nw_error on any error other than timeouts (in which case false is returned)
+	bool capture( Socket& socket );
+
+	// stores a datagram received elsewhere - returns false if the file is full
+	bool try_append( const CapturedDatagram& datagram ) noexcept;
+
+	std::uint64_t size() const noexcept { return _record_cnt; }
+	std::uint64_t bytes_used() const noexcept { return _data_end; }
+	bool          is_full() const noexcept;
+
+	// asks the os to write the modified pages to disk (doesn't wait for it)
+	void flush() noexcept;
+
+	// finalizes the file and shrinks it to the used size
+	void close() noexcept;
+	bool is_open() const noexcept { return _file != nullptr; }
+
+private:
+	unsigned char* _reserve_record( std::size_t max_payload_size ) noexcept;
+	void           _commit_record( unsigned char* record, const CapturedDatagram& datagram ) noexcept;
+
+	std::unique_ptr<detail::MappedFile> _file;
+	CaptureConfig                       _config;
+	std::uint64_t                       _record_cnt = 0;
+	std::uint64_t                       _data_end   = 0;
+};
+
+/*
+ * Read only view of a capture file (which gets memory mapped). Datagrams can be accessed in O(1) by their index.
+ */
+class CaptureReader {
+public:
+	// Throws generic_nw_error if the file can't be opened or isn't a capture file
+	explicit CaptureReader( std::string_view file_name );
+	CaptureReader( CaptureReader&& other ) noexcept;
+	CaptureReader& operator=( CaptureReader&& other ) noexcept;
+	~CaptureReader();
+
+	std::size_t size() const noexcept { return _record_cnt; }
+	bool        empty() const noexcept { return _record_cnt == 0; }
+
+	// the data of the returned datagram points into the mapping and stays valid as long as the reader
+	CapturedDatagram operator[]( std::size_t idx ) const noexcept;
+	CapturedDatagram at( std::size_t idx ) const;
+
+	// index of the first datagram captured at or after t (assumes the timestamps are monotonic)
+	std::size_t lower_bound( std::chrono::system_clock::time_point t ) const noexcept;
+
+private:
+	std::unique_ptr<detail::MappedFile> _file;
+	const std::uint64_t*                _index      = nullptr;
+	std::size_t                         _record_cnt = 0;
+	std::uint64_t                       _data_end   = 0;
+};
+
+enum class ReplayTiming {
+	original, // keep the inter-arrival times (scaled by ReplayConfig::speed)
+	max_speed // send as fast as the socket allows
+};
+
+struct ReplayConfig {
+	ReplayTiming timing = ReplayTiming::original;
+	// only for ReplayTiming::original: 2.0 replays twice as fast as recorded
+	double speed = 1.0;
+	// range of datagrams [first, last) to replay
+	std::size_t first = 0;
+	std::size_t last  = std::numeric_limits<std::size_t>::max();
+};
+
+struct ReplayStats {
+	std::uint64_t            sent   = 0;
+	std::uint64_t            failed = 0;
+	std::chrono::nanoseconds duration{0};
+};
+
+/*
+ * Sends the captured datagrams to destination. With ReplayTiming::original the thread sleeps between datagrams
+ * and spins for the last few microseconds before each send
+ */
+ReplayStats
+replay( const CaptureReader& capture, Socket& socket, const endpoint& destination, const ReplayConfig& config = {} );
+
+} // namespace mart::nw::ip::udp
+
+#endif
@@ -26,6 +26,7 @@
 
 /* Standard Library Includes */
 #include <chrono>
+#include <optional>
 
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -38,11 +39,13 @@ class HighLevelSocketBase {
 public:
 	HighLevelSocketBase( mart::nw::socks::Domain domain, mart::nw::socks::TransportType type )
 		: _socket( domain, type )
+		, _domain( domain )
 	{
 	}
 
-	explicit HighLevelSocketBase( nw::socks::RaiiSocket&& socket )
+	HighLevelSocketBase( nw::socks::RaiiSocket&& socket, mart::nw::socks::Domain domain )
 		: _socket( std::move( socket ) )
+		, _domain( domain )
 	{
 	}
 
@@ -76,9 +79,73 @@ public:
 	inline bool try_close() noexcept { return _socket.close().success(); }
 	void close();
 
+	/* ###### Performance related socket options ###### */
+	// Options marked as "linux only" fail with the native error code on other platforms
+
+	// Kernel buffer sizes in bytes. Note: linux doubles the requested value and reports the doubled one
+	inline socks::ErrorCode   try_set_rx_buffer_size( int size )            noexcept { return _set_int_option( SocketOptionLevel::Socket, SocketOption::so_rcvbuf, size ); }
+	inline socks::ErrorCode   try_set_tx_buffer_size( int size )            noexcept { return _set_int_option( SocketOptionLevel::Socket, SocketOption::so_sndbuf, size ); }
+	inline ReturnValue<int>   try_get_rx_buffer_size()                const noexcept { return _get_int_option( SocketOptionLevel::Socket, SocketOption::so_rcvbuf ); }
+	inline ReturnValue<int>   try_get_tx_buffer_size()                const noexcept { return _get_int_option( SocketOptionLevel::Socket, SocketOption::so_sndbuf ); }
+
+	void set_rx_buffer_size( int size );
+	void set_tx_buffer_size( int size );
+	int  get_rx_buffer_size() const;
+	int  get_tx_buffer_size() const;
+
+	// Has to be set before binding the socket
+	inline socks::ErrorCode   try_set_reuse_address( bool enable )          noexcept { return _set_int_option( SocketOptionLevel::Socket, SocketOption::so_reuseaddr, enable ); }
+	inline socks::ErrorCode   try_set_reuse_port( bool enable )             noexcept { return _set_int_option( SocketOptionLevel::Socket, SocketOption::so_reuseport, enable ); }
+
+	void set_reuse_address( bool enable );
+	void set_reuse_port( bool enable );
+
+	// Busy poll the device queue for up to the given time on blocking receives (linux only)
+	inline socks::ErrorCode   try_set_busy_poll( std::chrono::microseconds duration ) noexcept
+	{
+		return _set_int_option( SocketOptionLevel::Socket, SocketOption::so_busy_poll, mart::narrow<int>( duration.count() ) );
+	}
+	void set_busy_poll( std::chrono::microseconds duration );
+
+	// Protocol-independent priority for outgoing packets (0-6 without CAP_NET_ADMIN; linux only)
+	inline socks::ErrorCode   try_set_priority( int priority )              noexcept { return _set_int_option( SocketOptionLevel::Socket, SocketOption::so_priority, priority ); }
+	// Type of service / DSCP field of outgoing packets (IP_TOS for ipv4 sockets, IPV6_TCLASS for ipv6 sockets)
+	socks::ErrorCode          try_set_type_of_service( std::uint8_t tos )   noexcept;
+
+	void set_priority( int priority );
+	void set_type_of_service( std::uint8_t tos );
+
+	// false: an ipv6 socket also handles ipv4 traffic via v4-mapped addresses (dual stack). Has to be set before bind
+	inline socks::ErrorCode   try_set_v6_only( bool enable )                noexcept { return _set_int_option( SocketOptionLevel::Ipv6, SocketOption::ipv6_v6only, enable ); }
+	void set_v6_only( bool enable );
+
+	// Disable nagle's algorithm (tcp only)
+	inline socks::ErrorCode   try_set_no_delay( bool enable )               noexcept { return _set_int_option( SocketOptionLevel::Tcp, SocketOption::tcp_nodelay, enable ); }
+	// Send acks immediately. Not permanent - the kernel may switch back to delayed acks (tcp, linux only)
+	inline socks::ErrorCode   try_set_quick_ack( bool enable )              noexcept { return _set_int_option( SocketOptionLevel::Tcp, SocketOption::tcp_quickack, enable ); }
+
+	void set_no_delay( bool enable );
+	void set_quick_ack( bool enable );
+
 	// clang-format on
 protected:
 	nw::socks::RaiiSocket _socket;
+
+private:
+	mart::nw::socks::Domain _domain;
+
+	socks::ErrorCode _set_int_option( SocketOptionLevel level, SocketOption option, int value ) noexcept
+	{
+		return _socket.setsockopt( level, option, value );
+	}
+
+	ReturnValue<int> _get_int_option( SocketOptionLevel level, SocketOption option ) const noexcept
+	{
+		int        value = 0;
+		const auto res   = _socket.getsockopt( level, option, value );
+		if( !res ) { return ReturnValue<int>{res}; }
+		return ReturnValue<int>{value};
+	}
 };
 
 /*
@@ -111,13 +178,107 @@ public:
 	mart::MemoryView try_recv( mart::MemoryView buffer ) noexcept { return _socket.recv( buffer, 0 ).received_data; }
 	mart::MemoryView recv( mart::MemoryView buffer );
 
+	/* Scatter / gather versions: All parts are sent as a single datagram without copying them into a staging
+	 * buffer first. The receive functions distribute a single datagram over the buffers and return the
+	 * total number of received bytes.
+	 */
+	bool try_send( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
+	{
+		return _txWasSuccess( data, _socket.send( data, 0 ) );
+	}
+	void send( mart::ArrayView<const mart::ConstMemoryView> data );
+
+	ReturnValue<txrx_size_t> try_recv( mart::ArrayView<const mart::MemoryView> buffers ) noexcept
+	{
+		return _socket.recv( buffers, 0 );
+	}
+	std::size_t recv( mart::ArrayView<const mart::MemoryView> buffers );
+
 	void clearRxBuff();
+
+	/* ###### Segmentation offload (udp on linux only) ###### */
+
+	/* With a segment size > 0, each buffer passed to send/sendto is split by the kernel (or the NIC) into
+	 * datagrams of segment_size bytes (only the last one may be shorter). 0 disables segmentation again
+	 */
+	socks::ErrorCode try_set_tx_segment_size( std::uint16_t segment_size ) noexcept
+	{
+		return _socket.setsockopt( SocketOptionLevel::Udp, SocketOption::udp_segment, int{segment_size} );
+	}
+	void set_tx_segment_size( std::uint16_t segment_size );
+
+	/* Allows the kernel to coalesce multiple received datagrams into a single buffer.
+	 * Use recvfrom_coalesced to learn the size of the individual datagrams
+	 */
+	socks::ErrorCode try_set_rx_coalescing( bool enable ) noexcept
+	{
+		return _socket.setsockopt( SocketOptionLevel::Udp, SocketOption::udp_gro, int{enable} );
+	}
+	void set_rx_coalescing( bool enable );
+
+	/* ###### Kernel receive timestamps (linux only) ###### */
+
+	/* If enabled, recvfrom reports the time (system_clock) at which the kernel received the datagram
+	 * in RecvfromResult::rx_timestamp
+	 */
+	socks::ErrorCode try_set_rx_timestamping( bool enable ) noexcept
+	{
+		const auto res = _socket.setsockopt( SocketOptionLevel::Socket, SocketOption::so_timestampns, int{enable} );
+		if( res ) { _rx_timestamping = enable; }
+		return res;
+	}
+	void set_rx_timestamping( bool enable );
+	bool is_rx_timestamping() const noexcept { return _rx_timestamping; }
+
+protected:
+	bool _rx_timestamping = false;
+
+	static std::size_t total_size( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
+	{
+		std::size_t size = 0;
+		for( const auto& e : data ) {
+			size += e.size();
+		}
+		return size;
+	}
+
+	static bool _txWasSuccess( mart::ArrayView<const mart::ConstMemoryView> data,
+							   const ReturnValue<txrx_size_t>&             ret ) noexcept
+	{
+		return ret.success() && mart::narrow<nw::socks::txrx_size_t>( total_size( data ) ) == ret.value();
+	}
+};
+
+/*
+ * Stores the native address representation (e.g. SockaddrIn) next to the endpoint, so it doesn't have to be
+ * recomputed on each send. Use it for peers that are sent to repeatedly (see DgramSocket::try_sendto)
+ */
+template<class EndpointT>
+class PreparedEndpoint {
+public:
+	using endpoint    = EndpointT;
+	using native_type = typename EndpointT::abi_endpoint_type;
+
+	PreparedEndpoint() = default;
+	explicit PreparedEndpoint( const endpoint& ep )
+		: _ep( ep )
+		, _native( ep.toSockAddr() )
+	{
+	}
+
+	const endpoint&    get_endpoint() const noexcept { return _ep; }
+	const native_type& native() const noexcept { return _native; }
+
+private:
+	endpoint    _ep{};
+	native_type _native{};
 };
 
 template<class EndpointT>
 class DgramSocket : public DgramSocketBase {
 public:
-	using endpoint = EndpointT;
+	using endpoint          = EndpointT;
+	using prepared_endpoint = PreparedEndpoint<EndpointT>;
 
 	DgramSocket()
 		: DgramSocketBase( endpoint::domain ){
@@ -153,21 +314,76 @@ public:
 		sendto( data, _ep_remote );
 	}
 
+	bool try_sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep ) noexcept
+	{
+		return DgramSocketBase::_txWasSuccess( data, _socket.sendto( data, 0, ep.toSockAddr() ) );
+	}
+	void sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep );
+
+	/* Versions for prepared endpoints: No address conversion on the hot path */
+	static prepared_endpoint prepare( const endpoint& ep ) { return prepared_endpoint( ep ); }
+
+	bool try_sendto( mart::ConstMemoryView data, const prepared_endpoint& ep ) noexcept
+	{
+		return _txWasSuccess( data, _socket.sendto( data, 0, ep.native() ) );
+	}
+	void sendto( mart::ConstMemoryView data, const prepared_endpoint& ep );
+
+	bool try_sendto( mart::ArrayView<const mart::ConstMemoryView> data, const prepared_endpoint& ep ) noexcept
+	{
+		return DgramSocketBase::_txWasSuccess( data, _socket.sendto( data, 0, ep.native() ) );
+	}
+	void sendto( mart::ArrayView<const mart::ConstMemoryView> data, const prepared_endpoint& ep );
+
 	struct RecvfromResult {
 		mart::MemoryView data;
 		endpoint         remote_address;
+		// only set, if rx timestamping is enabled (see set_rx_timestamping)
+		std::optional<std::chrono::system_clock::time_point> rx_timestamp{};
 	};
 	RecvfromResult try_recvfrom( mart::MemoryView buffer ) noexcept
 	{
+		socks::ErrorCode ignored{};
+		return try_recvfrom( buffer, ignored );
+	}
+	// Also reports why nothing has been received (e.g. WouldBlock)
+	RecvfromResult try_recvfrom( mart::MemoryView buffer, socks::ErrorCode& error ) noexcept
+	{
+		if( _rx_timestamping ) { return _recvfrom_timestamped( buffer, error ); }
+
 		using abiep = typename EndpointT::abi_endpoint_type;
 		abiep addr{};
 
 		auto res = _socket.recvfrom( buffer, 0, addr );
+		error    = res.result.error_code();
 
 		return { res.received_data, endpoint( addr ) };
 	}
 	RecvfromResult recvfrom( mart::MemoryView buffer );
 
+	struct ScatterRecvfromResult {
+		ReturnValue<txrx_size_t> result; // total number of bytes received
+		endpoint                 remote_address;
+	};
+	ScatterRecvfromResult try_recvfrom( mart::ArrayView<const mart::MemoryView> buffers ) noexcept
+	{
+		using abiep = typename EndpointT::abi_endpoint_type;
+		abiep addr{};
+
+		auto res = _socket.recvfrom( buffers, 0, addr );
+
+		return { res, endpoint( addr ) };
+	}
+	ScatterRecvfromResult recvfrom( mart::ArrayView<const mart::MemoryView> buffers );
+
+	struct CoalescedRecvfromResult {
+		mart::MemoryView data;
+		std::size_t      segment_size; // size of the individual datagrams in data (data.size() if not coalesced)
+		endpoint         remote_address;
+	};
+	CoalescedRecvfromResult try_recvfrom_coalesced( mart::MemoryView buffer ) noexcept;
+	CoalescedRecvfromResult recvfrom_coalesced( mart::MemoryView buffer );
+
 	void clearRxBuff();
 
 	auto close()
@@ -191,6 +407,9 @@ private:
 	{
 		return ret.result.success() && mart::narrow<nw::socks::txrx_size_t>( data.size() ) == ret.result.value();
 	}
+	// recvmsg based version of recvfrom that also extracts the kernel timestamp
+	RecvfromResult _recvfrom_timestamped( mart::MemoryView buffer, socks::ErrorCode& error ) noexcept;
+
 	endpoint _ep_local{};
 	endpoint _ep_remote{};
 };
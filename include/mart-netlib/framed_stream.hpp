@@ -0,0 +1,108 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_FRAMED_STREAM_HPP
+#define LIB_MART_COMMON_GUARD_NW_FRAMED_STREAM_HPP
+/**
+ * framed_stream.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Message framing (length prefixed or delimited) on top of a tcp::Socket
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "tcp.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::tcp {
+
+/*
+ * Splits the byte stream of a tcp::Socket into frames. Either each frame is prefixed by its length
+ * (4 bytes, network byte order) or frames are terminated by a delimiter byte.
+ *
+ * Receiving: Data is read in large chunks into an internal buffer (whose size also limits the size of a frame)
+ * and recv_frame hands out views into that buffer. A view stays valid until the next call to recv_frame.
+ *
+ * Sending: queue_frame only records the payload (no copy - it has to stay alive until the next flush).
+ * flush sends all queued frames including their headers / delimiters with as few writev calls as possible.
+ */
+class FramedStream {
+public:
+	enum class Framing { LengthPrefix, Delimiter };
+
+	static constexpr std::size_t default_rx_buffer_size = 64 * 1024;
+	static constexpr std::size_t length_prefix_size     = 4;
+	// each frame needs two io buffers (header/delimiter + payload)
+	static constexpr std::size_t max_queued_frames = socks::port_layer::max_io_buffer_cnt / 2;
+
+	static FramedStream length_prefixed( Socket socket, std::size_t rx_buffer_size = default_rx_buffer_size );
+	static FramedStream
+	delimited( Socket socket, std::uint8_t delimiter = '\n', std::size_t rx_buffer_size = default_rx_buffer_size );
+
+	/* Returns the next complete frame (without header / delimiter). Returns an empty optional, if no
+	 * complete frame could be received (timeout, non-blocking socket or connection closed by the peer).
+	 * Throws if the socket reports an error or a frame doesn't fit into the receive buffer.
+	 */
+	std::optional<mart::ConstMemoryView> recv_frame();
+
+	// Only looks at already buffered data - never calls into the os
+	std::optional<mart::ConstMemoryView> try_next_buffered_frame();
+
+	// Automatically flushes, if max_queued_frames are queued already
+	void queue_frame( mart::ConstMemoryView payload );
+	// If sending fails, the exception is passed on and the frames stay queued. Some of them might have been
+	// (partially) written already, so the stream is broken and should only be closed afterwards
+	void flush();
+
+	void send_frame( mart::ConstMemoryView payload )
+	{
+		queue_frame( payload );
+		flush();
+	}
+
+	bool is_closed() const noexcept { return _closed; }
+
+	Framing framing() const noexcept { return _framing; }
+
+	const Socket& socket() const noexcept { return _socket; }
+	Socket&       socket() noexcept { return _socket; }
+
+private:
+	FramedStream( Socket&& socket, Framing framing, std::uint8_t delimiter, std::size_t rx_buffer_size );
+
+	bool _fill_rx_buffer();
+
+	Socket       _socket;
+	Framing      _framing;
+	std::uint8_t _delimiter;
+	bool         _closed = false;
+
+	std::unique_ptr<std::uint8_t[]> _rx_buffer;
+	std::size_t                     _rx_capacity;
+	std::size_t                     _rx_begin = 0; // start of the first unparsed byte
+	std::size_t                     _rx_end   = 0; // end of the received data
+	std::size_t                     _rx_scan  = 0; // delimiter search already covered [_rx_begin,_rx_scan)
+
+	std::array<mart::ConstMemoryView, max_queued_frames> _tx_frames{};
+	std::size_t                                          _tx_frame_cnt = 0;
+};
+
+} // namespace mart::nw::ip::tcp
+
+#endif
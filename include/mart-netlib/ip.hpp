@@ -61,6 +61,12 @@ public:
 	constexpr uint32_net_t  inNetOrder() const noexcept { return _addr; }
 	constexpr uint32_host_t inHostOrder() const noexcept { return to_host_order( _addr ); }
 
+	// 224.0.0.0/4
+	constexpr bool is_multicast() const noexcept
+	{
+		return ( inHostOrder() & 0xF0'00'00'00 ) == 0xE0'00'00'00;
+	}
+
 	friend constexpr bool operator==( address_v4 l, address_v4 r ) noexcept { return l._addr == r._addr; }
 	friend constexpr bool operator!=( address_v4 l, address_v4 r ) noexcept { return l._addr != r._addr; }
 	friend constexpr bool operator<( address_v4 l, address_v4 r )
@@ -99,6 +105,88 @@ constexpr bool is_valid_v4_address( const std::string_view string )
 	return _impl_addr_v4::parse_address( string ).has_value();
 }
 
+// ##### IP_v6 Address
+
+class address_v6 {
+public:
+	using bytes_type = std::array<std::uint8_t, 16>;
+
+	constexpr address_v6() = default;
+	constexpr explicit address_v6( const bytes_type& bytes, std::uint32_t scope_id = 0 ) noexcept
+		: _bytes( bytes )
+		, _scope_id( scope_id )
+	{
+	}
+	// expects the textual representation defined in RFC 4291 (e.g. "::1" or "fe80::1:2") without brackets,
+	// optionally followed by a zone id (RFC 4007), which is either an interface name or index: "fe80::1%eth0"
+	explicit address_v6( std::string_view str );
+
+	// ::ffff:a.b.c.d - used by dual stack sockets to represent ipv4 peers
+	static constexpr address_v6 v4_mapped( address_v4 addr ) noexcept
+	{
+		const uint32_host_t h = addr.inHostOrder();
+
+		bytes_type bytes{};
+		bytes[10] = 0xff;
+		bytes[11] = 0xff;
+		bytes[12] = static_cast<std::uint8_t>( h >> 24 );
+		bytes[13] = static_cast<std::uint8_t>( h >> 16 );
+		bytes[14] = static_cast<std::uint8_t>( h >> 8 );
+		bytes[15] = static_cast<std::uint8_t>( h );
+		return address_v6( bytes );
+	}
+
+	// includes the zone id (interface name if possible), if the scope id isn't 0
+	mba::im_zstr asString() const;
+
+	constexpr const bytes_type& to_bytes() const noexcept { return _bytes; }
+	constexpr std::uint32_t     scope_id() const noexcept { return _scope_id; }
+
+	constexpr bool is_v4_mapped() const noexcept
+	{
+		for( std::size_t i = 0; i < 10; ++i ) {
+			if( _bytes[i] != 0 ) { return false; }
+		}
+		return _bytes[10] == 0xff && _bytes[11] == 0xff;
+	}
+
+	// ff00::/8
+	constexpr bool is_multicast() const noexcept { return _bytes[0] == 0xff; }
+
+	// only meaningful if is_v4_mapped() is true
+	constexpr address_v4 to_v4() const noexcept
+	{
+		return address_v4( uint32_host_t{( std::uint32_t{_bytes[12]} << 24 ) | ( std::uint32_t{_bytes[13]} << 16 )
+										 | ( std::uint32_t{_bytes[14]} << 8 ) | std::uint32_t{_bytes[15]}} );
+	}
+
+	friend constexpr bool operator==( const address_v6& l, const address_v6& r ) noexcept
+	{
+		for( std::size_t i = 0; i < l._bytes.size(); ++i ) {
+			if( l._bytes[i] != r._bytes[i] ) { return false; }
+		}
+		return l._scope_id == r._scope_id;
+	}
+	friend constexpr bool operator!=( const address_v6& l, const address_v6& r ) noexcept { return !( l == r ); }
+	friend constexpr bool operator<( const address_v6& l, const address_v6& r ) noexcept
+	{
+		for( std::size_t i = 0; i < l._bytes.size(); ++i ) {
+			if( l._bytes[i] != r._bytes[i] ) { return l._bytes[i] < r._bytes[i]; }
+		}
+		return l._scope_id < r._scope_id;
+	}
+
+private:
+	bytes_type    _bytes{};
+	std::uint32_t _scope_id = 0;
+};
+
+constexpr address_v6 address_v6_any{};
+constexpr address_v6 address_v6_local_host( address_v6::bytes_type{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1} );
+
+// NOTE: unlike the v4 version, this isn't constexpr, as it relies on the os (inet_pton)
+std::optional<address_v6> try_parse_v6_address( std::string_view string ) noexcept;
+
 // ##### Port
 
 class port_nr {
@@ -269,6 +357,91 @@ private:
 	}
 };
 
+namespace _impl_details_ip {
+
+struct basic_endpoint_v6_base {
+	using abi_endpoint_type = mart::nw::socks::port_layer::SockaddrIn6;
+	static constexpr socks::Domain domain = socks::Domain::Inet6;
+
+	/* ####### State ############ */
+	address_v6 address{};
+	port_nr    port{};
+	bool       _valid = false;
+
+	/* ####### constructors ############ */
+	constexpr basic_endpoint_v6_base() noexcept = default;
+
+	explicit basic_endpoint_v6_base( const abi_endpoint_type& native );
+
+	constexpr basic_endpoint_v6_base( address_v6 address, port_nr port ) noexcept
+		: address( address )
+		, port( port )
+		, _valid{true}
+	{
+	}
+
+	// expects format [XXXX:...:XXXX]:pppp or [XXXX:...:XXXX%zone]:pppp
+	explicit basic_endpoint_v6_base( std::string_view str );
+
+	mart::nw::socks::port_layer::SockaddrIn6 toSockAddr_in6() const noexcept
+	{
+		return mart::nw::socks::port_layer::SockaddrIn6( address.to_bytes(), port.inNetOrder(), address.scope_id() );
+	}
+
+	// for use in generic contexts
+	mart::nw::socks::port_layer::SockaddrIn6 toSockAddr() const noexcept { return toSockAddr_in6(); }
+
+	mba::im_zstr toString() const;
+
+	constexpr bool valid() const noexcept { return _valid; }
+
+protected:
+	mba::im_zstr toStringEx( TransportProtocol p ) const;
+};
+
+std::optional<basic_endpoint_v6_base> try_parse_basic_v6_endpoint( std::string_view str ) noexcept;
+
+} // namespace _impl_details_ip
+
+template<TransportProtocol p>
+struct basic_endpoint_v6 : _impl_details_ip::basic_endpoint_v6_base {
+
+	using _impl_details_ip::basic_endpoint_v6_base::basic_endpoint_v6_base;
+
+	mba::im_zstr          toStringEx() const { return _impl_details_ip::basic_endpoint_v6_base::toStringEx( p ); }
+	friend constexpr bool operator==( const basic_endpoint_v6& l, const basic_endpoint_v6& r ) noexcept
+	{
+		return l.address == r.address && l.port == r.port;
+	}
+
+	friend constexpr bool operator!=( const basic_endpoint_v6& l, const basic_endpoint_v6& r ) noexcept
+	{
+		return !( l == r );
+	}
+
+	static std::optional<basic_endpoint_v6<p>> try_parse( std::string_view str ) noexcept
+	{
+		auto rs = _impl_details_ip::try_parse_basic_v6_endpoint( str );
+		if( rs.has_value() ) {
+			return basic_endpoint_v6<p>( rs.value() );
+		} else {
+			return {};
+		}
+	}
+
+private:
+	constexpr basic_endpoint_v6( const _impl_details_ip::basic_endpoint_v6_base& other )
+		: basic_endpoint_v6_base( other )
+	{
+	}
+};
+
+template<TransportProtocol p>
+std::optional<basic_endpoint_v6<p>> try_parse_v6_endpoint( std::string_view str ) noexcept
+{
+	return basic_endpoint_v6<p>::try_parse( str );
+}
+
 constexpr bool is_valid_v4_endpoint( std::string_view str )
 {
 	return _impl_details_ip::try_parse_basic_v4_endpoint( str ).has_value();
@@ -0,0 +1,237 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_LOOPBACK_TRANSPORT_HPP
+#define LIB_MART_COMMON_GUARD_NW_LOOPBACK_TRANSPORT_HPP
+/**
+ * loopback_transport.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	In-process datagram transport with the interface of udp::Socket (for tests and benchmarks)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "udp.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+// Applied by the sender to each datagram
+struct LoopbackImpairments {
+	// probability [0,1] that a datagram is silently dropped
+	double loss_probability = 0;
+	// probability [0,1] that a datagram is held back by reorder_delay, so that later datagrams overtake it
+	double                    reorder_probability = 0;
+	std::chrono::microseconds reorder_delay{100};
+	// each datagram becomes receivable latency + [0,jitter] after it was sent
+	std::chrono::microseconds latency{0};
+	std::chrono::microseconds jitter{0};
+
+	bool delays_datagrams() const noexcept
+	{
+		return reorder_probability > 0 || latency.count() > 0 || jitter.count() > 0;
+	}
+};
+
+struct LoopbackNetworkConfig {
+	LoopbackImpairments impairments{};
+	// Number of datagrams that can be queued per socket (rounded up to a power of two).
+	// Datagrams sent to a full queue are dropped
+	std::size_t queue_capacity = 1024;
+	// Seed for the impairments: With the same seed, the sockets (created in the same order) make the same decisions
+	std::uint64_t seed = 0x5eed;
+};
+
+struct LoopbackStats {
+	std::uint64_t sent                = 0;
+	std::uint64_t queued              = 0;
+	std::uint64_t dropped_loss        = 0;
+	std::uint64_t dropped_no_receiver = 0;
+	std::uint64_t dropped_queue_full  = 0;
+};
+
+namespace detail {
+class LoopbackMailbox;
+}
+
+/*
+ * The "network" the LoopbackSockets are attached to: Maps the endpoints sockets are bound to to their
+ * receive queues. Binding, connecting and closing take a lock, sending and receiving don't.
+ * Has to outlive all sockets attached to it.
+ */
+class LoopbackNetwork {
+public:
+	explicit LoopbackNetwork( const LoopbackNetworkConfig& config = {} );
+	~LoopbackNetwork();
+
+	LoopbackNetwork( const LoopbackNetwork& ) = delete;
+	LoopbackNetwork& operator=( const LoopbackNetwork& ) = delete;
+
+	const LoopbackNetworkConfig& config() const noexcept { return _config; }
+	LoopbackStats                stats() const noexcept;
+
+private:
+	friend class LoopbackSocket;
+
+	using mailbox_ptr = std::shared_ptr<detail::LoopbackMailbox>;
+
+	// returns nullptr if the endpoint is in use. Assigns an ephemeral port, if ep.port is 0
+	mailbox_ptr   _bind( endpoint& ep );
+	void          _unbind( const endpoint& ep ) noexcept;
+	mailbox_ptr   _find( const endpoint& ep ) const noexcept;
+	std::uint64_t _next_socket_seed() noexcept;
+
+	struct Counters {
+		std::atomic<std::uint64_t> sent{0};
+		std::atomic<std::uint64_t> queued{0};
+		std::atomic<std::uint64_t> dropped_loss{0};
+		std::atomic<std::uint64_t> dropped_no_receiver{0};
+		std::atomic<std::uint64_t> dropped_queue_full{0};
+	};
+
+	const LoopbackNetworkConfig _config;
+	Counters                    _counters;
+
+	mutable std::mutex                             _mutex;
+	std::unordered_map<std::uint64_t, mailbox_ptr> _mailboxes;
+	std::uint16_t                                  _next_ephemeral_port = 49152;
+	std::uint64_t                                  _socket_cnt          = 0;
+};
+
+/*
+ * Drop-in replacement for udp::Socket in code that is templated on the socket type. Instead of the
+ * kernel, datagrams go through a bounded lock-free queue of the receiving socket.
+ *
+ * Like with udp, sending never blocks and succeeds even if the datagram gets lost (see LoopbackStats),
+ * datagrams that don't fit into the receive buffer get truncated and unbound sockets get an ephemeral
+ * port on the first send. Any number of threads may send to a socket, but only one may receive from it at a time.
+ * Blocking receives spin (yielding the thread) until a datagram arrives or the timeout expires.
+ * The queues reuse their payload buffers, so sending and receiving only allocate until the buffers have grown
+ * to the size of the datagrams. If that fails, the functions report ENOMEM.
+ */
+class LoopbackSocket {
+public:
+	using endpoint = udp::endpoint;
+
+	struct RecvfromResult {
+		mart::MemoryView data;
+		endpoint         remote_address;
+		// only set, if rx timestamping is enabled (see set_rx_timestamping)
+		std::optional<std::chrono::system_clock::time_point> rx_timestamp{};
+	};
+
+	explicit LoopbackSocket( LoopbackNetwork& network );
+	LoopbackSocket( LoopbackNetwork& network, endpoint local, endpoint remote );
+
+	LoopbackSocket( LoopbackSocket&& other ) noexcept;
+	LoopbackSocket& operator=( LoopbackSocket&& other ) noexcept;
+	~LoopbackSocket();
+
+	socks::ErrorCode try_bind( endpoint ep ) noexcept;
+	void             bind( endpoint ep );
+
+	socks::ErrorCode try_connect( endpoint ep ) noexcept;
+	void             connect( endpoint ep );
+
+	bool try_send( mart::ConstMemoryView data ) noexcept;
+	void send( mart::ConstMemoryView data );
+
+	bool try_sendto( mart::ConstMemoryView data, endpoint ep ) noexcept;
+	void sendto( mart::ConstMemoryView data, endpoint ep );
+
+	bool try_sendto_default( mart::ConstMemoryView data ) noexcept { return try_sendto( data, _ep_remote ); }
+	void sendto_default( mart::ConstMemoryView data ) { sendto( data, _ep_remote ); }
+
+	mart::MemoryView try_recv( mart::MemoryView buffer ) noexcept { return try_recvfrom( buffer ).data; }
+	mart::MemoryView recv( mart::MemoryView buffer ) { return recvfrom( buffer ).data; }
+
+	RecvfromResult try_recvfrom( mart::MemoryView buffer ) noexcept;
+	RecvfromResult recvfrom( mart::MemoryView buffer );
+
+	void clearRxBuff() noexcept;
+
+	// 0 means no timeout (same as the os sockets)
+	bool try_set_rx_timeout( std::chrono::microseconds timeout ) noexcept
+	{
+		_rx_timeout = timeout;
+		return true;
+	}
+	void                      set_rx_timeout( std::chrono::microseconds timeout ) { try_set_rx_timeout( timeout ); }
+	std::chrono::microseconds get_rx_timeout() const noexcept { return _rx_timeout; }
+
+	bool try_set_blocking( bool should_block ) noexcept
+	{
+		_is_blocking = should_block;
+		return true;
+	}
+	void set_blocking( bool should_block ) { try_set_blocking( should_block ); }
+	bool is_blocking() const noexcept { return _is_blocking; }
+
+	// The timestamp is the time the datagram became receivable (after latency / jitter / reordering)
+	bool try_set_rx_timestamping( bool enable ) noexcept;
+	void set_rx_timestamping( bool enable ) { try_set_rx_timestamping( enable ); }
+	bool is_rx_timestamping() const noexcept { return _rx_timestamping; }
+
+	bool is_valid() const noexcept { return _network != nullptr; }
+
+	bool try_close() noexcept;
+	void close() noexcept { try_close(); }
+
+	const endpoint& get_local_endpoint() const noexcept { return _ep_local; }
+	const endpoint& get_remote_endpoint() const noexcept { return _ep_remote; }
+
+	void set_default_remote_endpoint( endpoint ep ) noexcept { _ep_remote = ep; }
+
+private:
+	using mailbox_ptr = std::shared_ptr<detail::LoopbackMailbox>;
+
+	socks::ErrorCode _try_sendto( mart::ConstMemoryView data, const endpoint& ep ) noexcept;
+	socks::ErrorCode _try_recvfrom( mart::MemoryView buffer, RecvfromResult& result ) noexcept;
+	std::uint64_t    _next_random() noexcept;
+
+	detail::LoopbackMailbox* _find_tx_route( const endpoint& ep ) noexcept;
+
+	LoopbackNetwork* _network;
+	mailbox_ptr      _rx_mailbox; // set once bound
+	endpoint         _ep_local{};
+	endpoint         _ep_remote{};
+
+	// Most recent destinations - avoids the lookup (and lock) in the network on repeated sends to the same peers.
+	// A socket that sends to more peers than this in turn pays for a lookup on each send
+	struct TxRoute {
+		endpoint    ep{};
+		mailbox_ptr mailbox;
+	};
+	static constexpr std::size_t      tx_route_cnt = 8;
+	std::array<TxRoute, tx_route_cnt> _tx_routes{};
+	std::size_t                       _tx_route_next = 0; // route that gets replaced on the next miss
+
+	std::chrono::microseconds _rx_timeout{0};
+	bool                      _is_blocking     = true;
+	bool                      _rx_timestamping = false;
+	std::uint64_t             _rng_state;
+};
+
+} // namespace mart::nw::ip::udp
+
+#endif
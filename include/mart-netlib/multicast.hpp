@@ -0,0 +1,216 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_MULTICAST_HPP
+#define LIB_MART_COMMON_GUARD_NW_MULTICAST_HPP
+/**
+ * multicast.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Multicast options for udp sockets and a simple publisher / subscriber on top of them
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "udp.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <cstdint>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+/* ###### Group membership ###### */
+// ipv4: The interface is selected by its address (address_any: let the os choose)
+// ipv6: The interface is selected by its index (0: let the os choose)
+// Closing the socket leaves all groups it joined
+
+inline socks::ErrorCode
+try_join_group( Socket& socket, address_v4 group, address_v4 interface_address = address_any ) noexcept
+{
+	return socks::port_layer::join_multicast_group(
+		socket.get_raw_socket_handle(), group.inNetOrder(), interface_address.inNetOrder() );
+}
+inline socks::ErrorCode
+try_leave_group( Socket& socket, address_v4 group, address_v4 interface_address = address_any ) noexcept
+{
+	return socks::port_layer::leave_multicast_group(
+		socket.get_raw_socket_handle(), group.inNetOrder(), interface_address.inNetOrder() );
+}
+inline socks::ErrorCode
+try_join_group( Socket6& socket, const address_v6& group, std::uint32_t interface_index = 0 ) noexcept
+{
+	return socks::port_layer::join_multicast_group( socket.get_raw_socket_handle(), group.to_bytes(), interface_index );
+}
+inline socks::ErrorCode
+try_leave_group( Socket6& socket, const address_v6& group, std::uint32_t interface_index = 0 ) noexcept
+{
+	return socks::port_layer::leave_multicast_group( socket.get_raw_socket_handle(), group.to_bytes(), interface_index );
+}
+
+void join_group( Socket& socket, address_v4 group, address_v4 interface_address = address_any );
+void leave_group( Socket& socket, address_v4 group, address_v4 interface_address = address_any );
+void join_group( Socket6& socket, const address_v6& group, std::uint32_t interface_index = 0 );
+void leave_group( Socket6& socket, const address_v6& group, std::uint32_t interface_index = 0 );
+
+/* ###### Options for outgoing multicast datagrams ###### */
+
+// Number of routers a datagram may pass (hop limit for ipv6). The os default is 1 (stay in the local network)
+inline socks::ErrorCode try_set_multicast_ttl( Socket& socket, int ttl ) noexcept
+{
+	return socks::port_layer::set_multicast_ttl( socket.get_raw_socket_handle(), socks::Domain::Inet, ttl );
+}
+inline socks::ErrorCode try_set_multicast_ttl( Socket6& socket, int ttl ) noexcept
+{
+	return socks::port_layer::set_multicast_ttl( socket.get_raw_socket_handle(), socks::Domain::Inet6, ttl );
+}
+
+// Whether datagrams are also delivered to members of the group on the sending host (os default: true)
+inline socks::ErrorCode try_set_multicast_loopback( Socket& socket, bool enable ) noexcept
+{
+	return socks::port_layer::set_multicast_loopback( socket.get_raw_socket_handle(), socks::Domain::Inet, enable );
+}
+inline socks::ErrorCode try_set_multicast_loopback( Socket6& socket, bool enable ) noexcept
+{
+	return socks::port_layer::set_multicast_loopback( socket.get_raw_socket_handle(), socks::Domain::Inet6, enable );
+}
+
+// Interface multicast datagrams are sent from (default: chosen by the routing table)
+inline socks::ErrorCode try_set_multicast_interface( Socket& socket, address_v4 interface_address ) noexcept
+{
+	return socks::port_layer::set_multicast_interface( socket.get_raw_socket_handle(),
+													   interface_address.inNetOrder() );
+}
+inline socks::ErrorCode try_set_multicast_interface( Socket6& socket, std::uint32_t interface_index ) noexcept
+{
+	return socks::port_layer::set_multicast_interface( socket.get_raw_socket_handle(), interface_index );
+}
+
+void set_multicast_ttl( Socket& socket, int ttl );
+void set_multicast_ttl( Socket6& socket, int ttl );
+void set_multicast_loopback( Socket& socket, bool enable );
+void set_multicast_loopback( Socket6& socket, bool enable );
+void set_multicast_interface( Socket& socket, address_v4 interface_address );
+void set_multicast_interface( Socket6& socket, std::uint32_t interface_index );
+
+/* ###### Publisher / subscriber ###### */
+
+namespace detail {
+
+template<class SocketT>
+struct multicast_traits;
+
+template<>
+struct multicast_traits<Socket> {
+	using address_type   = address_v4;
+	using interface_type = address_v4;
+
+	static constexpr address_type   any_address       = address_any;
+	static constexpr interface_type default_interface = address_any;
+};
+
+template<>
+struct multicast_traits<Socket6> {
+	using address_type   = address_v6;
+	using interface_type = std::uint32_t;
+
+	static constexpr address_type   any_address       = address_v6_any;
+	static constexpr interface_type default_interface = 0;
+};
+
+} // namespace detail
+
+struct MulticastConfig {
+	// see set_multicast_ttl
+	int ttl = 1;
+	// deliver published datagrams also to subscribers on the same host
+	bool loopback = true;
+};
+
+/*
+ * Sends each datagram with a single sendto to all members of a multicast group
+ * (the group endpoint is prepared once, see DgramSocket::prepare)
+ */
+template<class SocketT>
+class BasicMulticastPublisher {
+public:
+	using socket_type    = SocketT;
+	using endpoint       = typename SocketT::endpoint;
+	using interface_type = typename detail::multicast_traits<SocketT>::interface_type;
+
+	// NOTE: "interface" is a macro on windows
+	explicit BasicMulticastPublisher( const endpoint&        group,
+									  const MulticastConfig& config = {},
+									  interface_type         iface  = detail::multicast_traits<SocketT>::default_interface );
+
+	bool try_publish( mart::ConstMemoryView data ) noexcept { return _socket.try_sendto( data, _group ); }
+	void publish( mart::ConstMemoryView data ) { _socket.sendto( data, _group ); }
+
+	bool try_publish( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
+	{
+		return _socket.try_sendto( data, _group );
+	}
+	void publish( mart::ArrayView<const mart::ConstMemoryView> data ) { _socket.sendto( data, _group ); }
+
+	const endpoint& group() const noexcept { return _group.get_endpoint(); }
+
+	const SocketT& socket() const noexcept { return _socket; }
+	SocketT&       socket() noexcept { return _socket; }
+
+private:
+	SocketT                             _socket;
+	typename SocketT::prepared_endpoint _group;
+};
+
+/*
+ * Joins a multicast group and receives the datagrams sent to it. The socket is bound with SO_REUSEADDR,
+ * so multiple subscribers (in the same or different processes) can listen to the same group and port
+ */
+template<class SocketT>
+class BasicMulticastSubscriber {
+public:
+	using socket_type    = SocketT;
+	using endpoint       = typename SocketT::endpoint;
+	using interface_type = typename detail::multicast_traits<SocketT>::interface_type;
+
+	explicit BasicMulticastSubscriber(
+		const endpoint& group,
+		interface_type  iface = detail::multicast_traits<SocketT>::default_interface );
+
+	typename SocketT::RecvfromResult try_recvfrom( mart::MemoryView buffer ) noexcept
+	{
+		return _socket.try_recvfrom( buffer );
+	}
+	typename SocketT::RecvfromResult recvfrom( mart::MemoryView buffer ) { return _socket.recvfrom( buffer ); }
+
+	const endpoint& group() const noexcept { return _group; }
+
+	const SocketT& socket() const noexcept { return _socket; }
+	SocketT&       socket() noexcept { return _socket; }
+
+private:
+	SocketT  _socket;
+	endpoint _group;
+};
+
+extern template class BasicMulticastPublisher<Socket>;
+extern template class BasicMulticastPublisher<Socket6>;
+extern template class BasicMulticastSubscriber<Socket>;
+extern template class BasicMulticastSubscriber<Socket6>;
+
+using MulticastPublisher   = BasicMulticastPublisher<Socket>;
+using MulticastPublisher6  = BasicMulticastPublisher<Socket6>;
+using MulticastSubscriber  = BasicMulticastSubscriber<Socket>;
+using MulticastSubscriber6 = BasicMulticastSubscriber<Socket6>;
+
+} // namespace mart::nw::ip::udp
+
+#endif
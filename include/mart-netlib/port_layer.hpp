@@ -65,6 +65,9 @@ ErrorCode close_socket( handle_t handle ) noexcept;
 
 ReturnValue<handle_t> accept( handle_t handle, Sockaddr& addr ) noexcept;
 ReturnValue<handle_t> accept( handle_t handle ) noexcept;
+// Creates the accepted socket with close-on-exec set and in the requested blocking mode.
+// On linux, this is a single accept4 call, elsewhere the mode is set by additional calls
+ReturnValue<handle_t> accept4( handle_t handle, Sockaddr& addr, bool non_blocking ) noexcept;
 
 ErrorCode connect( handle_t handle, const Sockaddr& addr ) noexcept;
 ErrorCode bind( handle_t handle, const Sockaddr& addr ) noexcept;
@@ -75,11 +78,98 @@ ReturnValue<txrx_size_t> sendto( handle_t handle, byte_range buf, int flags, con
 ReturnValue<txrx_size_t> recv( handle_t handle, byte_range_mut buf, int flags ) noexcept;
 ReturnValue<txrx_size_t> recvfrom( handle_t handle, byte_range_mut buf, int flags, Sockaddr& from ) noexcept;
 
+// Scatter/gather versions of send/recv (sendmsg/recvmsg on posix, WSASend/WSARecv on windows)
+// All buffers are transmitted / filled in a single call. At most max_io_buffer_cnt buffers
+// are supported - if more are passed, the functions fail with ErrorCodeValues::InvalidArgument
+constexpr std::size_t max_io_buffer_cnt = 64;
+
+ReturnValue<txrx_size_t> sendmsg( handle_t handle, const byte_range* buffers, std::size_t buffer_cnt, int flags ) noexcept;
+ReturnValue<txrx_size_t>
+sendmsg( handle_t handle, const byte_range* buffers, std::size_t buffer_cnt, int flags, const Sockaddr& to ) noexcept;
+ReturnValue<txrx_size_t>
+recvmsg( handle_t handle, const byte_range_mut* buffers, std::size_t buffer_cnt, int flags ) noexcept;
+ReturnValue<txrx_size_t>
+recvmsg( handle_t handle, const byte_range_mut* buffers, std::size_t buffer_cnt, int flags, Sockaddr& from ) noexcept;
+
+// Additional information about a received message, which is not part of the payload (e.g. cmsg on linux)
+struct RecvMsgInfo {
+	// If the kernel coalesced multiple datagrams into the receive buffers (UDP_GRO) this is the size of the
+	// individual datagrams (only the last one may be shorter). Otherwise 0
+	int segment_size = 0;
+	// Kernel receive timestamp (SO_TIMESTAMPNS) in ns since the unix epoch. 0 if timestamping isn't enabled
+	std::chrono::nanoseconds rx_timestamp{ 0 };
+};
+
+ReturnValue<txrx_size_t> recvmsg( handle_t              handle,
+								  const byte_range_mut* buffers,
+								  std::size_t           buffer_cnt,
+								  int                   flags,
+								  Sockaddr&             from,
+								  RecvMsgInfo&          info ) noexcept;
+
+/* ############# Zero copy file transmission ############# */
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+using file_handle_t = void*; // HANDLE
+#else
+using file_handle_t = int;
+#endif
+
+ReturnValue<file_handle_t> open_file_read_only( const char* path ) noexcept;
+ErrorCode                  close_file( file_handle_t file ) noexcept;
+
+// Sends up to count bytes of the file, starting at offset, without copying them through user space
+// (sendfile on linux/macOS/FreeBSD, TransmitFile on windows, pread + send elsewhere). The file position is not
+// used (but changed on windows). Like send, fewer bytes than requested may be sent (in particular on non-blocking
+// sockets) and 0 is returned at the end of the file. At most max_send_file_chunk bytes are sent per call
+constexpr std::size_t max_send_file_chunk = 0x7ffff000;
+
+ReturnValue<txrx_size_t>
+send_file( handle_t handle, file_handle_t file, std::uint64_t offset, std::size_t count ) noexcept;
+
 ErrorCode setsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, byte_range data ) noexcept;
 ErrorCode getsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, byte_range_mut& buffer ) noexcept;
 
+// Attaches a classic bpf program to the SO_REUSEPORT group of the (bound) socket, which selects the socket
+// with the same index as the cpu that processes the packet (linux only - fails with ENOPROTOOPT elsewhere)
+ErrorCode attach_reuseport_cpu_steering( handle_t handle ) noexcept;
+
+// Multicast group membership. ipv4 selects the interface by its address (0: let the os choose),
+// ipv6 by its index (0: let the os choose)
+ErrorCode join_multicast_group( handle_t handle, uint32_net_t group, uint32_net_t interface_address ) noexcept;
+ErrorCode leave_multicast_group( handle_t handle, uint32_net_t group, uint32_net_t interface_address ) noexcept;
+ErrorCode
+join_multicast_group( handle_t handle, const std::array<std::uint8_t, 16>& group, std::uint32_t interface_index ) noexcept;
+ErrorCode
+leave_multicast_group( handle_t handle, const std::array<std::uint8_t, 16>& group, std::uint32_t interface_index ) noexcept;
+
+// Options for outgoing multicast datagrams. domain selects between the ipv4 and ipv6 version of the option
+ErrorCode set_multicast_ttl( handle_t handle, Domain domain, int ttl ) noexcept; // hop limit for ipv6
+ErrorCode set_multicast_loopback( handle_t handle, Domain domain, bool enable ) noexcept;
+ErrorCode set_multicast_interface( handle_t handle, uint32_net_t interface_address ) noexcept;
+ErrorCode set_multicast_interface( handle_t handle, std::uint32_t interface_index ) noexcept;
+
 ErrorCode getsockname( handle_t handle, Sockaddr& addr ) noexcept;
 
+// Returns and clears the pending error of the socket (SO_ERROR) - e.g. the result of a non-blocking connect
+ErrorCode get_socket_error( handle_t handle ) noexcept;
+
+/* ############# Waiting on multiple sockets ############# */
+
+constexpr short poll_in    = 0x1; // readable (or a connection can be accepted)
+constexpr short poll_out   = 0x2; // writable (or a non-blocking connect completed)
+constexpr short poll_error = 0x4; // error, hang up or invalid handle (only reported in revents)
+
+struct PollEntry {
+	handle_t handle;
+	short    events;  // combination of poll_in / poll_out
+	short    revents; // set by poll
+};
+
+// Waits until at least one of the sockets is ready or the timeout expired (poll / WSAPoll).
+// Returns the number of entries with a non-zero revents (0 on timeout). A negative timeout waits indefinitely
+ReturnValue<int> poll( PollEntry* entries, std::size_t entry_cnt, int timeout_ms ) noexcept;
+
 ErrorCode get_last_socket_error() noexcept;
 bool      waInit() noexcept;
 
@@ -159,8 +249,13 @@ struct SockaddrIn6 : mart::nw::socks::Sockaddr {
 	const ::sockaddr_in6&        native() const noexcept;
 	::sockaddr_in6&              native() noexcept;
 	std::array<std::uint8_t, 16> address() const noexcept;
+	mart::nw::uint16_net_t       port() const noexcept;
+	std::uint32_t                scope_id() const noexcept;
 
 	explicit SockaddrIn6( const ::sockaddr_in6& native );
+	SockaddrIn6( const std::array<std::uint8_t, 16>& address,
+				 mart::nw::uint16_net_t              port,
+				 std::uint32_t                       scope_id = 0 ) noexcept;
 
 private:
 	// this should have the same size and alignment as the platform's SockaddrIn6
@@ -216,6 +311,11 @@ const char* inet_net_to_pres( mart::nw::socks::Domain af, const void* src, char*
 const char* inet_net_to_pres( const ::sockaddr* src, char* dst, size_t size );                       // inet_ntop
 int         inet_pres_to_net( mart::nw::socks::Domain af, const char* src, void* dst );              // inet_pton
 
+// Index of the network interface with the given name (0 if there is none) - e.g. for ipv6 zone ids like "fe80::1%eth0"
+std::uint32_t interface_name_to_index( const char* name ) noexcept; // if_nametoindex
+// Writes the null terminated name of the interface into dst. Returns false, if there is no such interface
+bool interface_index_to_name( std::uint32_t index, char* dst, std::size_t size ) noexcept; // if_indextoname
+
 std::string to_string( const Sockaddr& addr );
 
 } // namespace port_layer
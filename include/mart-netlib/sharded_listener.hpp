@@ -0,0 +1,173 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_SHARDED_LISTENER_HPP
+#define LIB_MART_COMMON_GUARD_NW_SHARDED_LISTENER_HPP
+/**
+ * sharded_listener.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Distributes a single udp / tcp port over multiple sockets and worker threads via SO_REUSEPORT
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "tcp.hpp"
+#include "udp.hpp"
+
+#include <mart-netlib/network_exceptions.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip {
+
+struct ShardedListenerConfig {
+	// Number of sockets (and worker threads)
+	std::size_t shard_cnt = std::max( 1u, std::thread::hardware_concurrency() );
+	// Pin the worker thread of shard i to cpu i (modulo the number of cpus)
+	bool pin_threads = true;
+	// Let the kernel deliver packets / connections to the shard with the index of the cpu that processed
+	// them instead of using a flow hash (linux only). Works best with pin_threads and shard_cnt == number of cpus
+	bool cpu_steering = false;
+	// Receive timeout of the udp sockets - determines how fast the workers notice a stop request
+	std::chrono::milliseconds poll_interval{100};
+	// Listen backlog of each tcp acceptor
+	int backlog = 10;
+};
+
+namespace detail {
+
+// returns false, if the platform doesn't support thread affinity or the call failed
+bool pin_current_thread_to_cpu( unsigned cpu ) noexcept;
+
+template<class SocketT>
+struct sharded_socket_traits;
+
+// udp::Socket, udp::Socket6
+template<class EndpointT>
+struct sharded_socket_traits<socks::detail::DgramSocket<EndpointT>> {
+	using endpoint = EndpointT;
+
+	static void bind( socks::detail::DgramSocket<EndpointT>& socket, endpoint ep, const ShardedListenerConfig& config )
+	{
+		socket.set_rx_timeout( config.poll_interval );
+		socket.bind( ep );
+	}
+};
+
+// tcp::Acceptor, tcp::Acceptor6
+template<class EndpointT>
+struct sharded_socket_traits<tcp::BasicAcceptor<EndpointT>> {
+	using endpoint = EndpointT;
+
+	static void bind( tcp::BasicAcceptor<EndpointT>& socket, endpoint ep, const ShardedListenerConfig& config )
+	{
+		socket.bind( ep );
+		socket.listen( config.backlog );
+	}
+};
+
+} // namespace detail
+
+/*
+ * Opens config.shard_cnt sockets (udp::Socket[6] or tcp::Acceptor[6]) that are all bound to the same
+ * endpoint with SO_REUSEPORT, so the kernel load-balances incoming datagrams / connections between them.
+ * start() runs one worker thread per shard, which calls handler( shard_index, socket ) in a loop until
+ * stop() is called. The handler has to return periodically (udp sockets get config.poll_interval
+ * as receive timeout, for tcp use accept( timeout )) and must not throw.
+ *
+ * NOTE: The endpoint needs a fixed port - with port 0, each shard would end up on a different port
+ */
+template<class SocketT>
+class ShardedListener {
+	using traits_t = detail::sharded_socket_traits<SocketT>;
+
+public:
+	using socket_type = SocketT;
+	using endpoint    = typename traits_t::endpoint;
+
+	explicit ShardedListener( endpoint ep, const ShardedListenerConfig& config = {} )
+		: _config( config )
+	{
+		assert( _config.shard_cnt > 0 );
+		_shards.reserve( _config.shard_cnt );
+		for( std::size_t i = 0; i < _config.shard_cnt; ++i ) {
+			SocketT& socket = _shards.emplace_back();
+			socket.set_reuse_address( true );
+			socket.set_reuse_port( true );
+			traits_t::bind( socket, ep, _config );
+		}
+
+		if( _config.cpu_steering ) {
+			// the program is attached to the whole reuseport group, so any bound socket will do
+			const auto res
+				= socks::port_layer::attach_reuseport_cpu_steering( _shards.front().get_raw_socket_handle() );
+			if( !res ) {
+				throw generic_nw_error( tcp::make_error_message_with_appended_last_errno(
+					res, "Could not attach cpu steering program to reuseport group on ", ep.toStringEx() ) );
+			}
+		}
+	}
+
+	ShardedListener( const ShardedListener& ) = delete;
+	ShardedListener& operator=( const ShardedListener& ) = delete;
+
+	~ShardedListener() { stop(); }
+
+	template<class Handler>
+	void start( Handler handler )
+	{
+		assert( _workers.empty() );
+		_stop_requested = false;
+
+		const unsigned cpu_cnt = std::max( 1u, std::thread::hardware_concurrency() );
+		_workers.reserve( _shards.size() );
+		for( std::size_t i = 0; i < _shards.size(); ++i ) {
+			_workers.emplace_back( [this, i, cpu_cnt, handler]() mutable {
+				if( _config.pin_threads ) { detail::pin_current_thread_to_cpu( static_cast<unsigned>( i % cpu_cnt ) ); }
+				while( !_stop_requested.load( std::memory_order_relaxed ) ) {
+					handler( i, _shards[i] );
+				}
+			} );
+		}
+	}
+
+	// Requests the workers to stop and waits until they are finished
+	void stop()
+	{
+		_stop_requested = true;
+		for( auto& w : _workers ) {
+			w.join();
+		}
+		_workers.clear();
+	}
+
+	bool is_running() const noexcept { return !_workers.empty(); }
+
+	std::size_t    shard_cnt() const noexcept { return _shards.size(); }
+	SocketT&       shard( std::size_t idx ) { return _shards[idx]; }
+	const SocketT& shard( std::size_t idx ) const { return _shards[idx]; }
+
+private:
+	ShardedListenerConfig    _config;
+	std::vector<SocketT>     _shards;
+	std::vector<std::thread> _workers;
+	std::atomic<bool>        _stop_requested{false};
+};
+
+} // namespace mart::nw::ip
+
+#endif
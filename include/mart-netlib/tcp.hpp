@@ -19,6 +19,7 @@
 #include "RaiiSocket.hpp"
 #include "ip.hpp"
 
+#include "detail/error_message.hpp"
 #include "detail/socket_base.hpp"
 
 #include <mart-netlib/network_exceptions.hpp>
@@ -27,14 +28,18 @@
 #include <mart-common/ArrayView.h>
 
 /* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <string_view>
-
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
+#include <thread>
+#include <utility>
+#include <vector>
 
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -43,64 +48,60 @@ namespace nw {
 namespace ip {
 namespace tcp {
 
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
-{
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
-
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
-}
+using socks::detail::errno_nr_as_string;
+using socks::detail::make_error_message_with_appended_last_errno;
 
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
-{
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
-}
+using endpoint    = ip::basic_endpoint_v4<mart::nw::ip::TransportProtocol::Tcp>;
+using endpoint_v6 = ip::basic_endpoint_v6<mart::nw::ip::TransportProtocol::Tcp>;
+
+namespace detail {
 
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
+// remaining time until deadline in ms (rounded up), as expected by port_layer::poll
+inline int to_poll_timeout( std::chrono::steady_clock::time_point deadline ) noexcept
 {
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
+	const auto remaining = std::chrono::ceil<std::chrono::milliseconds>( deadline - std::chrono::steady_clock::now() );
+	return static_cast<int>(
+		std::clamp<std::chrono::milliseconds::rep>( remaining.count(), 0, std::numeric_limits<int>::max() ) );
 }
 
-using endpoint = ip::basic_endpoint_v4<mart::nw::ip::TransportProtocol::Tcp>;
+} // namespace detail
 
-class Acceptor;
-class Socket : public mart::nw::socks::detail::HighLevelSocketBase {
+/* BasicSocket and BasicAcceptor are templates over the endpoint type, so ipv4 and ipv6 sockets
+ * don't pay for each other (see the Socket/Acceptor and Socket6/Acceptor6 aliases below)
+ */
+template<class EndpointT>
+class BasicAcceptor;
+
+template<class EndpointT>
+class BasicSocket : public mart::nw::socks::detail::HighLevelSocketBase {
 public:
-	Socket()
-		: mart::nw::socks::detail::HighLevelSocketBase( socks::Domain::Inet, socks::TransportType::Stream )
+	using endpoint = EndpointT;
+
+	BasicSocket()
+		: mart::nw::socks::detail::HighLevelSocketBase( EndpointT::domain, socks::TransportType::Stream )
 	{
 	}
-	Socket( endpoint local, endpoint remote )
-		: Socket()
+	BasicSocket( endpoint local, endpoint remote )
+		: BasicSocket()
 	{
 		bind( local );
 		connect( remote );
 		// TODO: throw exception, if bind fails
 	}
-	Socket( Socket&& other ) noexcept
+	BasicSocket( BasicSocket&& other ) noexcept
 		: mart::nw::socks::detail::HighLevelSocketBase( std::move( other ) )
-		, _ep_local( std::move( other._ep_local ) )
-		, _ep_remote( std::move( other._ep_remote ) )
+		, _ep_local( std::exchange( other._ep_local, endpoint{} ) )
+		, _ep_remote( std::exchange( other._ep_remote, endpoint{} ) )
+		, _ep_local_state( other._ep_local_state.exchange( ep_local_ready, std::memory_order_relaxed ) )
 	{
-		other = Socket{};
 	}
-	Socket& operator=( Socket&& other ) noexcept
+	BasicSocket& operator=( BasicSocket&& other ) noexcept
 	{
 		mart::nw::socks::detail::HighLevelSocketBase::operator=( std::move( other ) );
 		_ep_local                                             = std::exchange( other._ep_local, endpoint{} );
 		_ep_remote                                            = std::exchange( other._ep_remote, endpoint{} );
+		_ep_local_state.store( other._ep_local_state.exchange( ep_local_ready, std::memory_order_relaxed ),
+							   std::memory_order_relaxed );
 		return *this;
 	}
 	void connect( endpoint ep )
@@ -132,10 +133,79 @@ public:
 		return true;
 	}
 
+	/* ###### Connecting with a deadline ###### */
+
+	/* Like connect, but gives up (with ErrorCodeValues::TimedOut) once the timeout expired, instead of waiting for
+	 * the os to give up on the handshake. The blocking mode of the socket is preserved.
+	 * If a handshake started by this call fails or times out, the socket gets closed (the handshake might still be in
+	 * progress, so it can't be used for another attempt). A socket that was already connected or connecting is left
+	 * as it is (IsConnected / AlreadyInProgress)
+	 */
+	socks::ErrorCode try_connect( endpoint ep, std::chrono::milliseconds timeout ) noexcept
+	{
+		const auto deadline     = std::chrono::steady_clock::now() + timeout;
+		const bool was_blocking = _socket.is_blocking();
+
+		bool started = false;
+		auto result  = _try_start_connect( ep, started );
+		while( result.value() == socks::ErrorCodeValues::InProgress ) {
+			socks::port_layer::PollEntry entry{ _socket.get_handle(), socks::port_layer::poll_out, 0 };
+
+			const auto ready = socks::port_layer::poll( &entry, 1, detail::to_poll_timeout( deadline ) );
+			if( !ready.success() ) {
+				if( ready.error_code().raw_value() == EINTR ) { continue; }
+				result = ready.error_code();
+			} else if( ready.value() > 0 ) {
+				result = try_finish_connect();
+			} else if( std::chrono::steady_clock::now() >= deadline ) {
+				result = socks::ErrorCode{ socks::ErrorCodeValues::TimedOut };
+			}
+		}
+		if( !result.success() && started ) {
+			_socket.close();
+			_ep_local  = endpoint{};
+			_ep_remote = endpoint{};
+			return result;
+		}
+		if( _socket.is_valid() ) { _socket.set_blocking( was_blocking ); }
+		return result;
+	}
+
+	void connect( endpoint ep, std::chrono::milliseconds timeout )
+	{
+		const auto result = try_connect( ep, timeout );
+		if( !result.success() ) {
+			throw generic_nw_error( make_error_message_with_appended_last_errno(
+				result, "Could not connect socket to address ", ep.toStringEx() ) );
+		}
+	}
+
+	/* Starts connecting without waiting for the handshake and switches the socket to non-blocking mode.
+	 * Returns ErrorCodeValues::InProgress if the connection is pending: Wait for the socket to become writable
+	 * (port_layer::poll with poll_out) and call try_finish_connect. Returns NoError if the connection was
+	 * established right away
+	 */
+	socks::ErrorCode try_start_connect( endpoint ep ) noexcept
+	{
+		bool started = false;
+		return _try_start_connect( ep, started );
+	}
+
+	// Returns the result of a connect started by try_start_connect (once the socket became writable)
+	socks::ErrorCode try_finish_connect() noexcept
+	{
+		const auto result = socks::port_layer::get_socket_error( _socket.get_handle() );
+		if( !result.success() ) { return result; }
+
+		auto t_ep = getSockAddress( _socket );
+		if( t_ep.result.success() ) { _ep_local = t_ep.ep; }
+		return t_ep.result;
+	}
+
 	void bind( endpoint ep )
 	{
 		assert( _socket.is_valid() );
-		auto result = _socket.bind( ep.toSockAddr_in() );
+		auto result = _socket.bind( ep.toSockAddr() );
 		if( !result.success() ) {
 			throw generic_nw_error( make_error_message_with_appended_last_errno(
 				result, "Could not bind tcp socket to address ", ep.toStringEx() ) );
@@ -155,6 +225,33 @@ public:
 		}
 	}
 
+	/* Sends all parts in as few system calls as possible without copying them into a staging buffer first */
+	void send( mart::ArrayView<const mart::ConstMemoryView> data )
+	{
+		if( data.size() > nw::socks::port_layer::max_io_buffer_cnt ) {
+			throw nw::generic_nw_error( "Failed to send data. Details: Too many buffers" );
+		}
+
+		std::array<mart::ConstMemoryView, nw::socks::port_layer::max_io_buffer_cnt> parts{};
+		std::copy( data.begin(), data.end(), parts.begin() );
+		mart::ArrayView<mart::ConstMemoryView> remaining( parts.data(), data.size() );
+
+		while( !remaining.empty() ) {
+			const auto res = _socket.send( remaining, 0 );
+			if( !res.success() ) {
+				throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+					res.error_code(), "Failed to send data. Details:  " ) );
+			}
+			// drop everything that has been sent already
+			auto sent = static_cast<std::size_t>( res.value() );
+			while( !remaining.empty() && sent >= remaining[0].size() ) {
+				sent -= remaining[0].size();
+				remaining = remaining.subview( 1 );
+			}
+			if( !remaining.empty() ) { remaining[0] = remaining[0].subview( sent ); }
+		}
+	}
+
 	template<class T, T... Vals>
 	bool is_none_of( T v )
 	{
@@ -176,10 +273,98 @@ public:
 		return res.received_data;
 	}
 
-	const endpoint& get_local_endpoint() const { return _ep_local; }
+	/* Distributes the received bytes over the buffers (in order) and returns the total number of received bytes */
+	std::size_t recv( mart::ArrayView<const mart::MemoryView> buffers )
+	{
+		using mart::nw::socks::ErrorCodeValues;
+		const auto res = _socket.recv( buffers, 0 );
+		if( !res
+			&& is_none_of<ErrorCodeValues,
+						  ErrorCodeValues::WouldBlock,
+						  ErrorCodeValues::TryAgain,
+						  ErrorCodeValues::Timeout>( res.error_code().value() ) ) {
+			throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+				res.error_code(), "Failed to receive data. Details:  " ) );
+		}
+		return static_cast<std::size_t>( res.value_or( 0 ) );
+	}
+
+	/* ###### Zero copy file transmission ###### */
+
+	static constexpr std::uint64_t to_end_of_file = std::numeric_limits<std::uint64_t>::max();
+
+	/* Sends a single chunk of the file without copying it through user space. Suitable for non-blocking sockets:
+	 * Returns the number of bytes sent (may be less than length, call again with the offset advanced accordingly),
+	 * 0 at the end of the file or an error (e.g. WouldBlock)
+	 */
+	socks::ReturnValue<socks::txrx_size_t>
+	try_send_file( socks::port_layer::file_handle_t file, std::uint64_t offset, std::uint64_t length ) noexcept
+	{
+		const auto count = static_cast<std::size_t>(
+			std::min<std::uint64_t>( length, socks::port_layer::max_send_file_chunk ) );
+		return _socket.send_file( file, offset, count );
+	}
+
+	/* Sends length bytes of the file starting at offset (or everything up to the end of the file) and returns
+	 * the number of bytes sent, which is only less than length, if the file is shorter
+	 */
+	std::uint64_t
+	send_file( socks::port_layer::file_handle_t file, std::uint64_t offset = 0, std::uint64_t length = to_end_of_file )
+	{
+		std::uint64_t sent = 0;
+		while( sent < length ) {
+			const auto res = try_send_file( file, offset + sent, length - sent );
+			if( !res.success() ) {
+				throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+					res.error_code(), "Failed to send file. Details:  " ) );
+			}
+			if( res.value() == 0 ) { break; }
+			sent += static_cast<std::uint64_t>( res.value() );
+		}
+		return sent;
+	}
+
+	std::uint64_t send_file( const mba::im_zstr& path, std::uint64_t offset = 0, std::uint64_t length = to_end_of_file )
+	{
+		const auto file = socks::port_layer::open_file_read_only( path.c_str() );
+		if( !file.success() ) {
+			throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+				file.error_code(), "Failed to open file ", path, " for sending. Details:  " ) );
+		}
+		struct FileCloser {
+			socks::port_layer::file_handle_t file;
+			~FileCloser() { socks::port_layer::close_file( file ); }
+		} const closer{file.value()};
+
+		return send_file( closer.file, offset, length );
+	}
+
+	// Can be called concurrently (the address of an accepted socket is determined by whoever asks first)
+	const endpoint& get_local_endpoint() const
+	{
+		if( _ep_local_state.load( std::memory_order_acquire ) != ep_local_ready ) { _resolve_local_endpoint(); }
+		return _ep_local;
+	}
 	const endpoint& get_remote_endpoint() const { return _ep_remote; }
 
 private:
+	// started: whether a new handshake was started (i.e. the socket wasn't already connected or connecting)
+	socks::ErrorCode _try_start_connect( endpoint ep, bool& started ) noexcept
+	{
+		const auto set_mode = _socket.set_blocking( false );
+		if( !set_mode.success() ) { return set_mode; }
+
+		const auto result = _socket.connect( ep.toSockAddr() );
+		started = result.value() != socks::ErrorCodeValues::IsConnected
+				  && result.value() != socks::ErrorCodeValues::AlreadyInProgress;
+		if( result.success() ) {
+			_ep_remote = ep;
+			return try_finish_connect();
+		}
+		if( result.value() == socks::ErrorCodeValues::InProgress ) { _ep_remote = ep; }
+		return result;
+	}
+
 	struct RetForGetSockAddress {
 		mart::net::socks::ErrorCode result;
 		endpoint                    ep;
@@ -188,7 +373,7 @@ private:
 	{
 		RetForGetSockAddress ret;
 
-		mart::net::socks::port_layer::SockaddrIn t_locaddr{};
+		typename EndpointT::abi_endpoint_type t_locaddr{};
 		ret.result = socket.getsockname( t_locaddr );
 
 		if( ret.result ) {
@@ -200,38 +385,65 @@ private:
 		return ret;
 	}
 
+	// accepted socket: only ask the os when someone is actually interested in the address
+	void _resolve_local_endpoint() const noexcept
+	{
+		int expected = ep_local_pending;
+		if( _ep_local_state.compare_exchange_strong( expected, ep_local_resolving, std::memory_order_acquire ) ) {
+			_ep_local = getSockAddress( _socket ).ep;
+			_ep_local_state.store( ep_local_ready, std::memory_order_release );
+			return;
+		}
+		// another thread is already asking the os
+		while( _ep_local_state.load( std::memory_order_acquire ) != ep_local_ready ) {
+			std::this_thread::yield();
+		}
+	}
+
 	static inline bool _txWasSuccess( mart::ConstMemoryView data, const mart::nw::socks::RaiiSocket::SendResult& ret )
 	{
 		return ret.result.success() && mart::narrow<nw::socks::txrx_size_t>( data.size() ) == ret.result.value();
 	}
 
-	Socket( net::socks::RaiiSocket&& sock, endpoint local, endpoint remote )
-		: mart::nw::socks::detail::HighLevelSocketBase( std::move( sock ) )
-		, _ep_local( local )
+	// used by the acceptor. The local endpoint is determined on first use
+	BasicSocket( net::socks::RaiiSocket&& sock, endpoint remote )
+		: mart::nw::socks::detail::HighLevelSocketBase( std::move( sock ), EndpointT::domain )
 		, _ep_remote( remote )
+		, _ep_local_state( ep_local_pending )
 	{
 	}
 
-	friend Acceptor;
-	endpoint _ep_local{};
-	endpoint _ep_remote{};
-};
+	// an invalid socket (e.g. if accept failed)
+	explicit BasicSocket( net::socks::RaiiSocket&& sock )
+		: mart::nw::socks::detail::HighLevelSocketBase( std::move( sock ), EndpointT::domain )
+	{
+	}
 
-inline Socket connect( endpoint ep )
-{
-	Socket s;
-	s.connect( ep );
-	return s;
-}
+	friend class BasicAcceptor<EndpointT>;
+
+	enum : int { ep_local_ready, ep_local_pending, ep_local_resolving };
 
-class Acceptor {
+	mutable endpoint         _ep_local{};
+	endpoint                 _ep_remote{};
+	mutable std::atomic<int> _ep_local_state{ ep_local_ready };
+};
+
+/* Besides the timeouts and blocking mode, the socket options from HighLevelSocketBase
+ * (buffer sizes, no delay, priority ...) are inherited by the accepted sockets.
+ * Options that affect binding (reuse address/port) have to be set before calling bind
+ */
+template<class EndpointT>
+class BasicAcceptor : public mart::nw::socks::detail::HighLevelSocketBase {
 	enum class State { open, bound, listening };
 
 public:
-	Acceptor()
-		: _socket_handle( socks::Domain::Inet, socks::TransportType::Stream )
+	using endpoint    = EndpointT;
+	using socket_type = BasicSocket<EndpointT>;
+
+	BasicAcceptor()
+		: mart::nw::socks::detail::HighLevelSocketBase( EndpointT::domain, socks::TransportType::Stream )
 	{
-		if( !_socket_handle.is_valid() ) {
+		if( !_socket.is_valid() ) {
 			// TODO: The creation of this exception message seems to be pretty costly in terms of binary size - have to
 			// investigate NOTE: Preliminary tests suggest, that the dynamic memory allocation for the message text
 			// could be the main problem, but that is just a possibility
@@ -240,24 +452,23 @@ public:
 		}
 	}
 
-	Acceptor( Acceptor&& other ) noexcept
-		: _socket_handle( std::move( other._socket_handle ) )
-		, _ep_local( std::move( other._ep_local ) )
-		, _state( other._state )
+	BasicAcceptor( BasicAcceptor&& other ) noexcept
+		: mart::nw::socks::detail::HighLevelSocketBase( std::move( other ) )
+		, _ep_local( std::exchange( other._ep_local, endpoint{} ) )
+		, _state( std::exchange( other._state, State::open ) )
 	{
-		other = Acceptor{};
 	}
-	Acceptor& operator=( Acceptor&& other ) noexcept
+	BasicAcceptor& operator=( BasicAcceptor&& other ) noexcept
 	{
-		_socket_handle  = std::move( other._socket_handle );
-		_ep_local       = std::move( other._ep_local );
-		other._ep_local = endpoint{};
+		mart::nw::socks::detail::HighLevelSocketBase::operator=( std::move( other ) );
+		_ep_local       = std::exchange( other._ep_local, endpoint{} );
+		_state    = std::exchange( other._state, State::open );
 		return *this;
 	}
 
 	// will create acceptor bound to endpoint and listening for incomming connections
-	Acceptor( endpoint local, int backlog = 10 )
-		: Acceptor::Acceptor()
+	BasicAcceptor( endpoint local, int backlog = 10 )
+		: BasicAcceptor()
 	{
 		bind( local );
 		listen( backlog );
@@ -268,7 +479,7 @@ public:
 	{
 		assert( _state == State::open );
 
-		auto result = _socket_handle.bind( ep.toSockAddr_in() );
+		auto result = _socket.bind( ep.toSockAddr() );
 		if( !result.success() ) {
 			throw generic_nw_error( make_error_message_with_appended_last_errno(
 				result, "Could not bind tcp acceptor to address ", ep.toStringEx() ) );
@@ -282,7 +493,7 @@ public:
 	{
 		assert( _state == State::open );
 
-		auto result = _socket_handle.bind( ep.toSockAddr_in() );
+		auto result = _socket.bind( ep.toSockAddr() );
 		if( !result.success() ) { return false; }
 
 		_ep_local = ep;
@@ -294,7 +505,7 @@ public:
 	{
 		assert( _state == State::bound );
 
-		auto result = _socket_handle.listen( backlog );
+		auto result = _socket.listen( backlog );
 		if( !result.success() ) {
 			throw generic_nw_error( make_error_message_with_appended_last_errno(
 				result, "Tcp acceptor could not start to listen on address ", _ep_local.toStringEx() ) );
@@ -306,63 +517,215 @@ public:
 	{
 		assert( _state == State::bound );
 
-		auto result = _socket_handle.listen( backlog );
+		auto result = _socket.listen( backlog );
 		if( !result.success() ) { return false; }
 		_state = State::listening;
 		return true;
 	}
 
-	bool is_valid() { return _socket_handle.is_valid(); }
-
 public:
-	Socket try_accept()
+	/* All accept functions keep the mode of the listening socket (blocking / timeout) sticky and only touch it
+	 * if it actually changes between calls (RaiiSocket caches both, so this also holds if the timeouts are changed
+	 * through set_rx_timeout / set_tx_timeout in between). If no connection could be accepted, they return an
+	 * invalid socket.
+	 * The local endpoint of an accepted socket is only queried when get_local_endpoint is called
+	 */
+
+	// Returns immediately if no connection is pending
+	socket_type try_accept()
+	{
+		assert( _state == State::listening );
+		_socket.set_blocking( false );
+		socks::ErrorCode error{};
+		return _accept_one( false, error );
+	}
+
+	socket_type accept( std::chrono::microseconds timeout = std::chrono::hours( 300 ) )
 	{
 		assert( _state == State::listening );
-		_socket_handle.set_blocking( false );
+		_socket.set_blocking( true );
+		// NOTE: the timeouts are also inherited by the accepted sockets
+		_socket.set_rx_timeout( timeout );
+		_socket.set_tx_timeout( timeout );
+		socks::ErrorCode error{};
+		return _accept_one( false, error );
+	}
 
-		mart::net::socks::port_layer::SockaddrIn addr;
+	struct AcceptPendingResult {
+		std::size_t      accepted = 0;
+		socks::ErrorCode error{ socks::ErrorCodeValues::NoError }; // why accepting stopped (NoError: nothing pending)
+	};
 
-		auto sock = _socket_handle.accept( addr );
-		auto res  = Socket::getSockAddress( sock );
-		if( sock.is_valid() && res.result.success() ) {
-			return Socket( std::move( sock ), res.ep, endpoint( addr ) );
-		} else {
-			return {};
+	/* Accepts all pending connections (without blocking) and appends them to sockets.
+	 * Stops at the first error (e.g. if the process ran out of file descriptors), which is reported in the result
+	 */
+	AcceptPendingResult accept_pending( std::vector<socket_type>& sockets, bool non_blocking_sockets = false )
+	{
+		assert( _state == State::listening );
+		_socket.set_blocking( false );
+
+		AcceptPendingResult ret;
+		while( true ) {
+			auto s = _accept_one( non_blocking_sockets, ret.error );
+			if( !s.is_valid() ) { break; }
+			sockets.push_back( std::move( s ) );
+			++ret.accepted;
+		}
+		using socks::ErrorCodeValues;
+		if( ret.error.value() == ErrorCodeValues::WouldBlock || ret.error.value() == ErrorCodeValues::TryAgain ) {
+			ret.error = socks::ErrorCode{ ErrorCodeValues::NoError };
 		}
+		return ret;
 	}
 
-	Socket accept( std::chrono::microseconds timeout = std::chrono::hours( 300 ) )
+	nw::socks::RaiiSocket& getSocket() { return _socket; }
+
+	endpoint getLocalEndpoint() const { return _ep_local; }
+
+private:
+	socket_type _accept_one( bool non_blocking, socks::ErrorCode& error )
 	{
-		_socket_handle.set_blocking( true );
-		_socket_handle.set_rx_timeout( timeout );
-		_socket_handle.set_tx_timeout( timeout );
+		typename EndpointT::abi_endpoint_type addr;
+
+		auto sock = _socket.accept4( addr, non_blocking, error );
+		if( !sock.is_valid() ) { return socket_type( std::move( sock ) ); }
+		return socket_type( std::move( sock ), endpoint( addr ) );
+	}
+
+	endpoint _ep_local{};
+	State    _state = State::open;
+};
+
+using Socket    = BasicSocket<endpoint>;
+using Acceptor  = BasicAcceptor<endpoint>;
+using Socket6   = BasicSocket<endpoint_v6>;
+using Acceptor6 = BasicAcceptor<endpoint_v6>;
+
+inline Socket connect( endpoint ep )
+{
+	Socket s;
+	s.connect( ep );
+	return s;
+}
 
-		mart::net::socks::port_layer::SockaddrIn addr;
+inline Socket6 connect( endpoint_v6 ep )
+{
+	Socket6 s;
+	s.connect( ep );
+	return s;
+}
 
-		auto sock = _socket_handle.accept( addr );
-		auto res  = Socket::getSockAddress( sock );
-		if( sock.is_valid() && res.result.success() ) {
-			return Socket( std::move( sock ), res.ep, endpoint( addr ) );
+inline Socket connect( endpoint ep, std::chrono::milliseconds timeout )
+{
+	Socket s;
+	s.connect( ep, timeout );
+	return s;
+}
+
+inline Socket6 connect( endpoint_v6 ep, std::chrono::milliseconds timeout )
+{
+	Socket6 s;
+	s.connect( ep, timeout );
+	return s;
+}
+
+template<class EndpointT>
+struct ConnectResult {
+	BasicSocket<EndpointT> socket; // closed, if the connect failed
+	socks::ErrorCode       error;
+};
+
+namespace detail {
+
+template<class EndpointT>
+std::vector<ConnectResult<EndpointT>> connect_all( mart::ArrayView<const EndpointT> endpoints,
+												   std::chrono::milliseconds        timeout )
+{
+	using namespace socks::port_layer;
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	std::vector<ConnectResult<EndpointT>> results( endpoints.size() );
+	std::vector<PollEntry>                pending;
+	std::vector<std::size_t>              pending_idx;
+
+	for( std::size_t i = 0; i < endpoints.size(); ++i ) {
+		auto& socket     = results[i].socket;
+		results[i].error = socket.is_valid() ? socket.try_start_connect( endpoints[i] ) : get_last_socket_error();
+		if( results[i].error.value() == socks::ErrorCodeValues::InProgress ) {
+			pending.push_back( PollEntry{ socket.get_raw_socket_handle(), poll_out, 0 } );
+			pending_idx.push_back( i );
+		}
+	}
+
+	while( !pending.empty() ) {
+		const auto ready = socks::port_layer::poll( pending.data(), pending.size(), to_poll_timeout( deadline ) );
+		if( !ready.success() && ready.error_code().raw_value() != EINTR ) {
+			for( auto idx : pending_idx ) {
+				results[idx].error = ready.error_code();
+			}
+			break;
+		}
+		if( ready.value_or( 0 ) == 0 ) {
+			if( std::chrono::steady_clock::now() >= deadline ) { break; }
+			continue;
+		}
+
+		// finish the completed connects and drop them from the poll set
+		std::size_t still_pending = 0;
+		for( std::size_t j = 0; j < pending.size(); ++j ) {
+			if( pending[j].revents != 0 ) {
+				results[pending_idx[j]].error = results[pending_idx[j]].socket.try_finish_connect();
+			} else {
+				pending[still_pending]     = pending[j];
+				pending_idx[still_pending] = pending_idx[j];
+				++still_pending;
+			}
+		}
+		pending.resize( still_pending );
+		pending_idx.resize( still_pending );
+	}
+
+	for( auto& r : results ) {
+		if( r.error.value() == socks::ErrorCodeValues::InProgress ) {
+			r.error = socks::ErrorCode{ socks::ErrorCodeValues::TimedOut };
+		}
+		if( r.error.success() ) {
+			r.socket.set_blocking( true );
 		} else {
-			return {};
+			r.socket.close();
 		}
 	}
+	return results;
+}
 
-	nw::socks::RaiiSocket& getSocket() { return _socket_handle; }
+} // namespace detail
 
-	endpoint getLocalEndpoint() const { return _ep_local; }
+/* Connects to all endpoints concurrently: The connects are started together and their completion is awaited with
+ * a single poll set. So the whole call takes as long as the slowest peer (at most timeout), instead of the sum of all
+ * handshakes. The results are in the order of the endpoints, the connected sockets are in blocking mode
+ */
+inline std::vector<ConnectResult<endpoint>> connect_all( mart::ArrayView<const endpoint> endpoints,
+														 std::chrono::milliseconds       timeout )
+{
+	return detail::connect_all( endpoints, timeout );
+}
 
-private:
-	nw::socks::RaiiSocket _socket_handle;
-	endpoint              _ep_local{};
-	State                 _state = State::open;
-};
+inline std::vector<ConnectResult<endpoint_v6>> connect_all( mart::ArrayView<const endpoint_v6> endpoints,
+															std::chrono::milliseconds          timeout )
+{
+	return detail::connect_all( endpoints, timeout );
+}
 
 inline std::optional<endpoint> parse_v4_endpoint( std::string_view str )
 {
 	return ip::try_parse_v4_endpoint<ip::TransportProtocol::Tcp>( str );
 }
 
+inline std::optional<endpoint_v6> parse_v6_endpoint( std::string_view str )
+{
+	return ip::try_parse_v6_endpoint<ip::TransportProtocol::Tcp>( str );
+}
+
 } // namespace tcp
 
 } // namespace ip
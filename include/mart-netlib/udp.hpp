@@ -26,23 +26,31 @@
 namespace mart::nw {
 namespace ip::udp {
 
-using endpoint = ip::basic_endpoint_v4<mart::nw::ip::TransportProtocol::Udp>;
+using endpoint    = ip::basic_endpoint_v4<mart::nw::ip::TransportProtocol::Udp>;
+using endpoint_v6 = ip::basic_endpoint_v6<mart::nw::ip::TransportProtocol::Udp>;
 
 constexpr std::optional<endpoint> try_parse_v4_endpoint( std::string_view str ) noexcept
 {
 	return mart::nw::ip::try_parse_v4_endpoint<mart::nw::ip::TransportProtocol::Udp>( str );
 }
 
+inline std::optional<endpoint_v6> try_parse_v6_endpoint( std::string_view str ) noexcept
+{
+	return mart::nw::ip::try_parse_v6_endpoint<mart::nw::ip::TransportProtocol::Udp>( str );
+}
+
 } // namespace ip::udp
 } // namespace mart::nw
 
 namespace mart::nw::socks::detail {
 extern template class DgramSocket<mart::nw::ip::udp::endpoint>;
+extern template class DgramSocket<mart::nw::ip::udp::endpoint_v6>;
 }
 
 namespace mart::nw {
 namespace ip::udp {
-using Socket = mart::nw::socks::detail::DgramSocket<endpoint>;
+using Socket  = mart::nw::socks::detail::DgramSocket<endpoint>;
+using Socket6 = mart::nw::socks::detail::DgramSocket<endpoint_v6>;
 } // namespace ip::udp
 } // namespace mart::nw
 
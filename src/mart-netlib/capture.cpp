@@ -0,0 +1,589 @@
+#include <mart-netlib/capture.hpp>
+
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <im_str/im_str.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined( _WIN32 )
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mart::nw::ip::udp {
+
+namespace {
+
+constexpr char          file_magic[8] = {'M', 'A', 'R', 'T', 'C', 'A', 'P', '\0'};
+constexpr std::uint32_t file_version  = 1;
+
+struct FileHeader {
+	char          magic[8];
+	std::uint32_t version;
+	std::uint32_t header_size;
+	std::uint64_t record_cnt;
+	std::uint64_t index_offset;
+	std::uint64_t index_capacity;
+	std::uint64_t data_offset;
+	std::uint64_t data_end;
+	std::uint64_t reserved;
+};
+static_assert( sizeof( FileHeader ) == 64 );
+
+struct RecordHeader {
+	std::int64_t  timestamp_ns; // since the epoch of system_clock
+	std::uint32_t address;      // host byte order
+	std::uint16_t port;         // host byte order
+	std::uint16_t flags;
+	std::uint32_t size;
+	std::uint32_t reserved;
+};
+static_assert( sizeof( RecordHeader ) == 24 );
+
+constexpr std::uint16_t flag_kernel_timestamp = 0x1;
+
+constexpr std::uint64_t round_up_to_8( std::uint64_t v ) noexcept
+{
+	return ( v + 7 ) & ~std::uint64_t{7};
+}
+
+// The mapping is only guaranteed to be 8 byte aligned for our purposes, so go through memcpy
+template<class T>
+T load( const unsigned char* src ) noexcept
+{
+	T ret;
+	std::memcpy( &ret, src, sizeof( T ) );
+	return ret;
+}
+
+template<class T>
+void store( unsigned char* dst, const T& value ) noexcept
+{
+	std::memcpy( dst, &value, sizeof( T ) );
+}
+
+std::string last_os_error_text()
+{
+#if defined( _WIN32 )
+	return "Windows error " + std::to_string( ::GetLastError() );
+#else
+	return std::strerror( errno );
+#endif
+}
+
+[[noreturn]] void throw_file_error( std::string_view action, std::string_view file_name )
+{
+	const auto text = last_os_error_text();
+	throw generic_nw_error( mba::concat( action, " capture file \"", file_name, "\": ", text ) );
+}
+
+socks::ErrorCode make_error( int native ) noexcept
+{
+	return socks::ErrorCode{static_cast<socks::ErrorCode::Value_t>( native )};
+}
+
+} // namespace
+
+namespace detail {
+
+/*
+ * A file mapped into memory in its entirety
+ */
+class MappedFile {
+public:
+	// Creates (or truncates) the file with the given size and maps it read/write
+	static std::unique_ptr<MappedFile> create( std::string_view file_name, std::uint64_t size, bool prefault );
+	// Maps an existing file read only
+	static std::unique_ptr<MappedFile> open_read_only( std::string_view file_name );
+
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+	~MappedFile() { close( _size ); }
+
+	unsigned char*       data() noexcept { return _data; }
+	const unsigned char* data() const noexcept { return _data; }
+	std::uint64_t        size() const noexcept { return _size; }
+
+	void flush() noexcept;
+	// unmaps and closes the file. If the file is writable, it is truncated to final_size
+	void close( std::uint64_t final_size ) noexcept;
+
+private:
+	MappedFile() = default;
+
+	unsigned char* _data     = nullptr;
+	std::uint64_t  _size     = 0;
+	bool           _writable = false;
+#if defined( _WIN32 )
+	HANDLE _file    = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+#else
+	int _fd = -1;
+#endif
+};
+
+#if defined( _WIN32 )
+
+std::unique_ptr<MappedFile> MappedFile::create( std::string_view file_name, std::uint64_t size, bool )
+{
+	std::unique_ptr<MappedFile> ret( new MappedFile() );
+	ret->_writable = true;
+
+	const std::string name( file_name );
+	ret->_file = ::CreateFileA(
+		name.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( ret->_file == INVALID_HANDLE_VALUE ) { throw_file_error( "Could not create", file_name ); }
+
+	LARGE_INTEGER li{};
+	li.QuadPart = static_cast<LONGLONG>( size );
+	if( !::SetFilePointerEx( ret->_file, li, nullptr, FILE_BEGIN ) || !::SetEndOfFile( ret->_file ) ) {
+		throw_file_error( "Could not allocate", file_name );
+	}
+
+	ret->_mapping = ::CreateFileMappingA( ret->_file,
+										  nullptr,
+										  PAGE_READWRITE,
+										  static_cast<DWORD>( size >> 32 ),
+										  static_cast<DWORD>( size & 0xFFFF'FFFF ),
+										  nullptr );
+	if( ret->_mapping == nullptr ) { throw_file_error( "Could not map", file_name ); }
+
+	ret->_data = static_cast<unsigned char*>( ::MapViewOfFile( ret->_mapping, FILE_MAP_WRITE, 0, 0, 0 ) );
+	if( ret->_data == nullptr ) { throw_file_error( "Could not map", file_name ); }
+	ret->_size = size;
+	return ret;
+}
+
+std::unique_ptr<MappedFile> MappedFile::open_read_only( std::string_view file_name )
+{
+	std::unique_ptr<MappedFile> ret( new MappedFile() );
+
+	const std::string name( file_name );
+	ret->_file = ::CreateFileA(
+		name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if( ret->_file == INVALID_HANDLE_VALUE ) { throw_file_error( "Could not open", file_name ); }
+
+	LARGE_INTEGER li{};
+	if( !::GetFileSizeEx( ret->_file, &li ) ) { throw_file_error( "Could not read the size of", file_name ); }
+	if( li.QuadPart == 0 ) { return ret; }
+
+	ret->_mapping = ::CreateFileMappingA( ret->_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( ret->_mapping == nullptr ) { throw_file_error( "Could not map", file_name ); }
+
+	ret->_data = static_cast<unsigned char*>( ::MapViewOfFile( ret->_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+	if( ret->_data == nullptr ) { throw_file_error( "Could not map", file_name ); }
+	ret->_size = static_cast<std::uint64_t>( li.QuadPart );
+	return ret;
+}
+
+void MappedFile::flush() noexcept
+{
+	if( _data ) { ::FlushViewOfFile( _data, 0 ); }
+}
+
+void MappedFile::close( std::uint64_t final_size ) noexcept
+{
+	if( _data ) { ::UnmapViewOfFile( _data ); }
+	if( _mapping ) { ::CloseHandle( _mapping ); }
+	if( _file != INVALID_HANDLE_VALUE ) {
+		if( _writable && final_size < _size ) {
+			LARGE_INTEGER li{};
+			li.QuadPart = static_cast<LONGLONG>( final_size );
+			if( ::SetFilePointerEx( _file, li, nullptr, FILE_BEGIN ) ) { ::SetEndOfFile( _file ); }
+		}
+		::CloseHandle( _file );
+	}
+	_data    = nullptr;
+	_mapping = nullptr;
+	_file    = INVALID_HANDLE_VALUE;
+	_size    = 0;
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::create( std::string_view file_name, std::uint64_t size, bool prefault )
+{
+	std::unique_ptr<MappedFile> ret( new MappedFile() );
+	ret->_writable = true;
+
+	const std::string name( file_name );
+	ret->_fd = ::open( name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+	if( ret->_fd < 0 ) { throw_file_error( "Could not create", file_name ); }
+
+	if( ::ftruncate( ret->_fd, static_cast<off_t>( size ) ) != 0 ) {
+		throw_file_error( "Could not allocate", file_name );
+	}
+#if defined( __linux__ )
+	// Reserve the disk space now - otherwise running out of space would only show up as SIGBUS while capturing.
+	// Not all file systems support this, so that is not an error
+	if( const int res = ::posix_fallocate( ret->_fd, 0, static_cast<off_t>( size ) );
+		res != 0 && res != EOPNOTSUPP && res != EINVAL ) {
+		errno = res;
+		throw_file_error( "Could not allocate", file_name );
+	}
+#endif
+
+	int flags = MAP_SHARED;
+#if defined( MAP_POPULATE )
+	if( prefault ) { flags |= MAP_POPULATE; }
+#else
+	(void)prefault;
+#endif
+	void* const data = ::mmap( nullptr, static_cast<std::size_t>( size ), PROT_READ | PROT_WRITE, flags, ret->_fd, 0 );
+	if( data == MAP_FAILED ) { throw_file_error( "Could not map", file_name ); }
+
+	ret->_data = static_cast<unsigned char*>( data );
+	ret->_size = size;
+	return ret;
+}
+
+std::unique_ptr<MappedFile> MappedFile::open_read_only( std::string_view file_name )
+{
+	std::unique_ptr<MappedFile> ret( new MappedFile() );
+
+	const std::string name( file_name );
+	ret->_fd = ::open( name.c_str(), O_RDONLY | O_CLOEXEC );
+	if( ret->_fd < 0 ) { throw_file_error( "Could not open", file_name ); }
+
+	struct stat info {
+	};
+	if( ::fstat( ret->_fd, &info ) != 0 ) { throw_file_error( "Could not read the size of", file_name ); }
+	if( info.st_size == 0 ) { return ret; }
+
+	const auto  size = static_cast<std::size_t>( info.st_size );
+	void* const data = ::mmap( nullptr, size, PROT_READ, MAP_SHARED, ret->_fd, 0 );
+	if( data == MAP_FAILED ) { throw_file_error( "Could not map", file_name ); }
+	// replays read the file front to back
+	::posix_madvise( data, size, POSIX_MADV_SEQUENTIAL );
+
+	ret->_data = static_cast<unsigned char*>( data );
+	ret->_size = size;
+	return ret;
+}
+
+void MappedFile::flush() noexcept
+{
+	if( _data ) { ::msync( _data, static_cast<std::size_t>( _size ), MS_ASYNC ); }
+}
+
+void MappedFile::close( std::uint64_t final_size ) noexcept
+{
+	if( _data ) { ::munmap( _data, static_cast<std::size_t>( _size ) ); }
+	if( _fd >= 0 ) {
+		if( _writable && final_size < _size ) { (void)::ftruncate( _fd, static_cast<off_t>( final_size ) ); }
+		::close( _fd );
+	}
+	_data = nullptr;
+	_fd   = -1;
+	_size = 0;
+}
+
+#endif
+
+} // namespace detail
+
+/* ###### CaptureWriter ###### */
+
+CaptureWriter::CaptureWriter( std::string_view file_name, const CaptureConfig& config )
+	: _config( config )
+{
+	const std::uint64_t data_offset = sizeof( FileHeader ) + config.max_datagrams * sizeof( std::uint64_t );
+	if( config.max_datagrams == 0 || config.capacity_bytes < data_offset + sizeof( RecordHeader ) ) {
+		throw generic_nw_error( mba::concat( "Capacity of capture file \"", file_name, "\" is too small" ) );
+	}
+	if( config.max_datagram_size > std::numeric_limits<std::uint32_t>::max() ) {
+		throw generic_nw_error( mba::concat( "Maximal datagram size for capture file \"", file_name, "\" is too big" ) );
+	}
+
+	_file = detail::MappedFile::create( file_name, config.capacity_bytes, config.prefault );
+
+	FileHeader header{};
+	std::memcpy( header.magic, file_magic, sizeof( file_magic ) );
+	header.version        = file_version;
+	header.header_size    = sizeof( FileHeader );
+	header.record_cnt     = 0;
+	header.index_offset   = sizeof( FileHeader );
+	header.index_capacity = config.max_datagrams;
+	header.data_offset    = data_offset;
+	header.data_end       = data_offset;
+	store( _file->data(), header );
+
+	_data_end = data_offset;
+}
+
+CaptureWriter::CaptureWriter( CaptureWriter&& other ) noexcept
+	: _file( std::move( other._file ) )
+	, _config( other._config )
+	, _record_cnt( other._record_cnt )
+	, _data_end( other._data_end )
+{
+}
+
+CaptureWriter& CaptureWriter::operator=( CaptureWriter&& other ) noexcept
+{
+	if( this != &other ) {
+		close();
+		_file       = std::move( other._file );
+		_config     = other._config;
+		_record_cnt = other._record_cnt;
+		_data_end   = other._data_end;
+	}
+	return *this;
+}
+
+CaptureWriter::~CaptureWriter()
+{
+	close();
+}
+
+bool CaptureWriter::is_full() const noexcept
+{
+	return _record_cnt >= _config.max_datagrams
+		   || _data_end + sizeof( RecordHeader ) + _config.max_datagram_size > _config.capacity_bytes;
+}
+
+unsigned char* CaptureWriter::_reserve_record( std::size_t max_payload_size ) noexcept
+{
+	if( !_file || _record_cnt >= _config.max_datagrams
+		|| _data_end + sizeof( RecordHeader ) + max_payload_size > _config.capacity_bytes ) {
+		return nullptr;
+	}
+	return _file->data() + _data_end;
+}
+
+void CaptureWriter::_commit_record( unsigned char* record, const CapturedDatagram& datagram ) noexcept
+{
+	RecordHeader header{};
+	header.timestamp_ns
+		= std::chrono::duration_cast<std::chrono::nanoseconds>( datagram.timestamp.time_since_epoch() ).count();
+	header.address = datagram.source.address.inHostOrder();
+	header.port    = datagram.source.port.inHostOrder();
+	header.flags   = datagram.kernel_timestamp ? flag_kernel_timestamp : 0;
+	header.size    = static_cast<std::uint32_t>( datagram.data.size() );
+	store( record, header );
+
+	unsigned char* const base = _file->data();
+	store( base + sizeof( FileHeader ) + _record_cnt * sizeof( std::uint64_t ), _data_end );
+
+	_data_end += sizeof( RecordHeader ) + round_up_to_8( datagram.data.size() );
+	++_record_cnt;
+	store( base + offsetof( FileHeader, data_end ), _data_end );
+	store( base + offsetof( FileHeader, record_cnt ), _record_cnt );
+}
+
+socks::ErrorCode CaptureWriter::try_capture( Socket& socket ) noexcept
+{
+	unsigned char* const record = _reserve_record( _config.max_datagram_size );
+	if( !record ) { return make_error( ENOSPC ); }
+
+	socks::ErrorCode error{};
+	const auto       res
+		= socket.try_recvfrom( mart::MemoryView( record + sizeof( RecordHeader ), _config.max_datagram_size ), error );
+	if( !error ) { return error; }
+
+	_commit_record( record,
+					CapturedDatagram{res.rx_timestamp.value_or( std::chrono::system_clock::now() ),
+									 res.remote_address,
+									 res.data,
+									 res.rx_timestamp.has_value()} );
+	return {};
+}
+
+bool CaptureWriter::capture( Socket& socket )
+{
+	unsigned char* const record = _reserve_record( _config.max_datagram_size );
+	if( !record ) { throw generic_nw_error( "Capture file is full" ); }
+
+	// throws on anything but timeouts
+	const auto res = socket.recvfrom( mart::MemoryView( record + sizeof( RecordHeader ), _config.max_datagram_size ) );
+	if( !res.data.isValid() ) { return false; }
+
+	_commit_record( record,
+					CapturedDatagram{res.rx_timestamp.value_or( std::chrono::system_clock::now() ),
+									 res.remote_address,
+									 res.data,
+									 res.rx_timestamp.has_value()} );
+	return true;
+}
+
+bool CaptureWriter::try_append( const CapturedDatagram& datagram ) noexcept
+{
+	if( datagram.data.size() > std::numeric_limits<std::uint32_t>::max() ) { return false; }
+
+	unsigned char* const record = _reserve_record( datagram.data.size() );
+	if( !record ) { return false; }
+
+	if( datagram.data.size() != 0 ) {
+		std::memcpy( record + sizeof( RecordHeader ), datagram.data.data(), datagram.data.size() );
+	}
+	_commit_record( record, datagram );
+	return true;
+}
+
+void CaptureWriter::flush() noexcept
+{
+	if( _file ) { _file->flush(); }
+}
+
+void CaptureWriter::close() noexcept
+{
+	if( !_file ) { return; }
+	_file->close( _data_end );
+	_file.reset();
+}
+
+/* ###### CaptureReader ###### */
+
+CaptureReader::CaptureReader( std::string_view file_name )
+	: _file( detail::MappedFile::open_read_only( file_name ) )
+{
+	const auto invalid = [&]() {
+		return generic_nw_error( mba::concat( "\"", file_name, "\" is not a valid capture file" ) );
+	};
+
+	if( _file->size() < sizeof( FileHeader ) ) { throw invalid(); }
+
+	const auto header = load<FileHeader>( _file->data() );
+	if( std::memcmp( header.magic, file_magic, sizeof( file_magic ) ) != 0 || header.version != file_version
+		|| header.header_size != sizeof( FileHeader ) ) {
+		throw invalid();
+	}
+
+	const std::uint64_t file_size = _file->size();
+	if( header.record_cnt > header.index_capacity || header.index_offset < sizeof( FileHeader )
+		|| header.index_capacity > ( file_size - header.index_offset ) / sizeof( std::uint64_t )
+		|| header.data_offset < header.index_offset + header.index_capacity * sizeof( std::uint64_t )
+		|| header.data_end < header.data_offset || header.data_end > file_size ) {
+		throw invalid();
+	}
+
+	// so operator[] doesn't have to check the offsets
+	const unsigned char* const index = _file->data() + header.index_offset;
+	for( std::uint64_t i = 0; i < header.record_cnt; ++i ) {
+		const auto offset = load<std::uint64_t>( index + i * sizeof( std::uint64_t ) );
+		if( offset < header.data_offset || offset > header.data_end - sizeof( RecordHeader ) || offset % 8 != 0 ) {
+			throw invalid();
+		}
+	}
+
+	_index      = reinterpret_cast<const std::uint64_t*>( index );
+	_record_cnt = static_cast<std::size_t>( header.record_cnt );
+	_data_end   = header.data_end;
+}
+
+CaptureReader::CaptureReader( CaptureReader&& other ) noexcept = default;
+CaptureReader& CaptureReader::operator=( CaptureReader&& other ) noexcept = default;
+CaptureReader::~CaptureReader()                                           = default;
+
+CapturedDatagram CaptureReader::operator[]( std::size_t idx ) const noexcept
+{
+	assert( idx < _record_cnt );
+
+	const unsigned char* const base   = _file->data();
+	const auto                 offset = load<std::uint64_t>( reinterpret_cast<const unsigned char*>( _index + idx ) );
+	const auto                 header = load<RecordHeader>( base + offset );
+
+	// don't trust the size field of a damaged file
+	const auto size = std::min<std::uint64_t>( header.size, _data_end - offset - sizeof( RecordHeader ) );
+
+	return CapturedDatagram{
+		std::chrono::system_clock::time_point( std::chrono::duration_cast<std::chrono::system_clock::duration>(
+			std::chrono::nanoseconds( header.timestamp_ns ) ) ),
+		endpoint( address_v4( uint32_host_t{header.address} ), port_nr( header.port ) ),
+		mart::ConstMemoryView( base + offset + sizeof( RecordHeader ), static_cast<std::size_t>( size ) ),
+		( header.flags & flag_kernel_timestamp ) != 0};
+}
+
+CapturedDatagram CaptureReader::at( std::size_t idx ) const
+{
+	if( idx >= _record_cnt ) { throw std::out_of_range( "Index into capture file out of range" ); }
+	return ( *this )[idx];
+}
+
+std::size_t CaptureReader::lower_bound( std::chrono::system_clock::time_point t ) const noexcept
+{
+	std::size_t first = 0;
+	std::size_t count = _record_cnt;
+	while( count > 0 ) {
+		const std::size_t step = count / 2;
+		const std::size_t mid  = first + step;
+		if( ( *this )[mid].timestamp < t ) {
+			first = mid + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
+/* ###### Replay ###### */
+
+namespace {
+
+// sleeping is too coarse for the last few microseconds, so spin for those
+void wait_until( std::chrono::steady_clock::time_point due ) noexcept
+{
+	using namespace std::chrono_literals;
+	constexpr auto spin_time = 200us;
+
+	if( due - std::chrono::steady_clock::now() > spin_time ) { std::this_thread::sleep_until( due - spin_time ); }
+	while( std::chrono::steady_clock::now() < due ) {
+	}
+}
+
+} // namespace
+
+ReplayStats replay( const CaptureReader& capture, Socket& socket, const endpoint& destination, const ReplayConfig& config )
+{
+	assert( config.timing == ReplayTiming::max_speed || config.speed > 0 );
+
+	ReplayStats       stats{};
+	const std::size_t last = std::min( config.last, capture.size() );
+	if( config.first >= last ) { return stats; }
+
+	const auto dest     = Socket::prepare( destination );
+	const auto start    = std::chrono::steady_clock::now();
+	const auto first_ts = capture[config.first].timestamp;
+
+	for( std::size_t i = config.first; i < last; ++i ) {
+		const CapturedDatagram datagram = capture[i];
+
+		if( config.timing == ReplayTiming::original ) {
+			// datagrams with timestamps before the first one (clock adjustments) are sent immediately
+			const auto offset = std::max( datagram.timestamp - first_ts, std::chrono::system_clock::duration::zero() );
+			wait_until( start
+						+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+							std::chrono::duration<double, std::nano>( offset ) / config.speed ) );
+		}
+
+		if( socket.try_sendto( datagram.data, dest ) ) {
+			++stats.sent;
+		} else {
+			++stats.failed;
+		}
+	}
+
+	stats.duration = std::chrono::steady_clock::now() - start;
+	return stats;
+}
+
+} // namespace mart::nw::ip::udp
@@ -20,6 +20,7 @@
 #include <mart-netlib/RaiiSocket.hpp>
 #include <mart-netlib/network_exceptions.hpp>
 
+#include <mart-netlib/detail/error_message.hpp>
 #include <mart-netlib/detail/socket_base.hpp>
 
 /* Proprietary Library Includes */
@@ -36,10 +37,6 @@
 #include <cerrno>
 #include <cstring>
 
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
-
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
@@ -47,40 +44,6 @@ namespace nw {
 namespace socks {
 namespace detail {
 
-namespace {
-
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
-{
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
-
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
-}
-
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
-{
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
-}
-
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
-{
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
-}
-
-} // namespace
-
 template<class EndpointT>
 DgramSocket<EndpointT>::DgramSocket( EndpointT local, EndpointT remote )
 	: DgramSocket()
@@ -142,6 +105,36 @@ void DgramSocket<EndpointT>::sendto( mart::ConstMemoryView data, endpoint ep )
 	}
 }
 
+template<class EndpointT>
+void DgramSocket<EndpointT>::sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep )
+{
+	const auto res = _socket.sendto( data, 0, ep.toSockAddr() );
+	if( !DgramSocketBase::_txWasSuccess( data, res ) ) {
+		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+			res.error_code(), "Failed to send data to ", ep.toString(), ". Details:  " ) );
+	}
+}
+
+template<class EndpointT>
+void DgramSocket<EndpointT>::sendto( mart::ConstMemoryView data, const prepared_endpoint& ep )
+{
+	const auto res = _socket.sendto( data, 0, ep.native() );
+	if( !_txWasSuccess( data, res ) ) {
+		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+			res.result.error_code(), "Failed to send data to ", ep.get_endpoint().toString(), ". Details:  " ) );
+	}
+}
+
+template<class EndpointT>
+void DgramSocket<EndpointT>::sendto( mart::ArrayView<const mart::ConstMemoryView> data, const prepared_endpoint& ep )
+{
+	const auto res = _socket.sendto( data, 0, ep.native() );
+	if( !DgramSocketBase::_txWasSuccess( data, res ) ) {
+		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+			res.error_code(), "Failed to send data to ", ep.get_endpoint().toString(), ". Details:  " ) );
+	}
+}
+
 
 namespace {
 template<class T, T... Vals>
@@ -151,10 +144,49 @@ bool is_none_of( T v )
 }
 } // namespace
 
+template<class EndpointT>
+typename DgramSocket<EndpointT>::RecvfromResult
+DgramSocket<EndpointT>::_recvfrom_timestamped( mart::MemoryView buffer, socks::ErrorCode& error ) noexcept
+{
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr                addr{};
+	port_layer::RecvMsgInfo info{};
+
+	const auto res = _socket.recvfrom( mart::ArrayView<const mart::MemoryView>( &buffer, 1 ), 0, addr, info );
+	if( !res ) {
+		error = res.error_code();
+		return { mart::MemoryView{}, EndpointT( addr ) };
+	}
+
+	error = socks::ErrorCode::Ok();
+	RecvfromResult ret{ buffer.subview( 0, static_cast<std::size_t>( res.value() ) ), EndpointT( addr ) };
+	if( info.rx_timestamp.count() != 0 ) {
+		ret.rx_timestamp = std::chrono::system_clock::time_point(
+			std::chrono::duration_cast<std::chrono::system_clock::duration>( info.rx_timestamp ) );
+	}
+	return ret;
+}
+
 template<class EndpointT>
 typename DgramSocket<EndpointT>::RecvfromResult DgramSocket<EndpointT>::recvfrom( mart::MemoryView buffer )
 {
 	using mart::nw::socks::ErrorCodeValues;
+
+	if( _rx_timestamping ) {
+		socks::ErrorCode error{};
+		auto             ret = _recvfrom_timestamped( buffer, error );
+		if( !error
+			&& is_none_of<ErrorCodeValues,
+						  ErrorCodeValues::WouldBlock,
+						  ErrorCodeValues::TryAgain,
+						  ErrorCodeValues::Timeout,
+						  ErrorCodeValues::WsaeConnReset>( error.value() ) ) {
+			throw nw::generic_nw_error(
+				make_error_message_with_appended_last_errno( error, "Failed to receive data. Details:  " ) );
+		}
+		return ret;
+	}
+
 	using abi_addr = typename EndpointT::abi_endpoint_type;
 	abi_addr addr{};
 
@@ -172,6 +204,70 @@ typename DgramSocket<EndpointT>::RecvfromResult DgramSocket<EndpointT>::recvfrom
 	return { res.received_data, EndpointT( addr ) };
 }
 
+template<class EndpointT>
+typename DgramSocket<EndpointT>::ScatterRecvfromResult
+DgramSocket<EndpointT>::recvfrom( mart::ArrayView<const mart::MemoryView> buffers )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr addr{};
+
+	auto res = _socket.recvfrom( buffers, 0, addr );
+	if( !res
+		&& is_none_of<ErrorCodeValues,
+					  ErrorCodeValues::WouldBlock,
+					  ErrorCodeValues::TryAgain,
+					  ErrorCodeValues::Timeout,
+					  ErrorCodeValues::WsaeConnReset>( res.error_code().value() ) ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to receive data. Details:  " ) );
+	}
+
+	return { res, EndpointT( addr ) };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::CoalescedRecvfromResult
+DgramSocket<EndpointT>::try_recvfrom_coalesced( mart::MemoryView buffer ) noexcept
+{
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr                addr{};
+	port_layer::RecvMsgInfo info{};
+
+	const auto res = _socket.recvfrom( mart::ArrayView<const mart::MemoryView>( &buffer, 1 ), 0, addr, info );
+	if( !res ) { return { mart::MemoryView{}, 0, EndpointT( addr ) }; }
+
+	const auto size = static_cast<std::size_t>( res.value() );
+	return { buffer.subview( 0, size ), info.segment_size > 0 ? static_cast<std::size_t>( info.segment_size ) : size,
+			 EndpointT( addr ) };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::CoalescedRecvfromResult
+DgramSocket<EndpointT>::recvfrom_coalesced( mart::MemoryView buffer )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr                addr{};
+	port_layer::RecvMsgInfo info{};
+
+	const auto res = _socket.recvfrom( mart::ArrayView<const mart::MemoryView>( &buffer, 1 ), 0, addr, info );
+	if( !res
+		&& is_none_of<ErrorCodeValues,
+					  ErrorCodeValues::WouldBlock,
+					  ErrorCodeValues::TryAgain,
+					  ErrorCodeValues::Timeout,
+					  ErrorCodeValues::WsaeConnReset>( res.error_code().value() ) ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to receive data. Details:  " ) );
+	}
+	if( !res ) { return { mart::MemoryView{}, 0, EndpointT( addr ) }; }
+
+	const auto size = static_cast<std::size_t>( res.value() );
+	return { buffer.subview( 0, size ), info.segment_size > 0 ? static_cast<std::size_t>( info.segment_size ) : size,
+			 EndpointT( addr ) };
+}
+
 namespace {
 struct BlockingRestorer {
 	BlockingRestorer( nw::socks::RaiiSocket& socket )
@@ -20,6 +20,7 @@
 #include <mart-netlib/RaiiSocket.hpp>
 #include <mart-netlib/network_exceptions.hpp>
 
+#include <mart-netlib/detail/error_message.hpp>
 #include <mart-netlib/detail/socket_base.hpp>
 
 /* Proprietary Library Includes */
@@ -36,10 +37,6 @@
 #include <cerrno>
 #include <cstring>
 
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
-
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
@@ -47,40 +44,6 @@ namespace nw {
 namespace socks {
 namespace detail {
 
-namespace {
-
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
-{
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
-
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
-}
-
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
-{
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
-}
-
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
-{
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
-}
-
-} // namespace
-
 // TODO: look for more efficient solution
 std::string to_string( std::chrono::microseconds timeout )
 {
@@ -142,6 +105,102 @@ void HighLevelSocketBase::set_blocking( bool should_block )
 	}
 }
 
+namespace {
+
+void throw_on_set_option_error( socks::ErrorCode res, std::string_view option_name, std::string_view value )
+{
+	if( !res ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno(
+			res, "Could not set socket option ", option_name, " to ", value, " on socket" ) );
+	}
+}
+
+int throw_on_get_option_error( const ReturnValue<int>& res, std::string_view option_name )
+{
+	if( !res ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno(
+			res.error_code(), "Could not determine socket option ", option_name, " on socket" ) );
+	}
+	return res.value();
+}
+
+std::string_view to_string( bool b )
+{
+	return b ? "true" : "false";
+}
+
+} // namespace
+
+void HighLevelSocketBase::set_rx_buffer_size( int size )
+{
+	throw_on_set_option_error( try_set_rx_buffer_size( size ), "SO_RCVBUF", std::to_string( size ) );
+}
+
+void HighLevelSocketBase::set_tx_buffer_size( int size )
+{
+	throw_on_set_option_error( try_set_tx_buffer_size( size ), "SO_SNDBUF", std::to_string( size ) );
+}
+
+int HighLevelSocketBase::get_rx_buffer_size() const
+{
+	return throw_on_get_option_error( try_get_rx_buffer_size(), "SO_RCVBUF" );
+}
+
+int HighLevelSocketBase::get_tx_buffer_size() const
+{
+	return throw_on_get_option_error( try_get_tx_buffer_size(), "SO_SNDBUF" );
+}
+
+void HighLevelSocketBase::set_reuse_address( bool enable )
+{
+	throw_on_set_option_error( try_set_reuse_address( enable ), "SO_REUSEADDR", to_string( enable ) );
+}
+
+void HighLevelSocketBase::set_reuse_port( bool enable )
+{
+	throw_on_set_option_error( try_set_reuse_port( enable ), "SO_REUSEPORT", to_string( enable ) );
+}
+
+void HighLevelSocketBase::set_busy_poll( std::chrono::microseconds duration )
+{
+	throw_on_set_option_error( try_set_busy_poll( duration ), "SO_BUSY_POLL", to_string( duration ) );
+}
+
+void HighLevelSocketBase::set_priority( int priority )
+{
+	throw_on_set_option_error( try_set_priority( priority ), "SO_PRIORITY", std::to_string( priority ) );
+}
+
+socks::ErrorCode HighLevelSocketBase::try_set_type_of_service( std::uint8_t tos ) noexcept
+{
+	if( _domain != Domain::Inet6 ) { return _set_int_option( SocketOptionLevel::Ip, SocketOption::ip_tos, tos ); }
+
+	const auto res = _set_int_option( SocketOptionLevel::Ipv6, SocketOption::ipv6_tclass, tos );
+	// dual stack socket: ipv4 packets to v4-mapped addresses use IP_TOS (not supported on ipv6 sockets everywhere)
+	if( res ) { (void)_set_int_option( SocketOptionLevel::Ip, SocketOption::ip_tos, tos ); }
+	return res;
+}
+
+void HighLevelSocketBase::set_type_of_service( std::uint8_t tos )
+{
+	throw_on_set_option_error(
+		try_set_type_of_service( tos ), _domain == Domain::Inet6 ? "IPV6_TCLASS" : "IP_TOS", std::to_string( tos ) );
+}
+
+void HighLevelSocketBase::set_v6_only( bool enable )
+{
+	throw_on_set_option_error( try_set_v6_only( enable ), "IPV6_V6ONLY", to_string( enable ) );
+}
+
+void HighLevelSocketBase::set_no_delay( bool enable )
+{
+	throw_on_set_option_error( try_set_no_delay( enable ), "TCP_NODELAY", to_string( enable ) );
+}
+
+void HighLevelSocketBase::set_quick_ack( bool enable )
+{
+	throw_on_set_option_error( try_set_quick_ack( enable ), "TCP_QUICKACK", to_string( enable ) );
+}
 
 void HighLevelSocketBase::close() {
 	if( !try_close() ) {
@@ -205,6 +264,58 @@ mart::MemoryView DgramSocketBase::recv( mart::MemoryView buffer )
 	return res.received_data;
 }
 
+void DgramSocketBase::send( mart::ArrayView<const mart::ConstMemoryView> data )
+{
+	const auto res = _socket.send( data, 0 );
+	if( !_txWasSuccess( data, res ) ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to send data. Details:  " ) );
+	}
+}
+
+std::size_t DgramSocketBase::recv( mart::ArrayView<const mart::MemoryView> buffers )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	const auto res = _socket.recv( buffers, 0 );
+	if( !res
+		&& is_none_of<ErrorCodeValues,
+					  ErrorCodeValues::WouldBlock,
+					  ErrorCodeValues::TryAgain,
+					  ErrorCodeValues::Timeout,
+					  ErrorCodeValues::WsaeConnReset>( res.error_code().value() ) ) {
+		throw nw::generic_nw_error(
+			make_error_message_with_appended_last_errno( res.error_code(), "Failed to receive data. Details:  " ) );
+	}
+	return static_cast<std::size_t>( res.value_or( 0 ) );
+}
+
+void DgramSocketBase::set_tx_segment_size( std::uint16_t segment_size )
+{
+	const auto res = try_set_tx_segment_size( segment_size );
+	if( !res ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno(
+			res, "Could not set tx segment size (UDP_SEGMENT) to ", std::to_string( segment_size ), " on socket" ) );
+	}
+}
+
+void DgramSocketBase::set_rx_coalescing( bool enable )
+{
+	const auto res = try_set_rx_coalescing( enable );
+	if( !res ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno(
+			res, "Could not ", ( enable ? "enable" : "disable" ), " rx coalescing (UDP_GRO) on socket" ) );
+	}
+}
+
+void DgramSocketBase::set_rx_timestamping( bool enable )
+{
+	const auto res = try_set_rx_timestamping( enable );
+	if( !res ) {
+		throw generic_nw_error( make_error_message_with_appended_last_errno(
+			res, "Could not ", ( enable ? "enable" : "disable" ), " rx timestamping (SO_TIMESTAMPNS) on socket" ) );
+	}
+}
+
 
 
 
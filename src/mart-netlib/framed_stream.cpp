@@ -0,0 +1,169 @@
+#include <mart-netlib/framed_stream.hpp>
+
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace mart::nw::ip::tcp {
+
+namespace {
+
+template<class T, T... Vals>
+bool is_none_of( T v )
+{
+	return ( true && ... && ( v != Vals ) );
+}
+
+std::uint32_t read_length_prefix( const std::uint8_t* src ) noexcept
+{
+	return ( std::uint32_t{ src[0] } << 24 ) | ( std::uint32_t{ src[1] } << 16 ) | ( std::uint32_t{ src[2] } << 8 )
+		   | std::uint32_t{ src[3] };
+}
+
+void write_length_prefix( std::uint32_t length, std::uint8_t* dst ) noexcept
+{
+	dst[0] = static_cast<std::uint8_t>( length >> 24 );
+	dst[1] = static_cast<std::uint8_t>( length >> 16 );
+	dst[2] = static_cast<std::uint8_t>( length >> 8 );
+	dst[3] = static_cast<std::uint8_t>( length );
+}
+
+} // namespace
+
+FramedStream FramedStream::length_prefixed( Socket socket, std::size_t rx_buffer_size )
+{
+	return FramedStream( std::move( socket ), Framing::LengthPrefix, 0, rx_buffer_size );
+}
+
+FramedStream FramedStream::delimited( Socket socket, std::uint8_t delimiter, std::size_t rx_buffer_size )
+{
+	return FramedStream( std::move( socket ), Framing::Delimiter, delimiter, rx_buffer_size );
+}
+
+FramedStream::FramedStream( Socket&& socket, Framing framing, std::uint8_t delimiter, std::size_t rx_buffer_size )
+	: _socket( std::move( socket ) )
+	, _framing( framing )
+	, _delimiter( delimiter )
+	, _rx_buffer( new std::uint8_t[rx_buffer_size] )
+	, _rx_capacity( rx_buffer_size )
+{
+	assert( rx_buffer_size > length_prefix_size );
+}
+
+std::optional<mart::ConstMemoryView> FramedStream::try_next_buffered_frame()
+{
+	const std::uint8_t* const begin = _rx_buffer.get() + _rx_begin;
+	const std::size_t         avail = _rx_end - _rx_begin;
+
+	if( _framing == Framing::LengthPrefix ) {
+		if( avail < length_prefix_size ) { return std::nullopt; }
+
+		const std::size_t length = read_length_prefix( begin );
+		if( length > _rx_capacity - length_prefix_size ) {
+			throw generic_nw_error( mba::concat( "Received frame of size ",
+												 std::to_string( length ),
+												 " which doesn't fit into the receive buffer of size ",
+												 std::to_string( _rx_capacity ) ) );
+		}
+		if( avail < length_prefix_size + length ) { return std::nullopt; }
+
+		_rx_begin += length_prefix_size + length;
+		return mart::ConstMemoryView( begin + length_prefix_size, length );
+	} else {
+		const std::uint8_t* scan_start = _rx_buffer.get() + std::max( _rx_scan, _rx_begin );
+		const std::uint8_t* end        = _rx_buffer.get() + _rx_end;
+		const std::uint8_t* delim      = std::find( scan_start, end, _delimiter );
+		if( delim == end ) {
+			_rx_scan = _rx_end;
+			return std::nullopt;
+		}
+
+		const auto length = static_cast<std::size_t>( delim - begin );
+		_rx_begin += length + 1;
+		_rx_scan = _rx_begin;
+		return mart::ConstMemoryView( begin, length );
+	}
+}
+
+bool FramedStream::_fill_rx_buffer()
+{
+	if( _rx_begin == _rx_end ) {
+		_rx_begin = _rx_end = _rx_scan = 0;
+	} else if( _rx_end == _rx_capacity ) {
+		if( _rx_begin == 0 ) {
+			throw generic_nw_error( mba::concat( "Received frame doesn't fit into the receive buffer of size ",
+												 std::to_string( _rx_capacity ) ) );
+		}
+		// move the partial frame to the front, so there is room for the rest
+		std::memmove( _rx_buffer.get(), _rx_buffer.get() + _rx_begin, _rx_end - _rx_begin );
+		_rx_end -= _rx_begin;
+		_rx_scan -= std::min( _rx_scan, _rx_begin );
+		_rx_begin = 0;
+	}
+
+	using mart::nw::socks::ErrorCodeValues;
+	const auto res = _socket.as_raii_socket().recv(
+		mart::MemoryView( _rx_buffer.get() + _rx_end, _rx_capacity - _rx_end ), 0 );
+	if( !res.result ) {
+		if( is_none_of<ErrorCodeValues,
+					   ErrorCodeValues::WouldBlock,
+					   ErrorCodeValues::TryAgain,
+					   ErrorCodeValues::Timeout>( res.result.error_code().value() ) ) {
+			throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
+				res.result.error_code(), "Failed to receive data. Details:  " ) );
+		}
+		return false;
+	}
+	if( res.received_data.empty() ) {
+		_closed = true;
+		return false;
+	}
+	_rx_end += res.received_data.size();
+	return true;
+}
+
+std::optional<mart::ConstMemoryView> FramedStream::recv_frame()
+{
+	while( true ) {
+		if( auto frame = try_next_buffered_frame() ) { return frame; }
+		if( _closed || !_fill_rx_buffer() ) { return std::nullopt; }
+	}
+}
+
+void FramedStream::queue_frame( mart::ConstMemoryView payload )
+{
+	if( _framing == Framing::LengthPrefix && payload.size() > std::numeric_limits<std::uint32_t>::max() ) {
+		throw generic_nw_error( "Frame too large for a 4 byte length prefix" );
+	}
+	if( _tx_frame_cnt == _tx_frames.size() ) { flush(); }
+	_tx_frames[_tx_frame_cnt++] = payload;
+}
+
+void FramedStream::flush()
+{
+	if( _tx_frame_cnt == 0 ) { return; }
+
+	std::array<std::array<std::uint8_t, length_prefix_size>, max_queued_frames> headers;
+	std::array<mart::ConstMemoryView, socks::port_layer::max_io_buffer_cnt>    parts{};
+
+	std::size_t part_cnt = 0;
+	for( std::size_t i = 0; i < _tx_frame_cnt; ++i ) {
+		const auto payload = _tx_frames[i];
+		if( _framing == Framing::LengthPrefix ) {
+			write_length_prefix( static_cast<std::uint32_t>( payload.size() ), headers[i].data() );
+			parts[part_cnt++] = mart::ConstMemoryView( headers[i].data(), headers[i].size() );
+			if( !payload.empty() ) { parts[part_cnt++] = payload; }
+		} else {
+			if( !payload.empty() ) { parts[part_cnt++] = payload; }
+			parts[part_cnt++] = mart::ConstMemoryView( &_delimiter, 1 );
+		}
+	}
+	_socket.send( mart::ArrayView<const mart::ConstMemoryView>( parts.data(), part_cnt ) );
+	_tx_frame_cnt = 0;
+}
+
+} // namespace mart::nw::ip::tcp
@@ -4,6 +4,10 @@
 
 #include <mart-netlib/network_exceptions.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <string>
+
 namespace mart::nw::ip {
 
 mba::im_zstr address_v4::asString() const
@@ -23,6 +27,79 @@ mba::im_zstr address_v4::asString() const
 		mba::concat( "Could not parse string \"", str, "\" - IP-Addess must have format a.b.c.d. " ) );
 }
 
+address_v6::address_v6( std::string_view str )
+{
+	auto res = try_parse_v6_address( str );
+	if( !res ) {
+		throw mart::nw::invalid_address_string(
+			mba::concat( "Could not parse string \"", str, "\" - Not a valid IPv6 address. " ) );
+	}
+	*this = *res;
+}
+
+mba::im_zstr address_v6::asString() const
+{
+	// INET6_ADDRSTRLEN is 46
+	std::array<char, 48> ret{};
+
+	nw::socks::port_layer::inet_net_to_pres( socks::Domain::Inet6, _bytes.data(), ret.data(), ret.size() );
+	if( _scope_id == 0 ) { return mba::im_zstr( std::string_view( ret.data() ) ); }
+
+	// zone id: the name of the interface if there is one with that index, the index otherwise
+	std::array<char, 64> zone{};
+	if( nw::socks::port_layer::interface_index_to_name( _scope_id, zone.data(), zone.size() ) ) {
+		return mba::concat( std::string_view( ret.data() ), "%", std::string_view( zone.data() ) );
+	}
+	return mba::concat( std::string_view( ret.data() ), "%", std::to_string( _scope_id ) );
+}
+
+namespace {
+
+// numeric zone id or the name of a network interface
+std::optional<std::uint32_t> parse_zone_id( std::string_view zone ) noexcept
+{
+	if( zone.empty() ) { return {}; }
+	if( std::all_of( zone.begin(), zone.end(), []( char c ) { return c >= '0' && c <= '9'; } ) ) {
+		std::uint64_t id = 0;
+		for( const char c : zone ) {
+			id = id * 10 + static_cast<std::uint64_t>( c - '0' );
+			if( id > std::numeric_limits<std::uint32_t>::max() ) { return {}; }
+		}
+		return static_cast<std::uint32_t>( id );
+	}
+
+	std::array<char, 64> name{};
+	if( zone.size() >= name.size() ) { return {}; }
+	std::copy( zone.begin(), zone.end(), name.begin() );
+	const std::uint32_t index = nw::socks::port_layer::interface_name_to_index( name.data() );
+	if( index == 0 ) { return {}; }
+	return index;
+}
+
+} // namespace
+
+std::optional<address_v6> try_parse_v6_address( std::string_view string ) noexcept
+{
+	std::uint32_t scope_id = 0;
+	if( const auto percent = string.find( '%' ); percent != std::string_view::npos ) {
+		const auto zone = parse_zone_id( string.substr( percent + 1 ) );
+		if( !zone ) { return {}; }
+		scope_id = *zone;
+		string   = string.substr( 0, percent );
+	}
+
+	// inet_pton needs a null terminated string
+	std::array<char, 48> buffer{};
+	if( string.empty() || string.size() >= buffer.size() ) { return {}; }
+	std::copy( string.begin(), string.end(), buffer.begin() );
+
+	address_v6::bytes_type bytes{};
+	if( nw::socks::port_layer::inet_pres_to_net( socks::Domain::Inet6, buffer.data(), bytes.data() ) != 1 ) {
+		return {};
+	}
+	return address_v6( bytes, scope_id );
+}
+
 namespace _impl_details_ip {
 
 [[noreturn]] void _throw_ipv4_parse_fail_invalid_format( std::string_view str )
@@ -66,6 +143,56 @@ mba::im_zstr basic_endpoint_v4_base::toStringEx( TransportProtocol p ) const
 	}
 }
 
+basic_endpoint_v6_base::basic_endpoint_v6_base( const mart::nw::socks::port_layer::SockaddrIn6& addr )
+	: address( addr.address(), addr.scope_id() )
+	, port( addr.port() )
+	, _valid{addr.is_valid() ? true : throw mart::nw::invalid_address_string( "Invalid sockaddr_in6 passed " )}
+{
+}
+
+std::optional<basic_endpoint_v6_base> try_parse_basic_v6_endpoint( std::string_view str ) noexcept
+{
+	// [address]:port
+	if( str.size() < 2 || str.front() != '[' ) { return {}; }
+	const auto closing = str.find( "]:" );
+	if( closing == std::string_view::npos ) { return {}; }
+
+	const auto o_address = try_parse_v6_address( str.substr( 1, closing - 1 ) );
+	if( !o_address ) { return {}; }
+
+	const auto o_port = try_parse_v4_port( str.substr( closing + 2 ) );
+	if( !o_port ) { return {}; }
+
+	return basic_endpoint_v6_base{*o_address, *o_port};
+}
+
+basic_endpoint_v6_base::basic_endpoint_v6_base( std::string_view str )
+{
+	auto res = try_parse_basic_v6_endpoint( str );
+	if( !res ) {
+		throw mart::nw::invalid_address_string(
+			mba::concat( "Creating ipv6 endpoint from string \"",
+						 str,
+						 "\" Failed. "
+						 "Addess must have format [a:b::c]:p with p in the interval [0..65535]" ) );
+	}
+	*this = *res;
+}
+
+mba::im_zstr basic_endpoint_v6_base::toString() const
+{
+	return mba::concat( "[", address.asString(), "]:", std::to_string( port.inHostOrder() ) );
+}
+
+mba::im_zstr basic_endpoint_v6_base::toStringEx( TransportProtocol p ) const
+{
+	switch( p ) {
+		case TransportProtocol::Udp: return mba::concat( toString(), " (UDP)" );
+		case TransportProtocol::Tcp: return mba::concat( toString(), " (TCP)" );
+		default: return mba::concat( toString(), " (Unknown)" );
+	}
+}
+
 } // namespace _impl_details_ip
 
 } // namespace mart::nw::ip
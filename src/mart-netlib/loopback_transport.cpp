@@ -0,0 +1,582 @@
+#include <mart-netlib/loopback_transport.hpp>
+
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <im_str/im_str.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mart::nw::ip::udp {
+
+namespace {
+
+using clock_t     = std::chrono::steady_clock;
+using timestamp_t = std::optional<std::chrono::system_clock::time_point>;
+
+std::uint64_t to_key( const endpoint& ep ) noexcept
+{
+	return ( std::uint64_t{ep.address.inHostOrder()} << 16 ) | ep.port.inHostOrder();
+}
+
+std::size_t round_up_to_power_of_two( std::size_t v ) noexcept
+{
+	std::size_t r = 1;
+	while( r < v ) {
+		r <<= 1;
+	}
+	return r;
+}
+
+// splitmix64 - cheap, good enough for loss / reorder decisions and identical on all platforms
+std::uint64_t splitmix64( std::uint64_t& state ) noexcept
+{
+	std::uint64_t z = ( state += 0x9E37'79B9'7F4A'7C15 );
+	z               = ( z ^ ( z >> 30 ) ) * 0xBF58'476D'1CE4'E5B9;
+	z               = ( z ^ ( z >> 27 ) ) * 0x94D0'49BB'1331'11EB;
+	return z ^ ( z >> 31 );
+}
+
+double to_probability( std::uint64_t random ) noexcept
+{
+	return static_cast<double>( random >> 11 ) * ( 1.0 / static_cast<double>( std::uint64_t{1} << 53 ) );
+}
+
+socks::ErrorCode make_error( int native ) noexcept
+{
+	return socks::ErrorCode{static_cast<socks::ErrorCode::Value_t>( native )};
+}
+
+} // namespace
+
+namespace detail {
+
+/*
+ * Bounded multi-producer queue (D. Vyukov's design: each cell has a sequence number that tells producers
+ * and the consumer whose turn it is). Only one thread may consume at a time.
+ * The payload buffers of the cells are reused, so there are no allocations once they reached their maximal size.
+ * Until then, growing them may throw std::bad_alloc, which drops the affected datagram but leaves the queue intact.
+ */
+class LoopbackMailbox {
+public:
+	LoopbackMailbox( std::size_t capacity, bool delays_datagrams )
+		: _cells( new Cell[round_up_to_power_of_two( std::max<std::size_t>( capacity, 2 ) )] )
+		, _mask( round_up_to_power_of_two( std::max<std::size_t>( capacity, 2 ) ) - 1 )
+		, _delays_datagrams( delays_datagrams )
+	{
+		for( std::size_t i = 0; i <= _mask; ++i ) {
+			_cells[i].seq.store( i, std::memory_order_relaxed );
+		}
+	}
+
+	bool try_push( mart::ConstMemoryView data,
+				   const endpoint&       from,
+				   clock_t::time_point   deliver_at,
+				   const timestamp_t&    rx_timestamp )
+	{
+		std::size_t pos = _enqueue_pos.load( std::memory_order_relaxed );
+		Cell*       cell;
+		while( true ) {
+			cell                  = &_cells[pos & _mask];
+			const std::size_t seq  = cell->seq.load( std::memory_order_acquire );
+			const auto        diff = static_cast<std::ptrdiff_t>( seq ) - static_cast<std::ptrdiff_t>( pos );
+			if( diff == 0 ) {
+				if( _enqueue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) { break; }
+			} else if( diff < 0 ) {
+				return false; // full
+			} else {
+				pos = _enqueue_pos.load( std::memory_order_relaxed );
+			}
+		}
+
+		try {
+			cell->data.assign( data.begin(), data.end() );
+		} catch( ... ) {
+			// the cell has already been claimed, so it has to be handed over to the consumer nevertheless
+			cell->data.clear();
+			cell->dropped = true;
+			cell->seq.store( pos + 1, std::memory_order_release );
+			throw;
+		}
+		cell->dropped      = false;
+		cell->from         = from;
+		cell->deliver_at   = deliver_at;
+		cell->rx_timestamp = rx_timestamp;
+		cell->seq.store( pos + 1, std::memory_order_release );
+		return true;
+	}
+
+	// consumer only. Returns false if no datagram is receivable (yet). May throw std::bad_alloc, if datagrams are
+	// delayed and the pending heap has to grow. No datagram gets lost in that case
+	bool try_pop( mart::MemoryView buffer, LoopbackSocket::RecvfromResult& result )
+	{
+		if( !_delays_datagrams ) {
+			while( Cell* cell = _front() ) {
+				if( !cell->dropped ) { _copy_out( cell->data, cell->from, cell->rx_timestamp, buffer, result ); }
+				const bool received = !cell->dropped;
+				_pop_front( cell );
+				if( received ) { return true; }
+			}
+			return false;
+		}
+
+		// move everything that arrived into the pending heap, so datagrams can overtake each other
+		while( Cell* cell = _front() ) {
+			if( !cell->dropped ) {
+				_reserve_pending();
+				// nothing below allocates
+				std::vector<std::uint8_t> data;
+				if( !_recycled.empty() ) {
+					data = std::move( _recycled.back() );
+					_recycled.pop_back();
+				}
+				std::swap( data, cell->data );
+				_pending.push_back(
+					Pending{cell->deliver_at, _arrival_cnt++, cell->from, cell->rx_timestamp, std::move( data )} );
+				std::push_heap( _pending.begin(), _pending.end(), Pending::later );
+			}
+			_pop_front( cell );
+		}
+
+		if( _pending.empty() || _pending.front().deliver_at > clock_t::now() ) { return false; }
+
+		std::pop_heap( _pending.begin(), _pending.end(), Pending::later );
+		Pending& next = _pending.back();
+		_copy_out( next.data, next.from, next.rx_timestamp, buffer, result );
+		_recycled.push_back( std::move( next.data ) );
+		_pending.pop_back();
+		return true;
+	}
+
+	std::atomic<bool> timestamping{false};
+
+	std::atomic<bool> closed{false};
+
+private:
+	struct Cell {
+		std::atomic<std::size_t>  seq{0};
+		std::vector<std::uint8_t> data;
+		bool                      dropped = false; // the payload couldn't be copied
+		endpoint                  from{};
+		clock_t::time_point       deliver_at{};
+		timestamp_t               rx_timestamp{};
+	};
+
+	struct Pending {
+		clock_t::time_point       deliver_at;
+		std::uint64_t             arrival;
+		endpoint                  from;
+		timestamp_t               rx_timestamp;
+		std::vector<std::uint8_t> data;
+
+		static bool later( const Pending& l, const Pending& r ) noexcept
+		{
+			return l.deliver_at > r.deliver_at || ( l.deliver_at == r.deliver_at && l.arrival > r.arrival );
+		}
+	};
+
+	Cell* _front() noexcept
+	{
+		Cell* cell = &_cells[_dequeue_pos & _mask];
+		return cell->seq.load( std::memory_order_acquire ) == _dequeue_pos + 1 ? cell : nullptr;
+	}
+
+	void _pop_front( Cell* cell ) noexcept
+	{
+		cell->seq.store( _dequeue_pos + _mask + 1, std::memory_order_release );
+		++_dequeue_pos;
+	}
+
+	// Each buffer is either in _pending or in _recycled, so reserving the capacity for all of them in both
+	// guarantees, that moving a buffer from one to the other never allocates
+	void _reserve_pending()
+	{
+		if( _pending.size() < _pending.capacity() ) { return; }
+		const std::size_t new_capacity = std::max<std::size_t>( 2 * _pending.capacity(), 16 );
+		_recycled.reserve( new_capacity );
+		_pending.reserve( new_capacity );
+	}
+
+	static void _copy_out( const std::vector<std::uint8_t>& data,
+						   const endpoint&                  from,
+						   const timestamp_t&               rx_timestamp,
+						   mart::MemoryView                 buffer,
+						   LoopbackSocket::RecvfromResult&  result ) noexcept
+	{
+		// like udp: the rest of a datagram that doesn't fit into the buffer is lost
+		const std::size_t n = std::min( buffer.size(), data.size() );
+		if( n ) { std::memcpy( buffer.data(), data.data(), n ); }
+		result.data           = buffer.max_subview( 0, n );
+		result.remote_address = from;
+		result.rx_timestamp   = rx_timestamp;
+	}
+
+	std::unique_ptr<Cell[]> _cells;
+	const std::size_t       _mask;
+	const bool              _delays_datagrams;
+
+	alignas( 64 ) std::atomic<std::size_t> _enqueue_pos{0};
+
+	// consumer side
+	alignas( 64 ) std::size_t _dequeue_pos = 0;
+	std::vector<Pending>                   _pending;
+	std::vector<std::vector<std::uint8_t>> _recycled;
+	std::uint64_t                          _arrival_cnt = 0;
+};
+
+} // namespace detail
+
+/* ###### LoopbackNetwork ###### */
+
+LoopbackNetwork::LoopbackNetwork( const LoopbackNetworkConfig& config )
+	: _config( config )
+{
+}
+
+LoopbackNetwork::~LoopbackNetwork() = default;
+
+LoopbackStats LoopbackNetwork::stats() const noexcept
+{
+	LoopbackStats s;
+	s.sent                = _counters.sent.load( std::memory_order_relaxed );
+	s.queued              = _counters.queued.load( std::memory_order_relaxed );
+	s.dropped_loss        = _counters.dropped_loss.load( std::memory_order_relaxed );
+	s.dropped_no_receiver = _counters.dropped_no_receiver.load( std::memory_order_relaxed );
+	s.dropped_queue_full  = _counters.dropped_queue_full.load( std::memory_order_relaxed );
+	return s;
+}
+
+LoopbackNetwork::mailbox_ptr LoopbackNetwork::_bind( endpoint& ep )
+{
+	std::lock_guard<std::mutex> lock( _mutex );
+	if( ep.port.inHostOrder() == 0 ) {
+		// ephemeral port - skip the ones that are in use
+		for( int i = 0; i < 0x4000; ++i ) {
+			const endpoint candidate( ep.address, port_nr( _next_ephemeral_port ) );
+			_next_ephemeral_port = _next_ephemeral_port == 0xFFFF ? 49152 : _next_ephemeral_port + 1;
+			if( _mailboxes.count( to_key( candidate ) ) == 0 ) {
+				ep = candidate;
+				break;
+			}
+		}
+		if( ep.port.inHostOrder() == 0 ) { return nullptr; }
+	}
+
+	auto& entry = _mailboxes[to_key( ep )];
+	if( entry ) { return nullptr; }
+	entry = std::make_shared<detail::LoopbackMailbox>( _config.queue_capacity,
+														_config.impairments.delays_datagrams() );
+	return entry;
+}
+
+void LoopbackNetwork::_unbind( const endpoint& ep ) noexcept
+{
+	std::lock_guard<std::mutex> lock( _mutex );
+	auto                        it = _mailboxes.find( to_key( ep ) );
+	if( it != _mailboxes.end() ) {
+		it->second->closed.store( true, std::memory_order_release );
+		_mailboxes.erase( it );
+	}
+}
+
+LoopbackNetwork::mailbox_ptr LoopbackNetwork::_find( const endpoint& ep ) const noexcept
+{
+	std::lock_guard<std::mutex> lock( _mutex );
+	auto                        it = _mailboxes.find( to_key( ep ) );
+	if( it == _mailboxes.end() ) {
+		// a socket bound to the any address receives datagrams sent to any address
+		it = _mailboxes.find( to_key( endpoint( address_any, ep.port ) ) );
+	}
+	return it == _mailboxes.end() ? nullptr : it->second;
+}
+
+std::uint64_t LoopbackNetwork::_next_socket_seed() noexcept
+{
+	std::lock_guard<std::mutex> lock( _mutex );
+	std::uint64_t               state = _config.seed + _socket_cnt++;
+	return splitmix64( state );
+}
+
+/* ###### LoopbackSocket ###### */
+
+LoopbackSocket::LoopbackSocket( LoopbackNetwork& network )
+	: _network( &network )
+	, _rng_state( network._next_socket_seed() )
+{
+}
+
+LoopbackSocket::LoopbackSocket( LoopbackNetwork& network, endpoint local, endpoint remote )
+	: LoopbackSocket( network )
+{
+	bind( local );
+	connect( remote );
+}
+
+LoopbackSocket::LoopbackSocket( LoopbackSocket&& other ) noexcept
+	: _network( std::exchange( other._network, nullptr ) )
+	, _rx_mailbox( std::move( other._rx_mailbox ) )
+	, _ep_local( std::exchange( other._ep_local, endpoint{} ) )
+	, _ep_remote( std::exchange( other._ep_remote, endpoint{} ) )
+	, _tx_routes( std::exchange( other._tx_routes, {} ) )
+	, _tx_route_next( other._tx_route_next )
+	, _rx_timeout( other._rx_timeout )
+	, _is_blocking( other._is_blocking )
+	, _rx_timestamping( other._rx_timestamping )
+	, _rng_state( other._rng_state )
+{
+}
+
+LoopbackSocket& LoopbackSocket::operator=( LoopbackSocket&& other ) noexcept
+{
+	if( this != &other ) {
+		try_close();
+		_network           = std::exchange( other._network, nullptr );
+		_rx_mailbox        = std::move( other._rx_mailbox );
+		_ep_local          = std::exchange( other._ep_local, endpoint{} );
+		_ep_remote         = std::exchange( other._ep_remote, endpoint{} );
+		_tx_routes         = std::exchange( other._tx_routes, {} );
+		_tx_route_next     = other._tx_route_next;
+		_rx_timeout        = other._rx_timeout;
+		_is_blocking       = other._is_blocking;
+		_rx_timestamping   = other._rx_timestamping;
+		_rng_state         = other._rng_state;
+	}
+	return *this;
+}
+
+LoopbackSocket::~LoopbackSocket()
+{
+	try_close();
+}
+
+bool LoopbackSocket::try_close() noexcept
+{
+	if( !_network ) { return false; }
+	if( _rx_mailbox ) { _network->_unbind( _ep_local ); }
+	_rx_mailbox.reset();
+	_tx_routes = {};
+	_ep_local  = {};
+	_ep_remote = {};
+	_network   = nullptr;
+	return true;
+}
+
+socks::ErrorCode LoopbackSocket::try_bind( endpoint ep ) noexcept
+{
+	if( !_network ) { return make_error( EBADF ); }
+	if( _rx_mailbox ) { return make_error( EINVAL ); } // already bound
+	try {
+		auto mailbox = _network->_bind( ep );
+		if( !mailbox ) { return make_error( EADDRINUSE ); }
+		mailbox->timestamping.store( _rx_timestamping, std::memory_order_relaxed );
+		_rx_mailbox = std::move( mailbox );
+	} catch( const std::bad_alloc& ) {
+		return make_error( ENOMEM );
+	}
+	_ep_local = ep;
+	return socks::ErrorCode::Ok();
+}
+
+void LoopbackSocket::bind( endpoint ep )
+{
+	const auto res = try_bind( ep );
+	if( !res ) {
+		throw generic_nw_error( mba::concat( "Could not bind loopback socket to address ",
+											 ep.toStringEx(),
+											 " Error Msg: ",
+											 socks::to_text_rep( res ) ) );
+	}
+}
+
+socks::ErrorCode LoopbackSocket::try_connect( endpoint ep ) noexcept
+{
+	if( !_network ) { return make_error( EBADF ); }
+	if( !ep.valid() ) { return make_error( EINVAL ); }
+	_ep_remote = ep;
+	return socks::ErrorCode::Ok();
+}
+
+void LoopbackSocket::connect( endpoint ep )
+{
+	const auto res = try_connect( ep );
+	if( !res ) {
+		throw generic_nw_error( mba::concat( "Could not connect loopback socket to address ",
+											 ep.toStringEx(),
+											 " Error Msg: ",
+											 socks::to_text_rep( res ) ) );
+	}
+}
+
+bool LoopbackSocket::try_set_rx_timestamping( bool enable ) noexcept
+{
+	if( !_network ) { return false; }
+	_rx_timestamping = enable;
+	if( _rx_mailbox ) { _rx_mailbox->timestamping.store( enable, std::memory_order_relaxed ); }
+	return true;
+}
+
+std::uint64_t LoopbackSocket::_next_random() noexcept
+{
+	return splitmix64( _rng_state );
+}
+
+detail::LoopbackMailbox* LoopbackSocket::_find_tx_route( const endpoint& ep ) noexcept
+{
+	for( TxRoute& route : _tx_routes ) {
+		if( route.mailbox && route.ep == ep ) {
+			// the receiver is gone - maybe someone else is bound to the endpoint by now
+			if( route.mailbox->closed.load( std::memory_order_acquire ) ) { route.mailbox = _network->_find( ep ); }
+			return route.mailbox.get();
+		}
+	}
+
+	auto mailbox = _network->_find( ep );
+	if( !mailbox ) { return nullptr; }
+	TxRoute& route = _tx_routes[_tx_route_next];
+	_tx_route_next = ( _tx_route_next + 1 ) % tx_route_cnt;
+	route          = TxRoute{ep, std::move( mailbox )};
+	return route.mailbox.get();
+}
+
+socks::ErrorCode LoopbackSocket::_try_sendto( mart::ConstMemoryView data, const endpoint& ep ) noexcept
+{
+	if( !_network ) { return make_error( EBADF ); }
+	if( !ep.valid() ) { return make_error( EDESTADDRREQ ); }
+	if( !_rx_mailbox ) {
+		// like udp: implicitly bind to an ephemeral port, so the receiver can reply
+		const auto res = try_bind( endpoint( address_any, port_nr{} ) );
+		if( !res ) { return res; }
+	}
+
+	auto& counters = _network->_counters;
+	counters.sent.fetch_add( 1, std::memory_order_relaxed );
+
+	const LoopbackImpairments& imp = _network->_config.impairments;
+	if( imp.loss_probability > 0 && to_probability( _next_random() ) < imp.loss_probability ) {
+		counters.dropped_loss.fetch_add( 1, std::memory_order_relaxed );
+		return socks::ErrorCode::Ok();
+	}
+
+	clock_t::time_point       deliver_at{};
+	std::chrono::microseconds delay{0};
+	if( imp.delays_datagrams() ) {
+		delay = imp.latency;
+		if( imp.jitter.count() > 0 ) {
+			delay += std::chrono::microseconds(
+				static_cast<std::chrono::microseconds::rep>( _next_random() % ( imp.jitter.count() + 1 ) ) );
+		}
+		if( imp.reorder_probability > 0 && to_probability( _next_random() ) < imp.reorder_probability ) {
+			delay += imp.reorder_delay;
+		}
+		deliver_at = clock_t::now() + delay;
+	}
+
+	detail::LoopbackMailbox* const mailbox = _find_tx_route( ep );
+	if( !mailbox ) {
+		counters.dropped_no_receiver.fetch_add( 1, std::memory_order_relaxed );
+		return socks::ErrorCode::Ok();
+	}
+
+	timestamp_t rx_timestamp{};
+	if( mailbox->timestamping.load( std::memory_order_relaxed ) ) {
+		rx_timestamp = std::chrono::system_clock::now() + delay;
+	}
+
+	// the kernel reports the address of the outgoing interface instead of the any address
+	const endpoint from = _ep_local.address == address_any ? endpoint( address_local_host, _ep_local.port ) : _ep_local;
+	try {
+		if( mailbox->try_push( data, from, deliver_at, rx_timestamp ) ) {
+			counters.queued.fetch_add( 1, std::memory_order_relaxed );
+		} else {
+			counters.dropped_queue_full.fetch_add( 1, std::memory_order_relaxed );
+		}
+	} catch( const std::bad_alloc& ) {
+		return make_error( ENOMEM );
+	}
+	return socks::ErrorCode::Ok();
+}
+
+bool LoopbackSocket::try_send( mart::ConstMemoryView data ) noexcept
+{
+	return _try_sendto( data, _ep_remote ).success();
+}
+
+void LoopbackSocket::send( mart::ConstMemoryView data )
+{
+	sendto( data, _ep_remote );
+}
+
+bool LoopbackSocket::try_sendto( mart::ConstMemoryView data, endpoint ep ) noexcept
+{
+	return _try_sendto( data, ep ).success();
+}
+
+void LoopbackSocket::sendto( mart::ConstMemoryView data, endpoint ep )
+{
+	const auto res = _try_sendto( data, ep );
+	if( !res ) {
+		throw generic_nw_error( mba::concat(
+			"Failed to send data to ", ep.toStringEx(), " via loopback socket. Error Msg: ", socks::to_text_rep( res ) ) );
+	}
+}
+
+socks::ErrorCode LoopbackSocket::_try_recvfrom( mart::MemoryView buffer, RecvfromResult& result ) noexcept
+{
+	if( !_network ) { return make_error( EBADF ); }
+	if( !_rx_mailbox ) { return make_error( EINVAL ); }
+
+	try {
+		if( _rx_mailbox->try_pop( buffer, result ) ) { return socks::ErrorCode::Ok(); }
+		if( !_is_blocking ) { return {socks::ErrorCodeValues::WouldBlock}; }
+
+		const auto deadline = _rx_timeout.count() > 0 ? clock_t::now() + _rx_timeout : clock_t::time_point::max();
+		while( true ) {
+			std::this_thread::yield();
+			if( _rx_mailbox->try_pop( buffer, result ) ) { return socks::ErrorCode::Ok(); }
+			if( clock_t::now() >= deadline ) { return {socks::ErrorCodeValues::TryAgain}; }
+		}
+	} catch( const std::bad_alloc& ) {
+		return make_error( ENOMEM );
+	}
+}
+
+LoopbackSocket::RecvfromResult LoopbackSocket::try_recvfrom( mart::MemoryView buffer ) noexcept
+{
+	RecvfromResult result{};
+	_try_recvfrom( buffer, result );
+	return result;
+}
+
+LoopbackSocket::RecvfromResult LoopbackSocket::recvfrom( mart::MemoryView buffer )
+{
+	RecvfromResult result{};
+	const auto     res = _try_recvfrom( buffer, result );
+	// same as the os sockets: timeouts are not an error
+	if( !res && res.value() != socks::ErrorCodeValues::WouldBlock && res.value() != socks::ErrorCodeValues::TryAgain ) {
+		throw generic_nw_error(
+			mba::concat( "Failed to receive data via loopback socket. Error Msg: ", socks::to_text_rep( res ) ) );
+	}
+	return result;
+}
+
+void LoopbackSocket::clearRxBuff() noexcept
+{
+	if( !_rx_mailbox ) { return; }
+	std::uint64_t  buffer[8]{};
+	RecvfromResult ignored{};
+	try {
+		while( _rx_mailbox->try_pop( mart::view_bytes_mutable( buffer ), ignored ) ) {
+			;
+		}
+	} catch( const std::bad_alloc& ) {
+		// the remaining datagrams stay in the queue
+	}
+}
+
+} // namespace mart::nw::ip::udp
@@ -0,0 +1,134 @@
+#include <mart-netlib/multicast.hpp>
+
+#include <mart-netlib/detail/error_message.hpp>
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <im_str/im_str.hpp>
+
+#include <string>
+#include <string_view>
+
+namespace mart::nw::ip::udp {
+
+namespace {
+
+using socks::detail::make_error_message_with_appended_last_errno;
+
+template<class... Elements>
+void throw_on_error( socks::ErrorCode res, Elements&&... elements )
+{
+	if( !res ) {
+		throw generic_nw_error(
+			make_error_message_with_appended_last_errno( res, std::forward<Elements>( elements )... ) );
+	}
+}
+
+} // namespace
+
+void join_group( Socket& socket, address_v4 group, address_v4 interface_address )
+{
+	throw_on_error( try_join_group( socket, group, interface_address ),
+					"Could not join multicast group ",
+					group.asString(),
+					" on interface ",
+					interface_address.asString() );
+}
+
+void leave_group( Socket& socket, address_v4 group, address_v4 interface_address )
+{
+	throw_on_error( try_leave_group( socket, group, interface_address ),
+					"Could not leave multicast group ",
+					group.asString(),
+					" on interface ",
+					interface_address.asString() );
+}
+
+void join_group( Socket6& socket, const address_v6& group, std::uint32_t interface_index )
+{
+	throw_on_error( try_join_group( socket, group, interface_index ),
+					"Could not join multicast group ",
+					group.asString(),
+					" on interface ",
+					std::to_string( interface_index ) );
+}
+
+void leave_group( Socket6& socket, const address_v6& group, std::uint32_t interface_index )
+{
+	throw_on_error( try_leave_group( socket, group, interface_index ),
+					"Could not leave multicast group ",
+					group.asString(),
+					" on interface ",
+					std::to_string( interface_index ) );
+}
+
+void set_multicast_ttl( Socket& socket, int ttl )
+{
+	throw_on_error( try_set_multicast_ttl( socket, ttl ), "Could not set multicast ttl to ", std::to_string( ttl ) );
+}
+
+void set_multicast_ttl( Socket6& socket, int ttl )
+{
+	throw_on_error(
+		try_set_multicast_ttl( socket, ttl ), "Could not set multicast hop limit to ", std::to_string( ttl ) );
+}
+
+void set_multicast_loopback( Socket& socket, bool enable )
+{
+	throw_on_error( try_set_multicast_loopback( socket, enable ),
+					"Could not set multicast loopback to ",
+					enable ? "true" : "false" );
+}
+
+void set_multicast_loopback( Socket6& socket, bool enable )
+{
+	throw_on_error( try_set_multicast_loopback( socket, enable ),
+					"Could not set multicast loopback to ",
+					enable ? "true" : "false" );
+}
+
+void set_multicast_interface( Socket& socket, address_v4 interface_address )
+{
+	throw_on_error( try_set_multicast_interface( socket, interface_address ),
+					"Could not set outgoing multicast interface to ",
+					interface_address.asString() );
+}
+
+void set_multicast_interface( Socket6& socket, std::uint32_t interface_index )
+{
+	throw_on_error( try_set_multicast_interface( socket, interface_index ),
+					"Could not set outgoing multicast interface to ",
+					std::to_string( interface_index ) );
+}
+
+template<class SocketT>
+BasicMulticastPublisher<SocketT>::BasicMulticastPublisher( const endpoint&        group,
+														   const MulticastConfig& config,
+														   interface_type         iface )
+	: _group( SocketT::prepare( group ) )
+{
+	set_multicast_ttl( _socket, config.ttl );
+	set_multicast_loopback( _socket, config.loopback );
+	if( iface != detail::multicast_traits<SocketT>::default_interface ) { set_multicast_interface( _socket, iface ); }
+}
+
+template<class SocketT>
+BasicMulticastSubscriber<SocketT>::BasicMulticastSubscriber( const endpoint& group, interface_type iface )
+	: _group( group )
+{
+	_socket.set_reuse_address( true );
+#ifdef MBA_UTILS_USE_WINSOCKS
+	// windows doesn't allow binding to a multicast address
+	_socket.bind( endpoint( detail::multicast_traits<SocketT>::any_address, group.port ) );
+#else
+	// binding to the group (instead of the any address) filters out unicast datagrams to the same port
+	_socket.bind( group );
+#endif
+	join_group( _socket, group.address, iface );
+}
+
+template class BasicMulticastPublisher<Socket>;
+template class BasicMulticastPublisher<Socket6>;
+template class BasicMulticastSubscriber<Socket>;
+template class BasicMulticastSubscriber<Socket6>;
+
+} // namespace mart::nw::ip::udp
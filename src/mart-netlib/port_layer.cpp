@@ -15,9 +15,11 @@
  */
 
 /* ######## INCLUDES ######### */
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring> // memcpy
+#include <memory>
 #include <new>     // launder
 #include <type_traits>
 
@@ -44,17 +46,35 @@
 #include <WinSock2.h>
 #include <Ws2tcpip.h>
 #include <afunix.h>
+#include <MSWSock.h> // TransmitFile
+#include <iphlpapi.h> // if_nametoindex / if_indextoname
 #pragma comment( lib, "Ws2_32.lib" )
+#pragma comment( lib, "Mswsock.lib" )
+#pragma comment( lib, "Iphlpapi.lib" )
 
 #else
 #include <arpa/inet.h>
 #include <cerrno>
 #include <fcntl.h>
-#include <netdb.h> //addrinfo
+#include <net/if.h> // if_nametoindex / if_indextoname
+#include <netdb.h>  //addrinfo
+#include <netinet/in.h>
+#include <netinet/tcp.h> // TCP_NODELAY, TCP_QUICKACK
+#include <netinet/udp.h> // UDP_SEGMENT, UDP_GRO
+#include <poll.h>
+#include <pthread.h> // pthread_sigmask
+#include <signal.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h> //iovec
 #include <sys/un.h>
+#include <time.h> //timespec
 #include <unistd.h> //close
+
+#ifdef __linux__
+#include <linux/filter.h>  // sock_filter, SKF_AD_CPU
+#include <sys/sendfile.h>
+#endif
 #endif
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -333,6 +353,10 @@ int to_native( SocketOptionLevel level )
 {
 	switch( level ) {
 		case mart::nw::socks::SocketOptionLevel::Socket: return SOL_SOCKET; break;
+		case mart::nw::socks::SocketOptionLevel::Ip: return IPPROTO_IP; break;
+		case mart::nw::socks::SocketOptionLevel::Ipv6: return IPPROTO_IPV6; break;
+		case mart::nw::socks::SocketOptionLevel::Tcp: return IPPROTO_TCP; break;
+		case mart::nw::socks::SocketOptionLevel::Udp: return IPPROTO_UDP; break;
 	}
 	assert( false );
 	return static_cast<int>( level );
@@ -344,6 +368,45 @@ int to_native( SocketOption option )
 		case mart::nw::socks::SocketOption::so_rcvtimeo: return SO_RCVTIMEO; break;
 		case mart::nw::socks::SocketOption::so_sndtimeo: return SO_SNDTIMEO; break;
 		case mart::nw::socks::SocketOption::so_reuseaddr: return SO_REUSEADDR; break;
+		case mart::nw::socks::SocketOption::so_rcvbuf: return SO_RCVBUF; break;
+		case mart::nw::socks::SocketOption::so_sndbuf: return SO_SNDBUF; break;
+		case mart::nw::socks::SocketOption::ip_tos: return IP_TOS; break;
+		case mart::nw::socks::SocketOption::ipv6_v6only: return IPV6_V6ONLY; break;
+		case mart::nw::socks::SocketOption::ipv6_tclass: return IPV6_TCLASS; break;
+		case mart::nw::socks::SocketOption::tcp_nodelay: return TCP_NODELAY; break;
+		// options that are not available on all platforms - let the native call fail if they are not supported
+#ifdef SO_REUSEPORT
+		case mart::nw::socks::SocketOption::so_reuseport: return SO_REUSEPORT; break;
+#else
+		case mart::nw::socks::SocketOption::so_reuseport: return -1; break;
+#endif
+#ifdef SO_BUSY_POLL
+		case mart::nw::socks::SocketOption::so_busy_poll: return SO_BUSY_POLL; break;
+#else
+		case mart::nw::socks::SocketOption::so_busy_poll: return -1; break;
+#endif
+#ifdef SO_PRIORITY
+		case mart::nw::socks::SocketOption::so_priority: return SO_PRIORITY; break;
+#else
+		case mart::nw::socks::SocketOption::so_priority: return -1; break;
+#endif
+#ifdef SO_TIMESTAMPNS
+		case mart::nw::socks::SocketOption::so_timestampns: return SO_TIMESTAMPNS; break;
+#else
+		case mart::nw::socks::SocketOption::so_timestampns: return -1; break;
+#endif
+#ifdef TCP_QUICKACK
+		case mart::nw::socks::SocketOption::tcp_quickack: return TCP_QUICKACK; break;
+#else
+		case mart::nw::socks::SocketOption::tcp_quickack: return -1; break;
+#endif
+#if defined( UDP_SEGMENT ) && defined( UDP_GRO )
+		case mart::nw::socks::SocketOption::udp_segment: return UDP_SEGMENT; break;
+		case mart::nw::socks::SocketOption::udp_gro: return UDP_GRO; break;
+#else
+		case mart::nw::socks::SocketOption::udp_segment: return -1; break;
+		case mart::nw::socks::SocketOption::udp_gro: return -1; break;
+#endif
 	}
 	assert( false );
 	return static_cast<int>( option );
@@ -370,6 +433,110 @@ ErrorCode getsockopt( handle_t handle, SocketOptionLevel level, SocketOption opt
 	return get_appropriate_error_code( ret );
 }
 
+ErrorCode attach_reuseport_cpu_steering( handle_t handle ) noexcept
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+	// A = index of the current cpu; return A
+	::sock_filter code[] = {
+		{BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<std::uint32_t>( SKF_AD_OFF + SKF_AD_CPU )},
+		{BPF_RET | BPF_A, 0, 0, 0},
+	};
+	::sock_fprog prog{};
+	prog.len    = static_cast<unsigned short>( sizeof( code ) / sizeof( code[0] ) );
+	prog.filter = code;
+
+	return get_appropriate_error_code(
+		::setsockopt( to_native( handle ), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof( prog ) ) );
+#else
+	(void)handle;
+	return ErrorCode{static_cast<ErrorCode::Value_t>( ENOPROTOOPT )};
+#endif
+}
+
+namespace {
+
+template<class T>
+ErrorCode set_native_option( handle_t handle, int level, int optname, const T& value ) noexcept
+{
+	return get_appropriate_error_code( ::setsockopt(
+		to_native( handle ), level, optname, reinterpret_cast<const char*>( &value ), static_cast<int>( sizeof( T ) ) ) );
+}
+
+::ip_mreq make_ip_mreq( uint32_net_t group, uint32_net_t interface_address ) noexcept
+{
+	::ip_mreq req{};
+	req.imr_multiaddr.s_addr = to_utype( group );
+	req.imr_interface.s_addr = to_utype( interface_address );
+	return req;
+}
+
+::ipv6_mreq make_ipv6_mreq( const std::array<std::uint8_t, 16>& group, std::uint32_t interface_index ) noexcept
+{
+	::ipv6_mreq req{};
+	std::memcpy( &req.ipv6mr_multiaddr, group.data(), group.size() );
+	req.ipv6mr_interface = interface_index;
+	return req;
+}
+
+// On the BSDs (including macOS) the ipv4 multicast ttl and loop options only accept a single byte
+#if defined( MBA_UTILS_USE_WINSOCKS ) || defined( __linux__ )
+using ipv4_multicast_option_t = int;
+#else
+using ipv4_multicast_option_t = unsigned char;
+#endif
+
+} // namespace
+
+ErrorCode join_multicast_group( handle_t handle, uint32_net_t group, uint32_net_t interface_address ) noexcept
+{
+	return set_native_option( handle, IPPROTO_IP, IP_ADD_MEMBERSHIP, make_ip_mreq( group, interface_address ) );
+}
+
+ErrorCode leave_multicast_group( handle_t handle, uint32_net_t group, uint32_net_t interface_address ) noexcept
+{
+	return set_native_option( handle, IPPROTO_IP, IP_DROP_MEMBERSHIP, make_ip_mreq( group, interface_address ) );
+}
+
+ErrorCode
+join_multicast_group( handle_t handle, const std::array<std::uint8_t, 16>& group, std::uint32_t interface_index ) noexcept
+{
+	return set_native_option( handle, IPPROTO_IPV6, IPV6_JOIN_GROUP, make_ipv6_mreq( group, interface_index ) );
+}
+
+ErrorCode
+leave_multicast_group( handle_t handle, const std::array<std::uint8_t, 16>& group, std::uint32_t interface_index ) noexcept
+{
+	return set_native_option( handle, IPPROTO_IPV6, IPV6_LEAVE_GROUP, make_ipv6_mreq( group, interface_index ) );
+}
+
+ErrorCode set_multicast_ttl( handle_t handle, Domain domain, int ttl ) noexcept
+{
+	if( domain == Domain::Inet6 ) { return set_native_option( handle, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, ttl ); }
+	return set_native_option(
+		handle, IPPROTO_IP, IP_MULTICAST_TTL, static_cast<ipv4_multicast_option_t>( ttl ) );
+}
+
+ErrorCode set_multicast_loopback( handle_t handle, Domain domain, bool enable ) noexcept
+{
+	if( domain == Domain::Inet6 ) {
+		return set_native_option( handle, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, static_cast<unsigned int>( enable ) );
+	}
+	return set_native_option(
+		handle, IPPROTO_IP, IP_MULTICAST_LOOP, static_cast<ipv4_multicast_option_t>( enable ) );
+}
+
+ErrorCode set_multicast_interface( handle_t handle, uint32_net_t interface_address ) noexcept
+{
+	::in_addr addr{};
+	addr.s_addr = to_utype( interface_address );
+	return set_native_option( handle, IPPROTO_IP, IP_MULTICAST_IF, addr );
+}
+
+ErrorCode set_multicast_interface( handle_t handle, std::uint32_t interface_index ) noexcept
+{
+	return set_native_option( handle, IPPROTO_IPV6, IPV6_MULTICAST_IF, interface_index );
+}
+
 ErrorCode getsockname( handle_t handle, Sockaddr& addr ) noexcept
 {
 	auto       len = to_native_addr_len( addr.size() );
@@ -378,6 +545,70 @@ ErrorCode getsockname( handle_t handle, Sockaddr& addr ) noexcept
 	return get_appropriate_error_code( ret );
 }
 
+ErrorCode get_socket_error( handle_t handle ) noexcept
+{
+	int           error = 0;
+	address_len_t len   = sizeof( error );
+	const auto    ret
+		= ::getsockopt( to_native( handle ), SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>( &error ), &len );
+	if( ret != 0 ) { return get_last_socket_error(); }
+	return ErrorCode{ static_cast<ErrorCode::Value_t>( error ) };
+}
+
+namespace {
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+using native_pollfd_t = ::WSAPOLLFD;
+// POLLIN would include POLLRDBAND, which WSAPoll rejects
+constexpr short native_poll_in  = POLLRDNORM;
+constexpr short native_poll_out = POLLWRNORM;
+#else
+using native_pollfd_t = ::pollfd;
+constexpr short native_poll_in  = POLLIN;
+constexpr short native_poll_out = POLLOUT;
+#endif
+
+ReturnValue<int> poll_impl( PollEntry* entries, native_pollfd_t* fds, std::size_t entry_cnt, int timeout_ms ) noexcept
+{
+	for( std::size_t i = 0; i < entry_cnt; ++i ) {
+		fds[i].fd     = to_native( entries[i].handle );
+		fds[i].events = static_cast<short>( ( entries[i].events & poll_in ? native_poll_in : 0 )
+											| ( entries[i].events & poll_out ? native_poll_out : 0 ) );
+		fds[i].revents = 0;
+	}
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+	const int ret = ::WSAPoll( fds, static_cast<ULONG>( entry_cnt ), timeout_ms );
+#else
+	const int ret = ::poll( fds, static_cast<::nfds_t>( entry_cnt ), timeout_ms );
+#endif
+	if( ret < 0 ) { return ReturnValue<int>( get_last_socket_error() ); }
+
+	for( std::size_t i = 0; i < entry_cnt; ++i ) {
+		const short r       = fds[i].revents;
+		entries[i].revents = static_cast<short>( ( r & native_poll_in ? poll_in : 0 )
+												 | ( r & native_poll_out ? poll_out : 0 )
+												 | ( r & ( POLLERR | POLLHUP | POLLNVAL ) ? poll_error : 0 ) );
+	}
+	return ReturnValue<int>( ret );
+}
+
+} // namespace
+
+ReturnValue<int> poll( PollEntry* entries, std::size_t entry_cnt, int timeout_ms ) noexcept
+{
+	// avoid the allocation for the common case of a few sockets
+	constexpr std::size_t small_cnt = 64;
+	if( entry_cnt <= small_cnt ) {
+		native_pollfd_t fds[small_cnt];
+		return poll_impl( entries, fds, entry_cnt, timeout_ms );
+	}
+
+	std::unique_ptr<native_pollfd_t[]> fds( new( std::nothrow ) native_pollfd_t[entry_cnt] );
+	if( !fds ) { return ReturnValue<int>( ErrorCode{ static_cast<ErrorCode::Value_t>( ENOMEM ) } ); }
+	return poll_impl( entries, fds.get(), entry_cnt, timeout_ms );
+}
+
 const ::sockaddr* to_native( const Sockaddr* addr )
 {
 	return static_cast<const ::sockaddr*>( static_cast<const void*>( addr ) );
@@ -413,6 +644,31 @@ ReturnValue<handle_t> accept( handle_t handle, Sockaddr& addr ) noexcept
 	return make_return_value( handle_t::Invalid, ret );
 }
 
+ReturnValue<handle_t> accept4( handle_t handle, Sockaddr& addr, bool non_blocking ) noexcept
+{
+#ifdef __linux__
+	const int  flags    = SOCK_CLOEXEC | ( non_blocking ? SOCK_NONBLOCK : 0 );
+	auto       addr_len = to_native_addr_len( addr.size() );
+	const auto ret
+		= static_cast<handle_t>( ::accept4( to_native( handle ), addr.to_native_ptr(), &addr_len, flags ) );
+	addr.set_valid_data_range( addr_len );
+	return make_return_value( handle_t::Invalid, ret );
+#else
+	auto res = accept( handle, addr );
+	if( !res ) { return res; }
+#ifndef MBA_UTILS_USE_WINSOCKS
+	::fcntl( to_native( res.value() ), F_SETFD, FD_CLOEXEC );
+#endif
+	// NOTE: on windows, the accepted socket inherits the mode of the listening socket, so always set it
+	const auto err = set_blocking( res.value(), !non_blocking );
+	if( !err ) {
+		close_socket( res.value() );
+		return ReturnValue<handle_t>( err );
+	}
+	return res;
+#endif
+}
+
 ReturnValue<handle_t> accept( handle_t handle ) noexcept
 {
 	return make_return_value( handle_t::Invalid, static_cast<handle_t>( ::accept( to_native( handle ), nullptr, 0 ) ) );
@@ -481,6 +737,323 @@ ReturnValue<txrx_size_t> recvfrom( handle_t handle, byte_range_mut buf, int flag
 	return make_return_value( txrx_size_t{ -1 }, ret );
 }
 
+// implementation details for scatter/gather functions
+namespace {
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+using native_io_buffer_t = ::WSABUF;
+
+::WSABUF to_native_io_buffer( byte_range buffer )
+{
+	::WSABUF ret{};
+	ret.buf = const_cast<char*>( buffer.char_ptr() ); // WSASend doesn't modify the data
+	ret.len = narrow_cast<ULONG>( buffer.size() );
+	return ret;
+}
+#else
+using native_io_buffer_t = ::iovec;
+
+::iovec to_native_io_buffer( byte_range buffer )
+{
+	::iovec ret{};
+	ret.iov_base = const_cast<unsigned char*>( buffer.data() ); // sendmsg doesn't modify the data
+	ret.iov_len  = buffer.size();
+	return ret;
+}
+#endif
+
+template<class Range>
+bool to_native_io_buffers( const Range* buffers, std::size_t buffer_cnt, native_io_buffer_t* native ) noexcept
+{
+	if( buffer_cnt > max_io_buffer_cnt ) { return false; }
+	for( std::size_t i = 0; i < buffer_cnt; ++i ) {
+		native[i] = to_native_io_buffer( buffers[i] );
+	}
+	return true;
+}
+
+ReturnValue<txrx_size_t>
+sendmsg_impl( handle_t handle, const byte_range* buffers, std::size_t buffer_cnt, int flags, const Sockaddr* to )
+{
+	native_io_buffer_t native_buffers[max_io_buffer_cnt];
+	if( !to_native_io_buffers( buffers, buffer_cnt, native_buffers ) ) {
+		return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+	DWORD      bytes_sent = 0;
+	const auto ret        = ::WSASendTo( to_native( handle ),
+                                  native_buffers,
+                                  narrow_cast<DWORD>( buffer_cnt ),
+                                  &bytes_sent,
+                                  narrow_cast<DWORD>( flags ),
+                                  to ? to->to_native_ptr() : nullptr,
+                                  to ? to_native_addr_len( to->size() ) : 0,
+                                  nullptr,
+                                  nullptr );
+	if( ret != 0 ) { return ReturnValue<txrx_size_t>( get_last_socket_error() ); }
+	return ReturnValue<txrx_size_t>( narrow_cast<txrx_size_t>( bytes_sent ) );
+#else
+	::msghdr msg{};
+	msg.msg_name    = to ? const_cast<::sockaddr*>( to->to_native_ptr() ) : nullptr;
+	msg.msg_namelen = to ? to_native_addr_len( to->size() ) : 0;
+	msg.msg_iov     = native_buffers;
+	msg.msg_iovlen  = buffer_cnt;
+
+	return make_return_value( txrx_size_t{ -1 }, ::sendmsg( to_native( handle ), &msg, flags | MSG_NOSIGNAL ) );
+#endif
+}
+
+#ifndef MBA_UTILS_USE_WINSOCKS
+// enough space for all control messages evaluated by extract_recv_msg_info
+constexpr std::size_t recv_msg_control_size = CMSG_SPACE( sizeof( int ) ) + CMSG_SPACE( sizeof( ::timespec ) );
+
+void extract_recv_msg_info( ::msghdr& msg, RecvMsgInfo& info )
+{
+	for( ::cmsghdr* cmsg = CMSG_FIRSTHDR( &msg ); cmsg != nullptr; cmsg = CMSG_NXTHDR( &msg, cmsg ) ) {
+#ifdef UDP_GRO
+		if( cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO ) {
+			std::memcpy( &info.segment_size, CMSG_DATA( cmsg ), sizeof( info.segment_size ) );
+		}
+#endif
+#ifdef SCM_TIMESTAMPNS
+		if( cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS ) {
+			::timespec ts{};
+			std::memcpy( &ts, CMSG_DATA( cmsg ), sizeof( ts ) );
+			info.rx_timestamp = std::chrono::seconds( ts.tv_sec ) + std::chrono::nanoseconds( ts.tv_nsec );
+		}
+#endif
+	}
+}
+#endif
+
+ReturnValue<txrx_size_t> recvmsg_impl( handle_t              handle,
+									   const byte_range_mut* buffers,
+									   std::size_t           buffer_cnt,
+									   int                   flags,
+									   Sockaddr*             from,
+									   RecvMsgInfo*          info )
+{
+	if( info ) { *info = RecvMsgInfo{}; }
+
+	native_io_buffer_t native_buffers[max_io_buffer_cnt];
+	if( !to_native_io_buffers( buffers, buffer_cnt, native_buffers ) ) {
+		return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+	DWORD bytes_received = 0;
+	DWORD native_flags   = narrow_cast<DWORD>( flags );
+	auto  from_len       = from ? to_native_addr_len( from->size() ) : 0;
+
+	const auto ret = ::WSARecvFrom( to_native( handle ),
+									native_buffers,
+									narrow_cast<DWORD>( buffer_cnt ),
+									&bytes_received,
+									&native_flags,
+									from ? from->to_native_ptr() : nullptr,
+									from ? &from_len : nullptr,
+									nullptr,
+									nullptr );
+	if( ret != 0 ) { return ReturnValue<txrx_size_t>( get_last_socket_error() ); }
+	if( from ) { from->set_valid_data_range( from_len ); }
+	return ReturnValue<txrx_size_t>( narrow_cast<txrx_size_t>( bytes_received ) );
+#else
+	::msghdr msg{};
+	msg.msg_name    = from ? from->to_native_ptr() : nullptr;
+	msg.msg_namelen = from ? to_native_addr_len( from->size() ) : 0;
+	msg.msg_iov     = native_buffers;
+	msg.msg_iovlen  = buffer_cnt;
+
+	alignas( ::cmsghdr ) char control[recv_msg_control_size];
+	if( info ) {
+		msg.msg_control    = control;
+		msg.msg_controllen = sizeof( control );
+	}
+
+	const auto ret = ::recvmsg( to_native( handle ), &msg, flags );
+	if( from ) { from->set_valid_data_range( msg.msg_namelen ); }
+	if( info && ret >= 0 ) { extract_recv_msg_info( msg, *info ); }
+	return make_return_value( txrx_size_t{ -1 }, ret );
+#endif
+}
+
+} // namespace
+
+ReturnValue<txrx_size_t> sendmsg( handle_t handle, const byte_range* buffers, std::size_t buffer_cnt, int flags ) noexcept
+{
+	return sendmsg_impl( handle, buffers, buffer_cnt, flags, nullptr );
+}
+
+ReturnValue<txrx_size_t>
+sendmsg( handle_t handle, const byte_range* buffers, std::size_t buffer_cnt, int flags, const Sockaddr& to ) noexcept
+{
+	// see sendto
+	if( is_invalid_destination_address( to ) ) {
+		return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+	return sendmsg_impl( handle, buffers, buffer_cnt, flags, &to );
+}
+
+ReturnValue<txrx_size_t>
+recvmsg( handle_t handle, const byte_range_mut* buffers, std::size_t buffer_cnt, int flags ) noexcept
+{
+	return recvmsg_impl( handle, buffers, buffer_cnt, flags, nullptr, nullptr );
+}
+
+ReturnValue<txrx_size_t>
+recvmsg( handle_t handle, const byte_range_mut* buffers, std::size_t buffer_cnt, int flags, Sockaddr& from ) noexcept
+{
+	return recvmsg_impl( handle, buffers, buffer_cnt, flags, &from, nullptr );
+}
+
+ReturnValue<txrx_size_t> recvmsg( handle_t              handle,
+								  const byte_range_mut* buffers,
+								  std::size_t           buffer_cnt,
+								  int                   flags,
+								  Sockaddr&             from,
+								  RecvMsgInfo&          info ) noexcept
+{
+	return recvmsg_impl( handle, buffers, buffer_cnt, flags, &from, &info );
+}
+
+/* ############# Zero copy file transmission ############# */
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+
+ReturnValue<file_handle_t> open_file_read_only( const char* path ) noexcept
+{
+	const HANDLE file = ::CreateFileA(
+		path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if( file == INVALID_HANDLE_VALUE ) { return ReturnValue<file_handle_t>( get_last_socket_error() ); }
+	return ReturnValue<file_handle_t>( file );
+}
+
+ErrorCode close_file( file_handle_t file ) noexcept
+{
+	return get_appropriate_error_code( ::CloseHandle( file ) != 0 );
+}
+
+ReturnValue<txrx_size_t> send_file( handle_t handle, file_handle_t file, std::uint64_t offset, std::size_t count ) noexcept
+{
+	// TransmitFile sends the whole file if asked for 0 bytes and doesn't report how much it sent at the end of the
+	// file, so clamp the count to the remaining size
+	LARGE_INTEGER size{};
+	if( !::GetFileSizeEx( file, &size ) ) { return ReturnValue<txrx_size_t>( get_last_socket_error() ); }
+	const auto file_size = static_cast<std::uint64_t>( size.QuadPart );
+	if( offset >= file_size || count == 0 ) { return ReturnValue<txrx_size_t>( 0 ); }
+	count = static_cast<std::size_t>( std::min<std::uint64_t>( { count, file_size - offset, max_send_file_chunk } ) );
+
+	// without an OVERLAPPED structure, TransmitFile starts at the current file position
+	LARGE_INTEGER pos{};
+	pos.QuadPart = static_cast<LONGLONG>( offset );
+	if( !::SetFilePointerEx( file, pos, nullptr, FILE_BEGIN ) ) {
+		return ReturnValue<txrx_size_t>( get_last_socket_error() );
+	}
+	if( !::TransmitFile( to_native( handle ), file, static_cast<DWORD>( count ), 0, nullptr, nullptr, 0 ) ) {
+		return ReturnValue<txrx_size_t>( get_last_socket_error() );
+	}
+	return ReturnValue<txrx_size_t>( static_cast<txrx_size_t>( count ) );
+}
+
+#else
+
+ReturnValue<file_handle_t> open_file_read_only( const char* path ) noexcept
+{
+	return make_return_value( file_handle_t{ -1 }, ::open( path, O_RDONLY | O_CLOEXEC ) );
+}
+
+ErrorCode close_file( file_handle_t file ) noexcept
+{
+	return get_appropriate_error_code( ::close( file ) );
+}
+
+namespace {
+
+#if defined( __linux__ ) || defined( __APPLE__ ) || defined( __FreeBSD__ )
+// Unlike send, sendfile has no MSG_NOSIGNAL. So SIGPIPE is blocked for the duration of the call
+// and discarded afterwards, if the call raised it (which can happen even if it reports a partial success)
+class ScopedSigpipeBlock {
+public:
+	ScopedSigpipeBlock() noexcept
+	{
+		sigemptyset( &_sigpipe );
+		sigaddset( &_sigpipe, SIGPIPE );
+
+		// if a SIGPIPE is pending already, it isn't ours to discard
+		_was_pending = is_pending();
+		if( !_was_pending ) { pthread_sigmask( SIG_BLOCK, &_sigpipe, &_old_mask ); }
+	}
+	ScopedSigpipeBlock( const ScopedSigpipeBlock& ) = delete;
+	ScopedSigpipeBlock& operator=( const ScopedSigpipeBlock& ) = delete;
+
+	~ScopedSigpipeBlock()
+	{
+		if( _was_pending ) { return; }
+		const int saved_errno = errno;
+		if( is_pending() ) {
+			int sig = 0;
+			sigwait( &_sigpipe, &sig );
+		}
+		pthread_sigmask( SIG_SETMASK, &_old_mask, nullptr );
+		errno = saved_errno;
+	}
+
+private:
+	static bool is_pending() noexcept
+	{
+		sigset_t pending;
+		sigemptyset( &pending );
+		sigpending( &pending );
+		return sigismember( &pending, SIGPIPE ) == 1;
+	}
+
+	sigset_t _sigpipe;
+	sigset_t _old_mask;
+	bool     _was_pending = false;
+};
+#endif
+
+} // namespace
+
+ReturnValue<txrx_size_t> send_file( handle_t handle, file_handle_t file, std::uint64_t offset, std::size_t count ) noexcept
+{
+	count = std::min( count, max_send_file_chunk );
+	if( count == 0 ) { return ReturnValue<txrx_size_t>( 0 ); }
+
+#if defined( __linux__ )
+	const ScopedSigpipeBlock sigpipe_block;
+
+	::off_t    off = static_cast<::off_t>( offset );
+	const auto ret = ::sendfile( to_native( handle ), file, &off, count );
+	return make_return_value( txrx_size_t{ -1 }, static_cast<txrx_size_t>( ret ) );
+#elif defined( __APPLE__ ) || defined( __FreeBSD__ )
+	const ScopedSigpipeBlock sigpipe_block;
+
+	::off_t sent = 0;
+#if defined( __APPLE__ )
+	sent           = static_cast<::off_t>( count );
+	const auto ret = ::sendfile( file, to_native( handle ), static_cast<::off_t>( offset ), &sent, nullptr, 0 );
+#else
+	const auto ret = ::sendfile( file, to_native( handle ), static_cast<::off_t>( offset ), count, nullptr, &sent, 0 );
+#endif
+	// On non-blocking sockets, sendfile can fail with EAGAIN after it sent part of the data
+	if( ret == 0 || ( errno == EAGAIN && sent > 0 ) ) {
+		return ReturnValue<txrx_size_t>( static_cast<txrx_size_t>( sent ) );
+	}
+	return ReturnValue<txrx_size_t>( get_last_socket_error() );
+#else
+	// no sendfile: go through a (small) user space buffer
+	char       buffer[16 * 1024];
+	const auto read = ::pread( file, buffer, std::min( count, sizeof( buffer ) ), static_cast<::off_t>( offset ) );
+	if( read <= 0 ) { return make_return_value( txrx_size_t{ -1 }, static_cast<txrx_size_t>( read ) ); }
+	return make_return_value( txrx_size_t{ -1 },
+							  ::send( to_native( handle ), buffer, static_cast<std::size_t>( read ), MSG_NOSIGNAL ) );
+#endif
+}
+
+#endif // MBA_UTILS_USE_WINSOCKS
+
 // implementation details for timeout related functions
 // Todo: move into general utilities
 namespace {
@@ -615,6 +1188,28 @@ const ::sockaddr_in6& SockaddrIn6::native() const noexcept
 	return *MBA_LAUNDER( reinterpret_cast<::sockaddr_in6*>( _storage.raw_bytes ) );
 }
 
+namespace {
+
+::sockaddr_in6
+make_sockaddr_in6( const std::array<std::uint8_t, 16>& address, mart::nw::uint16_net_t port, std::uint32_t scope_id )
+{
+	::sockaddr_in6 native{};
+	native.sin6_family   = AF_INET6;
+	native.sin6_port     = to_utype( port );
+	native.sin6_scope_id = scope_id;
+	std::memcpy( native.sin6_addr.s6_addr, address.data(), 16 );
+	return native;
+}
+
+} // namespace
+
+SockaddrIn6::SockaddrIn6( const std::array<std::uint8_t, 16>& address,
+						  mart::nw::uint16_net_t              port,
+						  std::uint32_t                       scope_id ) noexcept
+	: SockaddrIn6::SockaddrIn6( make_sockaddr_in6( address, port, scope_id ) )
+{
+}
+
 std::array<std::uint8_t, 16> SockaddrIn6::address() const noexcept
 {
 	std::array<std::uint8_t, 16> ret;
@@ -622,6 +1217,16 @@ std::array<std::uint8_t, 16> SockaddrIn6::address() const noexcept
 	return ret;
 }
 
+mart::nw::uint16_net_t SockaddrIn6::port() const noexcept
+{
+	return static_cast<mart::nw::uint16_net_t>( native().sin6_port );
+}
+
+std::uint32_t SockaddrIn6::scope_id() const noexcept
+{
+	return native().sin6_scope_id;
+}
+
 namespace {
 
 ::sockaddr_un make_sockaddr_un( const char* u8path, std::size_t length )
@@ -776,6 +1381,21 @@ int inet_pres_to_net( Domain af, const char* src, void* dst )
 	return inet_pton( to_native( af ), src, dst );
 }
 
+std::uint32_t interface_name_to_index( const char* name ) noexcept
+{
+	return static_cast<std::uint32_t>( ::if_nametoindex( name ) );
+}
+
+bool interface_index_to_name( std::uint32_t index, char* dst, std::size_t size ) noexcept
+{
+	char buffer[IF_NAMESIZE + 1]{};
+	if( index == 0 || ::if_indextoname( index, buffer ) == nullptr ) { return false; }
+	const std::size_t len = std::strlen( buffer );
+	if( len + 1 > size ) { return false; }
+	std::memcpy( dst, buffer, len + 1 );
+	return true;
+}
+
 namespace {
 
 ::addrinfo to_native_hint( const AddrInfo& address_info ) noexcept
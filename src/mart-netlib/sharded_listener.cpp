@@ -0,0 +1,35 @@
+#include <mart-netlib/sharded_listener.hpp>
+
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#elif defined( _WIN32 )
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+namespace mart::nw::ip::detail {
+
+bool pin_current_thread_to_cpu( unsigned cpu ) noexcept
+{
+#if defined( __linux__ )
+	if( cpu >= CPU_SETSIZE ) { return false; }
+	cpu_set_t set;
+	CPU_ZERO( &set );
+	CPU_SET( cpu, &set );
+	return ::pthread_setaffinity_np( ::pthread_self(), sizeof( set ), &set ) == 0;
+#elif defined( _WIN32 )
+	if( cpu >= sizeof( DWORD_PTR ) * 8 ) { return false; }
+	return ::SetThreadAffinityMask( ::GetCurrentThread(), DWORD_PTR{1} << cpu ) != 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+} // namespace mart::nw::ip::detail
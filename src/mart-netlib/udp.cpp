@@ -206,4 +206,5 @@
 
 namespace mart::nw::socks::detail {
 template class DgramSocket<mart::nw::ip::udp::endpoint>;
+template class DgramSocket<mart::nw::ip::udp::endpoint_v6>;
 }
\ No newline at end of file
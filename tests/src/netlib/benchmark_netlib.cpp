@@ -0,0 +1,759 @@
+/*
+ * Throughput / latency benchmarks for mart-netlib over loopback.
+ *
+ * Each result is printed as one json object per line (json lines) to stdout or the file given with --out,
+ * a human readable summary goes to stderr.
+ *
+ * Usage: benchmark_mart-netlib [--quick] [--filter <substring of benchmark name>] [--out <file>]
+ */
+#include <mart-netlib/framed_stream.hpp>
+#include <mart-netlib/loopback_transport.hpp>
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+#ifdef MART_NETLIB_BENCHMARK_UNIX_DOMAIN_SOCKETS
+#include <mart-netlib/unix.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace mart::nw::ip;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::uint16_t udp_port_base = 3470;
+constexpr std::uint16_t tcp_port_base = 1600;
+
+struct Options {
+	bool        quick = false;
+	std::string filter;
+	std::FILE*  out = stdout;
+};
+
+Options g_options;
+
+bool is_selected( std::string_view name )
+{
+	return g_options.filter.empty() || name.find( g_options.filter ) != std::string_view::npos;
+}
+
+std::size_t scaled( std::size_t cnt )
+{
+	return g_options.quick ? std::max<std::size_t>( cnt / 20, 10 ) : cnt;
+}
+
+/* ###### Reporting ###### */
+
+struct LatencyResult {
+	std::string_view benchmark;
+	std::string_view transport;
+	std::string_view mode;
+	std::size_t      msg_size;
+	std::size_t      iterations;
+	std::size_t      timeouts;
+	double           mean_ns;
+	std::int64_t     p50_ns;
+	std::int64_t     p99_ns;
+	std::int64_t     p999_ns;
+};
+
+struct ThroughputResult {
+	std::string_view benchmark;
+	std::string_view transport;
+	std::string_view mode;
+	std::size_t      msg_size;
+	std::uint64_t    msgs_sent;
+	std::uint64_t    msgs_received;
+	std::uint64_t    bytes_received;
+	double           seconds;
+};
+
+void report( const LatencyResult& r )
+{
+	std::fprintf( g_options.out,
+				  "{\"benchmark\":\"%.*s\",\"transport\":\"%.*s\",\"mode\":\"%.*s\",\"msg_size\":%zu,"
+				  "\"iterations\":%zu,\"timeouts\":%zu,\"mean_ns\":%.1f,\"p50_ns\":%lld,\"p99_ns\":%lld,\"p999_ns\":%lld}\n",
+				  static_cast<int>( r.benchmark.size() ),
+				  r.benchmark.data(),
+				  static_cast<int>( r.transport.size() ),
+				  r.transport.data(),
+				  static_cast<int>( r.mode.size() ),
+				  r.mode.data(),
+				  r.msg_size,
+				  r.iterations,
+				  r.timeouts,
+				  r.mean_ns,
+				  static_cast<long long>( r.p50_ns ),
+				  static_cast<long long>( r.p99_ns ),
+				  static_cast<long long>( r.p999_ns ) );
+	std::fflush( g_options.out );
+
+	std::fprintf( stderr,
+				  "%-16.*s %-9.*s %-12.*s %6zuB  p50 %8.2fus  p99 %8.2fus  p999 %8.2fus\n",
+				  static_cast<int>( r.benchmark.size() ),
+				  r.benchmark.data(),
+				  static_cast<int>( r.transport.size() ),
+				  r.transport.data(),
+				  static_cast<int>( r.mode.size() ),
+				  r.mode.data(),
+				  r.msg_size,
+				  static_cast<double>( r.p50_ns ) / 1000,
+				  static_cast<double>( r.p99_ns ) / 1000,
+				  static_cast<double>( r.p999_ns ) / 1000 );
+}
+
+void report( const ThroughputResult& r )
+{
+	const double mbytes_per_s = r.seconds > 0 ? static_cast<double>( r.bytes_received ) / r.seconds / 1e6 : 0;
+	const double msgs_per_s   = r.seconds > 0 ? static_cast<double>( r.msgs_received ) / r.seconds : 0;
+	const double loss
+		= r.msgs_sent > 0 ? 1.0 - static_cast<double>( r.msgs_received ) / static_cast<double>( r.msgs_sent ) : 0;
+
+	std::fprintf( g_options.out,
+				  "{\"benchmark\":\"%.*s\",\"transport\":\"%.*s\",\"mode\":\"%.*s\",\"msg_size\":%zu,"
+				  "\"msgs_sent\":%llu,\"msgs_received\":%llu,\"bytes_received\":%llu,\"seconds\":%.6f,"
+				  "\"mbytes_per_s\":%.2f,\"msgs_per_s\":%.0f,\"loss\":%.6f}\n",
+				  static_cast<int>( r.benchmark.size() ),
+				  r.benchmark.data(),
+				  static_cast<int>( r.transport.size() ),
+				  r.transport.data(),
+				  static_cast<int>( r.mode.size() ),
+				  r.mode.data(),
+				  r.msg_size,
+				  static_cast<unsigned long long>( r.msgs_sent ),
+				  static_cast<unsigned long long>( r.msgs_received ),
+				  static_cast<unsigned long long>( r.bytes_received ),
+				  r.seconds,
+				  mbytes_per_s,
+				  msgs_per_s,
+				  loss );
+	std::fflush( g_options.out );
+
+	std::fprintf( stderr,
+				  "%-16.*s %-9.*s %-12.*s %6zuB  %9.1f MB/s  %10.0f msg/s  loss %5.2f%%\n",
+				  static_cast<int>( r.benchmark.size() ),
+				  r.benchmark.data(),
+				  static_cast<int>( r.transport.size() ),
+				  r.transport.data(),
+				  static_cast<int>( r.mode.size() ),
+				  r.mode.data(),
+				  r.msg_size,
+				  mbytes_per_s,
+				  msgs_per_s,
+				  loss * 100 );
+}
+
+LatencyResult make_latency_result( std::vector<std::int64_t>& samples_ns )
+{
+	LatencyResult r{};
+	if( samples_ns.empty() ) { return r; }
+	std::sort( samples_ns.begin(), samples_ns.end() );
+
+	const auto percentile = [&]( double p ) {
+		const auto idx = static_cast<std::size_t>( p * static_cast<double>( samples_ns.size() - 1 ) );
+		return samples_ns[idx];
+	};
+
+	double sum = 0;
+	for( auto s : samples_ns ) {
+		sum += static_cast<double>( s );
+	}
+	r.mean_ns = sum / static_cast<double>( samples_ns.size() );
+	r.p50_ns  = percentile( 0.5 );
+	r.p99_ns  = percentile( 0.99 );
+	r.p999_ns = percentile( 0.999 );
+	return r;
+}
+
+/* ###### Helper threads ###### */
+
+/*
+ * Echo / receiver thread of a benchmark.
+ *
+ * An exception escaping the thread function doesn't terminate the program, but gets rethrown on the benchmark thread
+ * and the thread is also joined, if the benchmark thread leaves the scope with an exception. stop gets called before
+ * the thread is joined and has to make the thread function return soon.
+ */
+class HelperThread {
+public:
+	template<class F>
+	explicit HelperThread( F f, std::function<void()> stop = [] {} )
+		: _stop( std::move( stop ) )
+		, _thread( [this, f = std::move( f )]() mutable {
+			try {
+				f();
+			} catch( ... ) {
+				_error = std::current_exception();
+			}
+		} )
+	{
+	}
+
+	HelperThread( const HelperThread& ) = delete;
+	HelperThread& operator=( const HelperThread& ) = delete;
+
+	~HelperThread()
+	{
+		if( _thread.joinable() ) {
+			_stop();
+			_thread.join();
+		}
+	}
+
+	// Runs f on the calling thread, joins the helper thread and rethrows the error of either side.
+	// If both failed, the error of the helper thread is reported, as it is usually the reason the other side failed
+	template<class F>
+	void run_and_join( F&& f )
+	{
+		std::exception_ptr error;
+		try {
+			f();
+		} catch( ... ) {
+			error = std::current_exception();
+		}
+		_stop();
+		_thread.join();
+		if( _error ) { std::rethrow_exception( _error ); }
+		if( error ) { std::rethrow_exception( error ); }
+	}
+
+private:
+	std::function<void()> _stop;
+	std::exception_ptr    _error;
+	std::thread           _thread; // has to be the last member, as the thread may start running right away
+};
+
+/* ###### Datagram ping-pong ###### */
+
+// spins on the non-blocking socket until a datagram arrives or the deadline passes
+// (yielding, so client and echo thread don't starve each other on machines with few cores)
+template<class SocketT>
+mart::MemoryView spin_recv( SocketT& socket, mart::MemoryView buffer, clock_type::time_point deadline )
+{
+	while( true ) {
+		auto data = socket.try_recv( buffer );
+		if( data.isValid() ) { return data; }
+		if( clock_type::now() > deadline ) { return {}; }
+		std::this_thread::yield();
+	}
+}
+
+template<class SocketT>
+void run_dgram_pingpong( std::string_view           transport,
+						 std::string_view           mode,
+						 SocketT&                   client,
+						 SocketT&                   server,
+						 typename SocketT::endpoint server_ep,
+						 std::size_t                msg_size,
+						 std::size_t                iterations )
+{
+	const bool spin = mode == "nonblocking";
+
+	std::atomic<bool> stop{false};
+	HelperThread      echo(
+		[&] {
+			std::vector<std::uint8_t> buffer( msg_size );
+			server.set_blocking( !spin );
+			server.set_rx_timeout( 10ms );
+			while( !stop.load( std::memory_order_relaxed ) ) {
+				if( spin ) {
+					auto data = server.try_recv( mart::MemoryView( buffer.data(), buffer.size() ) );
+					if( data.isValid() ) {
+						server.try_send( data );
+					} else {
+						std::this_thread::yield();
+					}
+				} else {
+					auto res = server.try_recvfrom( mart::MemoryView( buffer.data(), buffer.size() ) );
+					if( res.data.isValid() ) { server.try_sendto( res.data, res.remote_address ); }
+				}
+			}
+		},
+		[&] { stop = true; } );
+
+	std::vector<std::int64_t> samples;
+	samples.reserve( iterations );
+	std::size_t timeouts = 0;
+
+	echo.run_and_join( [&] {
+		client.connect( server_ep );
+		client.set_blocking( !spin );
+		client.set_rx_timeout( 1s );
+
+		std::vector<std::uint8_t> tx( msg_size, 0xAB );
+		std::vector<std::uint8_t> rx( msg_size );
+
+		const std::size_t warmup = std::min<std::size_t>( iterations / 10, 1000 );
+		for( std::size_t i = 0; i < warmup + iterations; ++i ) {
+			const auto start = clock_type::now();
+			client.try_send( mart::ConstMemoryView( tx.data(), tx.size() ) );
+			const auto data = spin ? spin_recv( client, mart::MemoryView( rx.data(), rx.size() ), start + 1s )
+								   : client.try_recv( mart::MemoryView( rx.data(), rx.size() ) );
+			const auto end = clock_type::now();
+			if( !data.isValid() ) {
+				++timeouts;
+				continue;
+			}
+			if( i >= warmup ) {
+				samples.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( end - start ).count() );
+			}
+		}
+	} );
+
+	LatencyResult r = make_latency_result( samples );
+	r.benchmark     = "dgram_pingpong";
+	r.transport     = transport;
+	r.mode          = mode;
+	r.msg_size      = msg_size;
+	r.iterations    = samples.size();
+	r.timeouts      = timeouts;
+	report( r );
+}
+
+void bench_udp_pingpong()
+{
+	if( !is_selected( "dgram_pingpong" ) ) { return; }
+
+	for( std::string_view mode : {"blocking", "nonblocking"} ) {
+		for( std::size_t size : {32, 256, 1024, 8192} ) {
+			const udp::endpoint server_ep{address_local_host, port_nr{udp_port_base}};
+			const udp::endpoint client_ep{address_local_host, port_nr{udp_port_base + 1}};
+
+			udp::Socket server;
+			server.bind( server_ep );
+			server.set_default_remote_endpoint( client_ep );
+			server.connect( client_ep );
+			udp::Socket client;
+			client.bind( client_ep );
+			run_dgram_pingpong( "udp", mode, client, server, server_ep, size, scaled( 20000 ) );
+		}
+	}
+
+	// the same code without the kernel - separates the library overhead from the cost of the syscalls
+	for( std::string_view mode : {"blocking", "nonblocking"} ) {
+		for( std::size_t size : {32, 256, 1024, 8192} ) {
+			udp::LoopbackNetwork network;
+			const udp::endpoint  server_ep{address_local_host, port_nr{udp_port_base}};
+			const udp::endpoint  client_ep{address_local_host, port_nr{udp_port_base + 1}};
+
+			udp::LoopbackSocket server( network, server_ep, client_ep );
+			udp::LoopbackSocket client( network );
+			client.bind( client_ep );
+			run_dgram_pingpong( "inproc", mode, client, server, server_ep, size, scaled( 20000 ) );
+		}
+	}
+}
+
+/* ###### Datagram throughput ###### */
+
+// Receives until expected_msgs arrived or nothing arrived for 200ms. Returns {messages, bytes, time of last rx}
+template<class SocketT>
+ThroughputResult receive_dgrams( SocketT& rx, std::uint64_t expected_msgs, bool coalesced )
+{
+	ThroughputResult r{};
+
+	std::vector<std::uint8_t> buffer( 64 * 1024 );
+	rx.set_rx_timeout( 200ms );
+	const auto view = mart::MemoryView( buffer.data(), buffer.size() );
+
+	while( r.msgs_received < expected_msgs ) {
+		if constexpr( std::is_same_v<SocketT, udp::Socket> ) {
+			if( coalesced ) {
+				const auto res = rx.try_recvfrom_coalesced( view );
+				if( !res.data.isValid() ) { break; }
+				r.bytes_received += res.data.size();
+				r.msgs_received += ( res.data.size() + res.segment_size - 1 ) / res.segment_size;
+				continue;
+			}
+		}
+		const auto data = rx.try_recv( view );
+		if( !data.isValid() ) { break; }
+		r.bytes_received += data.size();
+		++r.msgs_received;
+	}
+	return r;
+}
+
+template<class SocketT>
+void run_dgram_throughput( std::string_view           transport,
+						   std::string_view           mode,
+						   SocketT&                   tx,
+						   SocketT&                   rx,
+						   typename SocketT::endpoint rx_ep,
+						   std::size_t                msg_size,
+						   std::uint64_t              msg_cnt )
+{
+	const bool gso = mode == "gso_gro";
+
+	ThroughputResult       r{};
+	clock_type::time_point start;
+	std::atomic<bool>      started{false};
+
+	// if the sender fails before it started, the receiver gives up after its receive timeout
+	HelperThread receiver(
+		[&] {
+			while( !started.load() ) {
+				std::this_thread::yield();
+			}
+			r = receive_dgrams( rx, msg_cnt, gso );
+		},
+		[&] { started = true; } );
+
+	receiver.run_and_join( [&] {
+		std::vector<std::uint8_t> payload( msg_size, 0xCD );
+
+		start   = clock_type::now();
+		started = true;
+		if constexpr( std::is_same_v<SocketT, udp::Socket> ) {
+			if( gso ) {
+				// as many datagrams per call, as the kernel accepts
+				const std::size_t per_call
+					= std::max<std::size_t>( 1, std::min<std::size_t>( 64, 65000 / msg_size ) );
+				payload.resize( per_call * msg_size, 0xCD );
+				tx.set_tx_segment_size( static_cast<std::uint16_t>( msg_size ) );
+				const auto ep = SocketT::prepare( rx_ep );
+				for( std::uint64_t sent = 0; sent < msg_cnt; sent += per_call ) {
+					const auto n = std::min<std::uint64_t>( per_call, msg_cnt - sent );
+					tx.try_sendto( mart::ConstMemoryView( payload.data(), n * msg_size ), ep );
+				}
+			} else {
+				const auto ep = SocketT::prepare( rx_ep );
+				for( std::uint64_t i = 0; i < msg_cnt; ++i ) {
+					tx.try_sendto( mart::ConstMemoryView( payload.data(), payload.size() ), ep );
+				}
+			}
+		} else {
+			for( std::uint64_t i = 0; i < msg_cnt; ++i ) {
+				tx.try_sendto( mart::ConstMemoryView( payload.data(), payload.size() ), rx_ep );
+			}
+		}
+	} );
+	const auto end = clock_type::now();
+
+	r.benchmark = "dgram_throughput";
+	r.transport = transport;
+	r.mode      = mode;
+	r.msg_size  = msg_size;
+	r.msgs_sent = msg_cnt;
+	// don't count the final idle timeout of the receiver
+	r.seconds = std::chrono::duration<double>( end - start ).count();
+	if( r.msgs_received < msg_cnt ) { r.seconds = std::max( 0.0, r.seconds - 0.2 ); }
+	report( r );
+}
+
+void bench_dgram_throughput()
+{
+	if( !is_selected( "dgram_throughput" ) ) { return; }
+
+	for( std::string_view mode : {"sendto", "gso_gro"} ) {
+		for( std::size_t size : {64, 512, 1400, 8192} ) {
+			const udp::endpoint rx_ep{address_local_host, port_nr{udp_port_base + 2}};
+			udp::Socket         rx;
+			rx.try_set_rx_buffer_size( 8 * 1024 * 1024 );
+			rx.bind( rx_ep );
+			udp::Socket tx;
+			if( mode == "gso_gro" && ( !tx.try_set_tx_segment_size( 0 ) || !rx.try_set_rx_coalescing( true ) ) ) {
+				std::fprintf( stderr, "skipping udp gso_gro - not supported on this platform\n" );
+				break;
+			}
+			run_dgram_throughput( "udp", mode, tx, rx, rx_ep, size, scaled( 200000 ) );
+		}
+	}
+
+#ifdef MART_NETLIB_BENCHMARK_UNIX_DOMAIN_SOCKETS
+	for( std::size_t size : {64, 512, 1400, 8192} ) {
+		const auto path = ( std::filesystem::temp_directory_path() / "mart_netlib_benchmark.sock" ).string();
+		std::filesystem::remove( path );
+
+		const mart::nw::un::endpoint rx_ep{std::string_view( path )};
+		mart::nw::un::Socket         rx;
+		rx.bind( rx_ep );
+		mart::nw::un::Socket tx;
+		run_dgram_throughput( "unix", "sendto", tx, rx, rx_ep, size, scaled( 200000 ) );
+		rx.close();
+		std::filesystem::remove( path );
+	}
+#endif
+
+	for( std::size_t size : {64, 512, 1400, 8192} ) {
+		udp::LoopbackNetworkConfig config{};
+		config.queue_capacity = 64 * 1024;
+		udp::LoopbackNetwork network( config );
+		const udp::endpoint  rx_ep{address_local_host, port_nr{udp_port_base + 2}};
+		udp::LoopbackSocket  rx( network );
+		rx.bind( rx_ep );
+		udp::LoopbackSocket tx( network );
+		run_dgram_throughput( "inproc", "sendto", tx, rx, rx_ep, size, scaled( 200000 ) );
+	}
+}
+
+/* ###### Tcp ###### */
+
+struct TcpPair {
+	tcp::Socket client;
+	tcp::Socket server;
+};
+
+TcpPair connect_tcp_pair( std::uint16_t port )
+{
+	const tcp::endpoint ep{address_local_host, port_nr{port}};
+
+	tcp::Acceptor acceptor;
+	acceptor.set_reuse_address( true );
+	acceptor.bind( ep );
+	acceptor.listen();
+
+	TcpPair pair;
+	pair.client.connect( ep );
+	pair.server = acceptor.accept( 1s );
+	pair.client.set_no_delay( true );
+	pair.server.set_no_delay( true );
+	return pair;
+}
+
+void recv_exactly( tcp::Socket& socket, std::vector<std::uint8_t>& buffer, std::size_t size )
+{
+	std::size_t received = 0;
+	while( received < size ) {
+		const auto data
+			= socket.recv( mart::MemoryView( buffer.data() + received, size - received ) );
+		if( !data.isValid() || data.size() == 0 ) { throw std::runtime_error( "tcp connection closed or timed out" ); }
+		received += data.size();
+	}
+}
+
+void bench_tcp_pingpong()
+{
+	if( !is_selected( "tcp_pingpong" ) ) { return; }
+
+	for( std::size_t size : {32, 256, 1024, 8192} ) {
+		auto pair = connect_tcp_pair( tcp_port_base );
+		pair.server.set_rx_timeout( 1s );
+		pair.client.set_rx_timeout( 1s );
+
+		const std::size_t iterations = scaled( 20000 );
+		const std::size_t warmup     = std::min<std::size_t>( iterations / 10, 1000 );
+
+		// the echo thread gives up after its receive timeout, if the client failed
+		HelperThread echo( [&] {
+			std::vector<std::uint8_t> buffer( size );
+			for( std::size_t i = 0; i < warmup + iterations; ++i ) {
+				recv_exactly( pair.server, buffer, size );
+				pair.server.send( mart::ConstMemoryView( buffer.data(), size ) );
+			}
+		} );
+
+		std::vector<std::int64_t> samples;
+		samples.reserve( iterations );
+		echo.run_and_join( [&] {
+			std::vector<std::uint8_t> tx( size, 0xAB );
+			std::vector<std::uint8_t> rx( size );
+			for( std::size_t i = 0; i < warmup + iterations; ++i ) {
+				const auto start = clock_type::now();
+				pair.client.send( mart::ConstMemoryView( tx.data(), tx.size() ) );
+				recv_exactly( pair.client, rx, size );
+				const auto end = clock_type::now();
+				if( i >= warmup ) {
+					samples.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( end - start ).count() );
+				}
+			}
+		} );
+
+		LatencyResult r = make_latency_result( samples );
+		r.benchmark     = "tcp_pingpong";
+		r.transport     = "tcp";
+		r.mode          = "blocking";
+		r.msg_size      = size;
+		r.iterations    = samples.size();
+		report( r );
+	}
+}
+
+void bench_tcp_throughput()
+{
+	if( !is_selected( "tcp_throughput" ) ) { return; }
+
+	for( std::string_view mode : {"send", "framed"} ) {
+		for( std::size_t size : {64, 1024, 16384, 65536} ) {
+			auto pair = connect_tcp_pair( tcp_port_base + 1 );
+			pair.server.set_rx_timeout( 1s );
+
+			const std::uint64_t total_bytes = g_options.quick ? 32 * 1024 * 1024 : 512 * 1024 * 1024;
+			const std::uint64_t msg_cnt     = total_bytes / size;
+
+			ThroughputResult r{};
+			const auto       start = clock_type::now();
+
+			// the receiver gives up after its receive timeout (or when the connection is closed), if the sender failed
+			HelperThread receiver( [&] {
+				if( mode == "framed" ) {
+					auto stream = tcp::FramedStream::length_prefixed( std::move( pair.server ), 2 * size + 16 );
+					while( r.msgs_received < msg_cnt ) {
+						auto frame = stream.recv_frame();
+						if( !frame ) { break; }
+						++r.msgs_received;
+						r.bytes_received += frame->size();
+					}
+				} else {
+					std::vector<std::uint8_t> buffer( 256 * 1024 );
+					while( r.bytes_received < msg_cnt * size ) {
+						const auto data = pair.server.recv( mart::MemoryView( buffer.data(), buffer.size() ) );
+						if( !data.isValid() || data.size() == 0 ) { break; }
+						r.bytes_received += data.size();
+					}
+					r.msgs_received = r.bytes_received / size;
+				}
+			} );
+
+			receiver.run_and_join( [&] {
+				std::vector<std::uint8_t> payload( size, 0xEF );
+				const auto                view = mart::ConstMemoryView( payload.data(), payload.size() );
+				if( mode == "framed" ) {
+					// batches up to max_queued_frames frames into a single writev
+					auto stream = tcp::FramedStream::length_prefixed( std::move( pair.client ) );
+					for( std::uint64_t i = 0; i < msg_cnt; ++i ) {
+						stream.queue_frame( view );
+					}
+					stream.flush();
+				} else {
+					for( std::uint64_t i = 0; i < msg_cnt; ++i ) {
+						pair.client.send( view );
+					}
+				}
+			} );
+
+			r.benchmark = "tcp_throughput";
+			r.transport = "tcp";
+			r.mode      = mode;
+			r.msg_size  = size;
+			r.msgs_sent = msg_cnt;
+			r.seconds   = std::chrono::duration<double>( clock_type::now() - start ).count();
+			report( r );
+		}
+	}
+}
+
+// serving a file: read into a user space buffer + send vs. send_file (no copy through user space)
+void bench_tcp_file_transfer()
+{
+	if( !is_selected( "tcp_file" ) ) { return; }
+
+	const auto          file_name  = ( std::filesystem::temp_directory_path() / "mart_netlib_benchmark.bin" ).string();
+	const std::uint64_t file_size  = g_options.quick ? 32 * 1024 * 1024 : 256 * 1024 * 1024;
+	const int           repetition = g_options.quick ? 1 : 4;
+	{
+		std::vector<char> chunk( 1024 * 1024, 'x' );
+		std::ofstream     file( file_name, std::ios::binary );
+		for( std::uint64_t i = 0; i < file_size / chunk.size(); ++i ) {
+			file.write( chunk.data(), static_cast<std::streamsize>( chunk.size() ) );
+		}
+	}
+
+	for( std::string_view mode : {"read_send", "send_file"} ) {
+		for( std::size_t chunk_size : {64 * 1024, 1024 * 1024} ) {
+			auto pair = connect_tcp_pair( tcp_port_base + 1 );
+			pair.server.set_rx_timeout( 1s );
+
+			ThroughputResult r{};
+			const auto       start = clock_type::now();
+
+			// the receiver gives up after its receive timeout, if the sender failed
+			HelperThread receiver( [&] {
+				std::vector<std::uint8_t> buffer( 256 * 1024 );
+				while( r.bytes_received < file_size * repetition ) {
+					const auto data = pair.server.recv( mart::MemoryView( buffer.data(), buffer.size() ) );
+					if( !data.isValid() || data.size() == 0 ) { break; }
+					r.bytes_received += data.size();
+				}
+				r.msgs_received = r.bytes_received / chunk_size;
+			} );
+
+			receiver.run_and_join( [&] {
+				for( int i = 0; i < repetition; ++i ) {
+					if( mode == "send_file" ) {
+						const auto file = mart::nw::socks::port_layer::open_file_read_only( file_name.c_str() );
+						if( !file.success() ) { throw std::runtime_error( "Could not open " + file_name ); }
+						for( std::uint64_t offset = 0; offset < file_size; offset += chunk_size ) {
+							pair.client.send_file( file.value(), offset, chunk_size );
+						}
+						mart::nw::socks::port_layer::close_file( file.value() );
+					} else {
+						std::ifstream             file( file_name, std::ios::binary );
+						std::vector<std::uint8_t> buffer( chunk_size );
+						while( file.read( reinterpret_cast<char*>( buffer.data() ),
+										  static_cast<std::streamsize>( chunk_size ) ) ) {
+							pair.client.send( mart::ConstMemoryView( buffer.data(), buffer.size() ) );
+						}
+					}
+				}
+			} );
+
+			r.benchmark = "tcp_file";
+			r.transport = "tcp";
+			r.mode      = mode;
+			r.msg_size  = chunk_size;
+			r.msgs_sent = file_size * repetition / chunk_size;
+			r.seconds   = std::chrono::duration<double>( clock_type::now() - start ).count();
+			report( r );
+		}
+	}
+	std::filesystem::remove( file_name );
+}
+
+bool parse_options( int argc, char** argv )
+{
+	for( int i = 1; i < argc; ++i ) {
+		const std::string_view arg = argv[i];
+		if( arg == "--quick" ) {
+			g_options.quick = true;
+		} else if( arg == "--filter" && i + 1 < argc ) {
+			g_options.filter = argv[++i];
+		} else if( arg == "--out" && i + 1 < argc ) {
+			g_options.out = std::fopen( argv[++i], "w" );
+			if( !g_options.out ) {
+				std::fprintf( stderr, "Could not open %s\n", argv[i] );
+				return false;
+			}
+		} else {
+			std::fprintf( stderr, "Usage: %s [--quick] [--filter <benchmark name>] [--out <file>]\n", argv[0] );
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	if( !parse_options( argc, argv ) ) { return 1; }
+
+	try {
+		bench_udp_pingpong();
+		bench_tcp_pingpong();
+		bench_dgram_throughput();
+		bench_tcp_throughput();
+		bench_tcp_file_transfer();
+	} catch( const std::exception& e ) {
+		std::fprintf( stderr, "Benchmark failed: %s\n", e.what() );
+		return 1;
+	}
+
+	if( g_options.out != stdout ) { std::fclose( g_options.out ); }
+}
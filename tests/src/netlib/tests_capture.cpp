@@ -0,0 +1,201 @@
+#include <mart-netlib/capture.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string capture_file_name( const char* name )
+{
+	return ( std::filesystem::temp_directory_path() / name ).string();
+}
+
+} // namespace
+
+TEST_CASE( "capture_append_and_read_back", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const auto file_name = capture_file_name( "mart_netlib_test_capture1.cap" );
+
+	udp::CaptureConfig config{};
+	config.capacity_bytes = 1024 * 1024;
+	config.max_datagrams  = 100;
+
+	const auto          t0 = std::chrono::system_clock::now();
+	const udp::endpoint src{address_local_host, port_nr{1234}};
+	{
+		udp::CaptureWriter writer( file_name, config );
+		for( std::uint32_t i = 0; i < 100; ++i ) {
+			const std::vector<std::uint8_t> payload( i, static_cast<std::uint8_t>( i ) );
+			CHECK( writer.try_append( udp::CapturedDatagram{
+				t0 + i * 1ms, src, mart::ConstMemoryView( payload.data(), payload.size() ), false} ) );
+		}
+		// index is full
+		CHECK( !writer.try_append( udp::CapturedDatagram{t0, src, mart::view_bytes( 5 ), false} ) );
+		CHECK( writer.size() == 100 );
+	}
+
+	// file got truncated to the used size
+	CHECK( std::filesystem::file_size( file_name ) < config.capacity_bytes );
+
+	udp::CaptureReader reader( file_name );
+	REQUIRE( reader.size() == 100 );
+	for( std::uint32_t i = 0; i < 100; ++i ) {
+		const auto d = reader[i];
+		CHECK( d.source == src );
+		CHECK( d.data.size() == i );
+		CHECK( std::all_of( d.data.begin(), d.data.end(), [i]( auto b ) { return b == i; } ) );
+		CHECK( d.timestamp - t0 == i * 1ms );
+		CHECK( !d.kernel_timestamp );
+	}
+	CHECK_THROWS( reader.at( 100 ) );
+
+	CHECK( reader.lower_bound( t0 ) == 0 );
+	CHECK( reader.lower_bound( t0 + 50ms ) == 50 );
+	CHECK( reader.lower_bound( t0 + 49500us ) == 50 );
+	CHECK( reader.lower_bound( t0 + 1s ) == 100 );
+
+	std::filesystem::remove( file_name );
+}
+
+TEST_CASE( "capture_file_full_and_invalid_files", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const auto file_name = capture_file_name( "mart_netlib_test_capture2.cap" );
+
+	udp::CaptureConfig config{};
+	config.capacity_bytes    = 4096;
+	config.max_datagrams     = 64;
+	config.max_datagram_size = 1000;
+	{
+		udp::CaptureWriter writer( file_name, config );
+
+		// the error of the failed receive is passed on and nothing gets recorded
+		udp::Socket s;
+		s.set_blocking( false );
+		const auto error = writer.try_capture( s );
+		CHECK( ( error.value() == mart::nw::socks::ErrorCodeValues::WouldBlock
+				 || error.value() == mart::nw::socks::ErrorCodeValues::TryAgain ) );
+		CHECK( writer.size() == 0 );
+
+		const std::vector<std::uint8_t> payload( 1000 );
+		while( writer.try_append( udp::CapturedDatagram{std::chrono::system_clock::now(),
+														udp::endpoint{},
+														mart::ConstMemoryView( payload.data(), payload.size() ),
+														false} ) ) {
+		}
+		CHECK( writer.is_full() );
+		CHECK( writer.size() == 3 );
+
+		CHECK( writer.try_capture( s ).raw_value() == ENOSPC );
+	}
+	CHECK( udp::CaptureReader( file_name ).size() == 3 );
+
+	// not a capture file
+	{
+		udp::CaptureConfig small{};
+		small.capacity_bytes = 4096;
+		small.max_datagrams  = 16;
+		udp::CaptureWriter writer( file_name, small );
+	}
+	std::filesystem::resize_file( file_name, 32 );
+	CHECK_THROWS( udp::CaptureReader( file_name ) );
+	CHECK_THROWS( udp::CaptureReader( capture_file_name( "mart_netlib_test_does_not_exist.cap" ) ) );
+
+	// too small for the index
+	config.max_datagrams = 1024;
+	CHECK_THROWS( udp::CaptureWriter( file_name, config ) );
+
+	std::filesystem::remove( file_name );
+}
+
+TEST_CASE( "capture_from_socket_and_replay", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const auto file_name = capture_file_name( "mart_netlib_test_capture3.cap" );
+
+	const udp::endpoint capture_ep{address_local_host, port_nr{3462}};
+	const udp::endpoint replay_ep{address_local_host, port_nr{3463}};
+
+	udp::CaptureConfig config{};
+	config.capacity_bytes = 4 * 1024 * 1024;
+	config.max_datagrams  = 1000;
+
+	{
+		udp::Socket rx;
+		rx.bind( capture_ep );
+		rx.set_rx_timeout( 1000ms );
+		const bool kernel_timestamps = static_cast<bool>( rx.try_set_rx_timestamping( true ) );
+
+		udp::Socket tx;
+		udp::CaptureWriter writer( file_name, config );
+		for( std::uint32_t i = 0; i < 20; ++i ) {
+			tx.sendto( mart::view_bytes( i ), capture_ep );
+			REQUIRE( writer.capture( rx ) );
+			if( i == 9 ) { std::this_thread::sleep_for( 50ms ); }
+		}
+		rx.set_rx_timeout( 1ms );
+		CHECK( !writer.capture( rx ) );
+		CHECK( writer.size() == 20 );
+
+		udp::CaptureReader reader( file_name );
+		CHECK( reader.size() == 20 );
+		CHECK( reader[0].kernel_timestamp == kernel_timestamps );
+		CHECK( reader[0].source.address == address_local_host );
+	}
+
+	udp::CaptureReader reader( file_name );
+
+	udp::Socket sink;
+	sink.bind( replay_ep );
+	sink.set_rx_timeout( 1000ms );
+	udp::Socket tx;
+
+	const auto receive_all = [&] {
+		std::vector<std::uint32_t> received;
+		std::uint32_t              v{};
+		sink.set_rx_timeout( 50ms );
+		while( sink.try_recv( mart::view_bytes_mutable( v ) ).isValid() ) {
+			received.push_back( v );
+		}
+		return received;
+	};
+
+	SECTION( "original timing" )
+	{
+		const auto stats = udp::replay( reader, tx, replay_ep );
+		CHECK( stats.sent == 20 );
+		CHECK( stats.failed == 0 );
+		// includes the 50ms gap
+		CHECK( stats.duration >= 50ms );
+
+		const auto received = receive_all();
+		REQUIRE( received.size() == 20 );
+		for( std::uint32_t i = 0; i < 20; ++i ) {
+			CHECK( received[i] == i );
+		}
+	}
+
+	SECTION( "max speed and range" )
+	{
+		udp::ReplayConfig replay_config{};
+		replay_config.timing = udp::ReplayTiming::max_speed;
+		replay_config.first  = 5;
+		replay_config.last   = 10;
+		const auto stats     = udp::replay( reader, tx, replay_ep, replay_config );
+		CHECK( stats.sent == 5 );
+		CHECK( stats.duration < 50ms );
+		CHECK( receive_all() == std::vector<std::uint32_t>{5, 6, 7, 8, 9} );
+	}
+
+	std::filesystem::remove( file_name );
+}
@@ -0,0 +1,96 @@
+#include <mart-netlib/framed_stream.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <future>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace mart::nw::ip;
+
+// returns connected (server side, client side) sockets
+std::pair<tcp::Socket, tcp::Socket> make_connected_pair( tcp::endpoint ep )
+{
+	tcp::Acceptor ac;
+	ac.set_reuse_address( true );
+	ac.bind( ep );
+	ac.listen();
+
+	auto client = tcp::connect( ep );
+	auto server = ac.accept( std::chrono::milliseconds( 1000 ) );
+	REQUIRE( server.is_valid() );
+	server.set_rx_timeout( std::chrono::milliseconds( 1000 ) );
+	return { std::move( server ), std::move( client ) };
+}
+
+std::string_view as_string_view( mart::ConstMemoryView v )
+{
+	return { reinterpret_cast<const char*>( v.data() ), v.size() };
+}
+
+mart::ConstMemoryView as_bytes( std::string_view str )
+{
+	return mart::ConstMemoryView( reinterpret_cast<const std::uint8_t*>( str.data() ), str.size() );
+}
+
+} // namespace
+
+TEST_CASE( "framed_stream_length_prefixed_exchange", "[net]" )
+{
+	auto [server, client] = make_connected_pair( { address_local_host, port_nr{ 1591 } } );
+
+	// small receive buffer to force compaction of partial frames
+	auto rx = tcp::FramedStream::length_prefixed( std::move( server ), 64 );
+	auto tx = tcp::FramedStream::length_prefixed( std::move( client ) );
+
+	std::vector<std::string> msgs;
+	for( int i = 0; i < 50; ++i ) {
+		msgs.push_back( std::string( static_cast<std::size_t>( i ), static_cast<char>( 'a' + i % 26 ) ) );
+	}
+	for( const auto& m : msgs ) {
+		tx.queue_frame( as_bytes( m ) );
+	}
+	tx.flush();
+
+	for( const auto& m : msgs ) {
+		auto frame = rx.recv_frame();
+		REQUIRE( frame );
+		CHECK( as_string_view( *frame ) == m );
+	}
+	CHECK( !rx.try_next_buffered_frame() );
+
+	// frames larger than the receive buffer are rejected
+	const std::string too_large( 100, 'x' );
+	tx.send_frame( as_bytes( too_large ) );
+	CHECK_THROWS( rx.recv_frame() );
+}
+
+TEST_CASE( "framed_stream_delimited_exchange", "[net]" )
+{
+	auto [server, client] = make_connected_pair( { address_local_host, port_nr{ 1592 } } );
+
+	auto rx = tcp::FramedStream::delimited( std::move( server ), '\n', 16 );
+	auto tx = tcp::FramedStream::delimited( std::move( client ), '\n' );
+
+	tx.queue_frame( as_bytes( "hello" ) );
+	tx.queue_frame( as_bytes( "" ) );
+	tx.queue_frame( as_bytes( "world, again" ) );
+	tx.flush();
+
+	auto f1 = rx.recv_frame();
+	REQUIRE( f1 );
+	CHECK( as_string_view( *f1 ) == "hello" );
+	auto f2 = rx.recv_frame();
+	REQUIRE( f2 );
+	CHECK( f2->empty() );
+	auto f3 = rx.recv_frame();
+	REQUIRE( f3 );
+	CHECK( as_string_view( *f3 ) == "world, again" );
+
+	// closing the sender ends the stream
+	tx.socket().close();
+	CHECK( !rx.recv_frame() );
+	CHECK( rx.is_closed() );
+}
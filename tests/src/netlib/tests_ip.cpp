@@ -2,9 +2,85 @@
 
 #include <catch2/catch.hpp>
 
+#include <string>
+
 TEST_CASE( "ipv4_address_roundtrips_throug string", "[net]" )
 {
 	std::string_view         ref = "101.112.123.134";
 	mart::nw::ip::address_v4 addr( ref );
 	CHECK( addr.asString() == ref );
-}
\ No newline at end of file
+}
+TEST_CASE( "ipv6_address_roundtrips_throug_string", "[net]" )
+{
+	std::string_view         ref = "fe80::1:2:3";
+	mart::nw::ip::address_v6 addr( ref );
+	CHECK( addr.asString() == ref );
+
+	CHECK( mart::nw::ip::address_v6( "::1" ) == mart::nw::ip::address_v6_local_host );
+	CHECK( mart::nw::ip::address_v6( "::" ) == mart::nw::ip::address_v6_any );
+	CHECK( !mart::nw::ip::try_parse_v6_address( "1.2.3.4" ) );
+	CHECK( !mart::nw::ip::try_parse_v6_address( "fe80:::1" ) );
+	CHECK_THROWS( mart::nw::ip::address_v6( "hello" ) );
+}
+
+TEST_CASE( "ipv6_v4_mapped_address", "[net]" )
+{
+	using namespace mart::nw::ip;
+	constexpr auto mapped = address_v6::v4_mapped( address_local_host );
+	static_assert( mapped.is_v4_mapped() );
+	static_assert( mapped.to_v4() == address_local_host );
+	static_assert( !address_v6_local_host.is_v4_mapped() );
+
+	CHECK( mapped == address_v6( "::ffff:127.0.0.1" ) );
+}
+
+TEST_CASE( "ipv6_endpoint_parsing", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using ep_t = basic_endpoint_v6<TransportProtocol::Udp>;
+
+	ep_t ep( "[::1]:1234" );
+	CHECK( ep.valid() );
+	CHECK( ep.address == address_v6_local_host );
+	CHECK( ep.port == port_nr{ 1234 } );
+	CHECK( ep.toString() == "[::1]:1234" );
+	CHECK( ep.toStringEx() == "[::1]:1234 (UDP)" );
+
+	CHECK( ep_t( ep.toSockAddr() ) == ep );
+
+	CHECK( !try_parse_v6_endpoint<TransportProtocol::Udp>( "::1:1234" ) );
+	CHECK( !try_parse_v6_endpoint<TransportProtocol::Udp>( "[::1]" ) );
+	CHECK( !try_parse_v6_endpoint<TransportProtocol::Udp>( "[::1]:123456" ) );
+	CHECK_THROWS( ep_t( "[::1" ) );
+}
+
+TEST_CASE( "ipv6_zone_ids", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using ep_t = basic_endpoint_v6<TransportProtocol::Udp>;
+
+	// numeric zone id of an interface that most likely doesn't exist
+	const address_v6 addr( "fe80::1%4711" );
+	CHECK( addr.scope_id() == 4711 );
+	CHECK( addr.asString() == "fe80::1%4711" );
+	CHECK( addr != address_v6( "fe80::1" ) );
+	CHECK( address_v6( addr.asString() ) == addr );
+
+	const ep_t ep( "[fe80::1%4711]:1234" );
+	CHECK( ep.address == addr );
+	CHECK( ep.toString() == "[fe80::1%4711]:1234" );
+	CHECK( ep_t( ep.toSockAddr() ) == ep );
+
+	CHECK( !try_parse_v6_address( "fe80::1%" ) );
+	CHECK( !try_parse_v6_address( "fe80::1%99999999999" ) );
+	CHECK( !try_parse_v6_address( "fe80::1%no_such_interface" ) );
+	CHECK( !try_parse_v6_endpoint<TransportProtocol::Udp>( "[fe80::1%]:1234" ) );
+
+#ifdef __linux__
+	// interface names are resolved to their index and printed by name
+	const address_v6 lo( "fe80::1%lo" );
+	CHECK( lo.scope_id() != 0 );
+	CHECK( lo.asString() == "fe80::1%lo" );
+	CHECK( address_v6( "fe80::1%" + std::to_string( lo.scope_id() ) ) == lo );
+#endif
+}
@@ -0,0 +1,263 @@
+#include <mart-netlib/loopback_transport.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+template<class SocketT>
+std::uint32_t ping( SocketT& s, const typename SocketT::endpoint& peer, std::uint32_t v )
+{
+	s.sendto( mart::view_bytes( v ), peer );
+	std::uint32_t reply{};
+	s.recv( mart::view_bytes_mutable( reply ) );
+	return reply;
+}
+
+} // namespace
+
+TEST_CASE( "loopback_socket_exchange", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::LoopbackNetwork network;
+
+	const udp::endpoint ep1{address_local_host, port_nr{5000}};
+	const udp::endpoint ep2{address_local_host, port_nr{5001}};
+
+	udp::LoopbackSocket s1( network );
+	udp::LoopbackSocket s2( network, ep2, ep1 );
+	s1.bind( ep1 );
+	CHECK( s1.get_local_endpoint() == ep1 );
+	CHECK( s2.get_remote_endpoint() == ep1 );
+
+	// endpoint already in use
+	udp::LoopbackSocket s3( network );
+	CHECK( !s3.try_bind( ep1 ) );
+	CHECK_THROWS( s3.bind( ep2 ) );
+
+	s2.send( mart::view_bytes( std::uint32_t{42} ) );
+
+	std::uint32_t rx{};
+	auto          res = s1.recvfrom( mart::view_bytes_mutable( rx ) );
+	CHECK( res.data.size() == sizeof( rx ) );
+	CHECK( rx == 42 );
+	CHECK( res.remote_address == ep2 );
+
+	// truncation, like udp
+	s1.sendto( mart::view_bytes( std::uint64_t{0x0102'0304'0506'0708} ), ep2 );
+	std::uint16_t small{};
+	CHECK( s2.recv( mart::view_bytes_mutable( small ) ).size() == sizeof( small ) );
+
+	// nothing left
+	s2.set_blocking( false );
+	CHECK( !s2.try_recv( mart::view_bytes_mutable( small ) ).isValid() );
+	s2.set_blocking( true );
+	s2.set_rx_timeout( 1ms );
+	CHECK( !s2.try_recv( mart::view_bytes_mutable( small ) ).isValid() );
+
+	// sending to an endpoint nobody is bound to is not an error (the datagram is just lost)
+	CHECK( s1.try_sendto( mart::view_bytes( 5 ), udp::endpoint{address_local_host, port_nr{5002}} ) );
+
+	const auto stats = network.stats();
+	CHECK( stats.sent == 3 );
+	CHECK( stats.queued == 2 );
+	CHECK( stats.dropped_no_receiver == 1 );
+
+	// after closing, the endpoint can be reused
+	s1.close();
+	CHECK( !s1.is_valid() );
+	CHECK( s3.try_bind( ep1 ) );
+}
+
+TEST_CASE( "loopback_socket_implicit_bind_and_reply", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::LoopbackNetwork network;
+
+	const udp::endpoint server_ep{address_any, port_nr{5000}};
+
+	udp::LoopbackSocket server( network );
+	server.bind( server_ep );
+
+	std::thread echo( [&] {
+		std::uint32_t buffer{};
+		for( int i = 0; i < 100; ++i ) {
+			auto res = server.recvfrom( mart::view_bytes_mutable( buffer ) );
+			server.sendto( res.data, res.remote_address );
+		}
+	} );
+
+	udp::LoopbackSocket client( network );
+	for( std::uint32_t i = 0; i < 100; ++i ) {
+		CHECK( ping( client, udp::endpoint{address_local_host, port_nr{5000}}, i ) == i );
+	}
+	echo.join();
+
+	CHECK( client.get_local_endpoint().port.inHostOrder() != 0 );
+}
+
+TEST_CASE( "loopback_socket_multiple_senders", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::LoopbackNetworkConfig config{};
+	config.queue_capacity = 64;
+	udp::LoopbackNetwork network( config );
+
+	const udp::endpoint rx_ep{address_local_host, port_nr{5000}};
+	udp::LoopbackSocket rx( network );
+	rx.bind( rx_ep );
+
+	constexpr int            sender_cnt = 4;
+	constexpr std::uint32_t  msg_cnt    = 1000;
+	std::vector<std::thread> senders;
+	for( int s = 0; s < sender_cnt; ++s ) {
+		senders.emplace_back( [&] {
+			udp::LoopbackSocket tx( network );
+			for( std::uint32_t i = 0; i < msg_cnt; ++i ) {
+				tx.sendto( mart::view_bytes( i ), rx_ep );
+			}
+		} );
+	}
+
+	std::uint64_t received = 0;
+	rx.set_rx_timeout( 50ms );
+	std::uint32_t buffer{};
+	while( rx.try_recv( mart::view_bytes_mutable( buffer ) ).isValid() ) {
+		++received;
+	}
+	for( auto& t : senders ) {
+		t.join();
+	}
+	rx.clearRxBuff();
+
+	const auto stats = network.stats();
+	CHECK( stats.sent == sender_cnt * msg_cnt );
+	CHECK( stats.queued + stats.dropped_queue_full == stats.sent );
+	CHECK( received <= stats.queued );
+}
+
+TEST_CASE( "loopback_socket_impairments", "[net]" )
+{
+	using namespace mart::nw::ip;
+
+	const udp::endpoint rx_ep{address_local_host, port_nr{5000}};
+
+	SECTION( "loss is deterministic for a given seed" )
+	{
+		udp::LoopbackNetworkConfig config{};
+		config.impairments.loss_probability = 0.3;
+
+		auto run = [&] {
+			udp::LoopbackNetwork network( config );
+			udp::LoopbackSocket  rx( network );
+			rx.bind( rx_ep );
+			udp::LoopbackSocket tx( network );
+			std::vector<std::uint32_t> received;
+			for( std::uint32_t i = 0; i < 500; ++i ) {
+				tx.sendto( mart::view_bytes( i ), rx_ep );
+			}
+			rx.set_blocking( false );
+			std::uint32_t v{};
+			while( rx.try_recv( mart::view_bytes_mutable( v ) ).isValid() ) {
+				received.push_back( v );
+			}
+			CHECK( network.stats().dropped_loss + received.size() == 500 );
+			return received;
+		};
+
+		const auto r1 = run();
+		const auto r2 = run();
+		CHECK( r1 == r2 );
+		CHECK( r1.size() > 250 );
+		CHECK( r1.size() < 450 );
+	}
+
+	SECTION( "latency" )
+	{
+		udp::LoopbackNetworkConfig config{};
+		config.impairments.latency = 20ms;
+		udp::LoopbackNetwork network( config );
+		udp::LoopbackSocket  rx( network );
+		rx.bind( rx_ep );
+		udp::LoopbackSocket tx( network );
+
+		const auto start = std::chrono::steady_clock::now();
+		tx.sendto( mart::view_bytes( 1 ), rx_ep );
+
+		int v{};
+		rx.set_blocking( false );
+		CHECK( !rx.try_recv( mart::view_bytes_mutable( v ) ).isValid() );
+		rx.set_blocking( true );
+		CHECK( rx.recv( mart::view_bytes_mutable( v ) ).isValid() );
+		CHECK( std::chrono::steady_clock::now() - start >= 20ms );
+	}
+
+	SECTION( "reordering" )
+	{
+		udp::LoopbackNetworkConfig config{};
+		config.impairments.reorder_probability = 0.2;
+		config.impairments.reorder_delay       = 2ms;
+		udp::LoopbackNetwork network( config );
+		udp::LoopbackSocket  rx( network );
+		rx.bind( rx_ep );
+		udp::LoopbackSocket tx( network );
+
+		for( std::uint32_t i = 0; i < 100; ++i ) {
+			tx.sendto( mart::view_bytes( i ), rx_ep );
+		}
+
+		rx.set_rx_timeout( 50ms );
+		std::vector<std::uint32_t> received;
+		std::uint32_t              v{};
+		while( rx.try_recv( mart::view_bytes_mutable( v ) ).isValid() ) {
+			received.push_back( v );
+		}
+		REQUIRE( received.size() == 100 );
+		CHECK( !std::is_sorted( received.begin(), received.end() ) );
+	}
+}
+
+TEST_CASE( "loopback_socket_fan_out_and_timestamps", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::LoopbackNetworkConfig config{};
+	config.impairments.latency = 1ms;
+	udp::LoopbackNetwork network( config );
+
+	// more peers than a socket remembers routes for
+	constexpr std::uint16_t          peer_cnt = 12;
+	std::vector<udp::LoopbackSocket> peers;
+	for( std::uint16_t i = 0; i < peer_cnt; ++i ) {
+		peers.emplace_back( network );
+		peers.back().bind( udp::endpoint{address_local_host, port_nr( 6000 + i )} );
+		peers.back().set_rx_timestamping( i % 2 == 0 );
+	}
+
+	udp::LoopbackSocket tx( network );
+	for( int round = 0; round < 3; ++round ) {
+		for( std::uint16_t i = 0; i < peer_cnt; ++i ) {
+			tx.sendto( mart::view_bytes( std::uint32_t{i} ), peers[i].get_local_endpoint() );
+		}
+	}
+
+	const auto before = std::chrono::system_clock::now();
+	for( std::uint16_t i = 0; i < peer_cnt; ++i ) {
+		peers[i].set_rx_timeout( 100ms );
+		for( int round = 0; round < 3; ++round ) {
+			std::uint32_t v{};
+			const auto    res = peers[i].recvfrom( mart::view_bytes_mutable( v ) );
+			REQUIRE( res.data.size() == sizeof( v ) );
+			CHECK( v == i );
+			CHECK( res.rx_timestamp.has_value() == ( i % 2 == 0 ) );
+			if( res.rx_timestamp ) { CHECK( *res.rx_timestamp <= before + 1s ); }
+		}
+	}
+	CHECK( network.stats().queued == 3 * peer_cnt );
+}
@@ -0,0 +1,68 @@
+#include <mart-netlib/multicast.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <string_view>
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "multicast_address_classification", "[net]" )
+{
+	using namespace mart::nw::ip;
+	CHECK( address_v4( "224.0.0.1" ).is_multicast() );
+	CHECK( address_v4( "239.255.12.3" ).is_multicast() );
+	CHECK( !address_v4( "223.255.255.255" ).is_multicast() );
+	CHECK( !address_v4( "240.0.0.1" ).is_multicast() );
+	CHECK( !address_local_host.is_multicast() );
+
+	CHECK( address_v6( "ff02::1" ).is_multicast() );
+	CHECK( !address_v6_local_host.is_multicast() );
+}
+
+TEST_CASE( "multicast_publish_reaches_all_subscribers", "[net]" )
+{
+	using namespace mart::nw::ip;
+
+	// stay on the loopback interface, so the test doesn't depend on the network configuration
+	const udp::endpoint group{address_v4( "239.255.0.77" ), port_nr{3460}};
+
+	udp::MulticastSubscriber sub1( group, address_local_host );
+	udp::MulticastSubscriber sub2( group, address_local_host );
+	sub1.socket().set_rx_timeout( 1000ms );
+	sub2.socket().set_rx_timeout( 1000ms );
+
+	udp::MulticastPublisher pub( group, udp::MulticastConfig{}, address_local_host );
+	CHECK( pub.group() == group );
+
+	const std::string_view msg = "sensor sample";
+	pub.publish( mart::ConstMemoryView( reinterpret_cast<const unsigned char*>( msg.data() ), msg.size() ) );
+
+	for( auto* sub : {&sub1, &sub2} ) {
+		char buffer[64]{};
+		auto res = sub->recvfrom( mart::view_bytes_mutable( buffer ) );
+		CHECK( std::string_view( reinterpret_cast<const char*>( res.data.data() ), res.data.size() ) == msg );
+	}
+
+	udp::leave_group( sub2.socket(), group.address, address_local_host );
+	// not a member anymore
+	CHECK_THROWS( udp::leave_group( sub2.socket(), group.address, address_local_host ) );
+	CHECK( udp::try_join_group( sub2.socket(), group.address, address_local_host ) );
+}
+
+TEST_CASE( "multicast_socket_options", "[net]" )
+{
+	using namespace mart::nw::ip;
+
+	udp::Socket s;
+	CHECK( udp::try_set_multicast_ttl( s, 4 ) );
+	CHECK( udp::try_set_multicast_loopback( s, false ) );
+	CHECK_NOTHROW( udp::set_multicast_interface( s, address_local_host ) );
+	// not a multicast address
+	CHECK( !udp::try_join_group( s, address_local_host ) );
+	CHECK_THROWS( udp::join_group( s, address_local_host ) );
+
+	udp::Socket6 s6;
+	CHECK( udp::try_set_multicast_ttl( s6, 4 ) );
+	CHECK( udp::try_set_multicast_loopback( s6, false ) );
+}
@@ -0,0 +1,91 @@
+#include <mart-netlib/sharded_listener.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+
+TEST_CASE( "sharded_listener_udp_receives_on_all_shards", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const udp::endpoint ep = { address_local_host, port_nr{ 3451 } };
+
+	ShardedListenerConfig config;
+	config.shard_cnt     = 3;
+	config.poll_interval = std::chrono::milliseconds( 10 );
+
+	ShardedListener<udp::Socket> listener( ep, config );
+	REQUIRE( listener.shard_cnt() == 3 );
+
+	std::atomic<int>                received{ 0 };
+	std::array<std::atomic<int>, 3> received_per_shard{};
+	listener.start( [&]( std::size_t shard_idx, udp::Socket& socket ) {
+		std::array<std::uint8_t, 16> buffer{};
+		if( !socket.try_recv( buffer ).empty() ) {
+			++received_per_shard[shard_idx];
+			++received;
+		}
+	} );
+	CHECK( listener.is_running() );
+
+	// different source ports -> different flows, which get distributed over the shards
+	constexpr int msg_cnt = 20;
+	for( int i = 0; i < msg_cnt; ++i ) {
+		udp::Socket sender;
+		sender.sendto( mart::view_bytes( i ), ep );
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 2 );
+	while( received < msg_cnt && std::chrono::steady_clock::now() < deadline ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+	}
+	listener.stop();
+
+	CHECK( received == msg_cnt );
+	CHECK( !listener.is_running() );
+
+	// SO_REUSEPORT hashes the 4-tuple, so with 20 flows the chance that they all end up on the same shard is
+	// negligible
+	int active_shards = 0;
+	for( const auto& cnt : received_per_shard ) {
+		if( cnt > 0 ) { ++active_shards; }
+	}
+	CHECK( active_shards >= 2 );
+}
+
+TEST_CASE( "sharded_listener_tcp_accepts_connections", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const tcp::endpoint ep = { address_local_host, port_nr{ 1589 } };
+
+	ShardedListenerConfig config;
+	config.shard_cnt = 2;
+
+	ShardedListener<tcp::Acceptor> listener( ep, config );
+
+	std::atomic<int> accepted{ 0 };
+	listener.start( [&]( std::size_t, tcp::Acceptor& acceptor ) {
+		auto s = acceptor.accept( std::chrono::milliseconds( 10 ) );
+		if( s.is_valid() ) { ++accepted; }
+	} );
+
+	constexpr int con_cnt = 4;
+	for( int i = 0; i < con_cnt; ++i ) {
+		auto s = tcp::connect( ep );
+		CHECK( s.is_valid() );
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 2 );
+	while( accepted < con_cnt && std::chrono::steady_clock::now() < deadline ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+	}
+	listener.stop();
+
+	CHECK( accepted == con_cnt );
+}
+
+#endif
@@ -99,3 +99,200 @@ TEST_CASE( "invalid_endpoint_strings_fail" )
 	CHECK_THROWS( udp::endpoint{"127.0.0.1:66999"} );
 	CHECK_THROWS( udp::endpoint{"1.333.0.1:669"} );
 }
+
+TEST_CASE( "udp_socket_scatter_gather_exchange", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::endpoint e1{ "127.0.0.1:3447" };
+	udp::endpoint e2{ "127.0.0.1:3448" };
+
+	udp::Socket tx( e1, e2 );
+	udp::Socket rx( e2, e1 );
+	using namespace std::chrono_literals;
+	rx.set_rx_timeout( 100ms );
+
+	const std::uint32_t header  = 0xAABBCCDD;
+	const char          payload[] = "Hello World";
+
+	const std::array<mart::ConstMemoryView, 2> parts{ mart::view_bytes( header ), mart::view_bytes( payload ) };
+	CHECK( tx.try_send( parts ) );
+	CHECK_NOTHROW( tx.sendto( parts, e2 ) );
+
+	std::uint32_t rx_header{};
+	char          rx_payload[sizeof( payload )]{};
+
+	const std::array<mart::MemoryView, 2> buffers{ mart::view_bytes_mutable( rx_header ),
+												   mart::view_bytes_mutable( rx_payload ) };
+
+	CHECK( rx.recv( buffers ) == sizeof( header ) + sizeof( payload ) );
+	CHECK( rx_header == header );
+	CHECK( std::string_view( rx_payload ) == payload );
+
+	rx_header = 0;
+	auto res  = rx.recvfrom( buffers );
+	CHECK( res.result.value() == sizeof( header ) + sizeof( payload ) );
+	CHECK( res.remote_address == e1 );
+	CHECK( rx_header == header );
+
+	// nothing left to receive
+	CHECK( !rx.try_recvfrom( buffers ).result.success() );
+}
+
+TEST_CASE( "udp_socket_sendto_prepared_endpoint", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::endpoint e1{ "127.0.0.1:3454" };
+	udp::endpoint e2{ "127.0.0.1:3455" };
+
+	udp::Socket tx;
+	tx.bind( e1 );
+	udp::Socket rx;
+	rx.bind( e2 );
+	using namespace std::chrono_literals;
+	rx.set_rx_timeout( 100ms );
+
+	const auto dest = udp::Socket::prepare( e2 );
+	CHECK( dest.get_endpoint() == e2 );
+
+	const int data = 42;
+	CHECK( tx.try_sendto( mart::view_bytes( data ), dest ) );
+	CHECK_NOTHROW( tx.sendto( mart::view_bytes( data ), dest ) );
+
+	const std::array<mart::ConstMemoryView, 2> parts{ mart::view_bytes( data ), mart::view_bytes( data ) };
+	CHECK_NOTHROW( tx.sendto( parts, dest ) );
+
+	std::array<unsigned char, 16> buffer{};
+	for( std::size_t expected_size : { sizeof( int ), sizeof( int ), 2 * sizeof( int ) } ) {
+		auto res = rx.recvfrom( buffer );
+		CHECK( res.data.size() == expected_size );
+		CHECK( res.remote_address == e1 );
+	}
+}
+
+TEST_CASE( "udp_socket_v6_exchange", "[net]" )
+{
+	using namespace mart::nw::ip;
+	const udp::endpoint_v6 e1{ address_v6_local_host, port_nr{ 3456 } };
+	const udp::endpoint_v6 e2 = *udp::try_parse_v6_endpoint( "[::1]:3457" );
+
+	udp::Socket6 tx( e1, e2 );
+	udp::Socket6 rx;
+	rx.bind( e2 );
+	using namespace std::chrono_literals;
+	rx.set_rx_timeout( 100ms );
+
+	const int data = 0x1234;
+	tx.send( mart::view_bytes( data ) );
+
+	int  rec{};
+	auto res = rx.recvfrom( mart::view_bytes_mutable( rec ) );
+	CHECK( res.data.size() == sizeof( int ) );
+	CHECK( rec == data );
+	CHECK( res.remote_address == e1 );
+}
+
+TEST_CASE( "udp_socket_v6_dual_stack", "[net]" )
+{
+	using namespace mart::nw::ip;
+
+	udp::Socket6 rx;
+	rx.set_v6_only( false );
+	rx.bind( udp::endpoint_v6{ address_v6_any, port_nr{ 3458 } } );
+	using namespace std::chrono_literals;
+	rx.set_rx_timeout( 100ms );
+
+	udp::Socket tx;
+	tx.bind( udp::endpoint{ address_local_host, port_nr{ 3459 } } );
+	const int data = 0x4321;
+	tx.sendto( mart::view_bytes( data ), udp::endpoint{ address_local_host, port_nr{ 3458 } } );
+
+	int  rec{};
+	auto res = rx.recvfrom( mart::view_bytes_mutable( rec ) );
+	CHECK( rec == data );
+	CHECK( res.remote_address.address.is_v4_mapped() );
+	CHECK( res.remote_address.address.to_v4() == address_local_host );
+	CHECK( res.remote_address.port == port_nr{ 3459 } );
+}
+
+#ifdef __linux__
+TEST_CASE( "udp_socket_segmentation_offload", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::endpoint e1{ "127.0.0.1:3449" };
+	udp::endpoint e2{ "127.0.0.1:3450" };
+
+	udp::Socket tx( e1, e2 );
+	udp::Socket rx;
+	rx.bind( e2 );
+	using namespace std::chrono_literals;
+	rx.set_rx_timeout( 100ms );
+
+	CHECK_NOTHROW( tx.set_tx_segment_size( 100 ) );
+	CHECK_NOTHROW( rx.set_rx_coalescing( true ) );
+
+	std::array<unsigned char, 250> data{};
+	for( std::size_t i = 0; i < data.size(); ++i ) {
+		data[i] = static_cast<unsigned char>( i );
+	}
+	CHECK( tx.try_send( mart::view_bytes( data ) ) );
+
+	// depending on the kernel, we get the datagrams coalesced or one by one
+	std::array<unsigned char, 1024> buffer{};
+	std::size_t                     total = 0;
+	while( total < data.size() ) {
+		auto res = rx.recvfrom_coalesced( mart::MemoryView( buffer.data() + total, buffer.size() - total ) );
+		REQUIRE( res.data.isValid() );
+		CHECK( ( res.segment_size == 100 || res.data.size() < 100 ) );
+		CHECK( res.remote_address == e1 );
+		total += res.data.size();
+	}
+	CHECK( total == data.size() );
+	CHECK( std::equal( data.begin(), data.end(), buffer.begin() ) );
+
+	CHECK_NOTHROW( tx.set_tx_segment_size( 0 ) );
+	CHECK( tx.try_send( mart::view_bytes( data ) ) );
+	auto res = rx.recvfrom_coalesced( buffer );
+	CHECK( res.data.size() == data.size() );
+	CHECK( res.segment_size == data.size() );
+}
+
+TEST_CASE( "udp_socket_kernel_rx_timestamp", "[net]" )
+{
+	using namespace mart::nw::ip;
+	udp::endpoint e1{ "127.0.0.1:3452" };
+	udp::endpoint e2{ "127.0.0.1:3453" };
+
+	udp::Socket tx( e1, e2 );
+	udp::Socket rx;
+	rx.bind( e2 );
+	using namespace std::chrono_literals;
+	rx.set_rx_timeout( 100ms );
+
+	std::array<unsigned char, 16> buffer{};
+
+	// without timestamping, no timestamp is reported
+	tx.send( mart::view_bytes( 1 ) );
+	auto res = rx.recvfrom( buffer );
+	CHECK( res.data.size() == sizeof( int ) );
+	CHECK( !res.rx_timestamp );
+
+	CHECK_NOTHROW( rx.set_rx_timestamping( true ) );
+	CHECK( rx.is_rx_timestamping() );
+
+	const auto before = std::chrono::system_clock::now();
+	tx.send( mart::view_bytes( 2 ) );
+	res              = rx.recvfrom( buffer );
+	const auto after = std::chrono::system_clock::now();
+
+	CHECK( res.data.size() == sizeof( int ) );
+	CHECK( res.remote_address == e1 );
+	REQUIRE( res.rx_timestamp );
+	CHECK( *res.rx_timestamp >= before - 1ms );
+	CHECK( *res.rx_timestamp <= after + 1ms );
+
+	tx.send( mart::view_bytes( 3 ) );
+	auto res2 = rx.try_recvfrom( buffer );
+	CHECK( res2.data.size() == sizeof( int ) );
+	CHECK( res2.rx_timestamp );
+}
+#endif